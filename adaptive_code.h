@@ -0,0 +1,311 @@
+#ifndef ADAPTIVE_CODE_H
+#define ADAPTIVE_CODE_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "linear_code.h"
+#include "codebook_search.h"
+
+using namespace std;
+
+/*
+ * a code of the catalog, built once with its decoder
+ */
+struct CatalogCode
+{
+  CatalogCode( LinearCode param_code )
+  : code( move( param_code ) ), search( code ),
+    rate( static_cast< double >( code.get_dimension() ) /
+          code.get_code_length() )
+  {
+  }
+
+  LinearCode code;
+  CodebookSearch search;
+  double rate;
+};
+
+/**
+ * A controller choosing, block by block, the code a link runs. It
+ * holds a catalog of codes built up front. Each block is decoded with
+ * the current code, and the distance from each received word to its
+ * decoded codeword counts the errors the decoder saw; the bit error
+ * rate of the channel is estimated from those counts, smoothed over
+ * blocks. At the end of a block the code switched to is the one of
+ * highest rate whose word error rate at the estimated bit error rate,
+ * the chance of more than t errors in n bits, meets the target. A
+ * switch is a change of index: nothing is built on the hot path.
+ * Not safe to call from several threads at once.
+ * @author agent
+ * @version 18 October 2026
+ */
+class AdaptiveCodec
+{
+public:
+  /**
+   * Constructor specifying the target
+   * @param target_residual the largest share of words that may be
+   * decoded wrong
+   * @param smoothing the weight of the newest block in the estimate
+   */
+  AdaptiveCodec( double target_residual, double smoothing = 0.25 );
+
+  /**
+   * add a code to the catalog, building its decoder
+   * @param code the code
+   * @return its index
+   */
+  uint add_code( LinearCode code );
+
+  /**
+   * Return the number of codes in the catalog
+   */
+  uint get_num_codes() const;
+
+  /**
+   * Return a code of the catalog
+   * @param index the index of the code
+   */
+  const LinearCode& get_code( uint index ) const;
+
+  /**
+   * Return the index of the code the link is running
+   */
+  uint get_current() const;
+
+  /**
+   * Return the estimated bit error rate of the channel
+   */
+  double get_error_rate() const;
+
+  /**
+   * find the chance a code decodes a word wrong on a channel that
+   * flips each bit independently
+   * @param index the index of the code
+   * @param bit_error_rate the chance a bit is flipped
+   * @return the chance of more errors than the code corrects
+   */
+  double residual_rate( uint index, double bit_error_rate ) const;
+
+  /**
+   * encode a block of messages with the current code
+   * @param messages the messages
+   * @param encoded the codewords, as long as messages
+   */
+  void encode_block( Span< const uint > messages,
+                     Span< uint > encoded ) const;
+
+  /**
+   * decode a block of received words with the current code and count
+   * the errors seen. does no allocation.
+   * @param received the received words
+   * @param messages the decoded messages, as long as received
+   */
+  void decode_block( Span< const uint > received, Span< uint > messages );
+
+  /**
+   * close a block: fold its error counts into the estimate and switch
+   * to the best code for it
+   * @return the index of the code for the next block
+   */
+  uint end_block();
+
+  /**
+   * print the blocks, switches and the time spent on each code
+   * @param out the stream to print to
+   */
+  void print_report( ostream &out ) const;
+
+private:
+
+  /**
+   * pick the code of highest rate meeting the target, or the code of
+   * least residual rate if none does
+   * @param bit_error_rate the estimated bit error rate
+   * @return the index of the code
+   */
+  uint choose_code( double bit_error_rate ) const;
+
+  vector< unique_ptr< CatalogCode > > codes;
+  vector< uint64_t > blocks_on_code;
+  uint current;
+  double target_residual;
+  double smoothing;
+  double error_rate;
+  bool estimated;
+  uint64_t block_words;
+  uint64_t block_errors;
+  uint64_t blocks;
+  uint64_t switches;
+};
+
+AdaptiveCodec::AdaptiveCodec( double param_target_residual,
+                              double param_smoothing )
+: current( 0 ), target_residual( param_target_residual ),
+  smoothing( param_smoothing ), error_rate( 0 ), estimated( false ),
+  block_words( 0 ), block_errors( 0 ), blocks( 0 ), switches( 0 )
+{
+}
+
+uint AdaptiveCodec::add_code( LinearCode code )
+{
+  codes.push_back( unique_ptr< CatalogCode >(
+    new CatalogCode( move( code ) ) ) );
+  blocks_on_code.push_back( 0 );
+
+  //until the channel has been seen, run the strongest code
+  uint index = codes.size() - 1;
+  if( codes[ index ]->code.get_minimum_distance() >
+      codes[ current ]->code.get_minimum_distance() )
+  {
+    current = index;
+  }
+  return index;
+}
+
+uint AdaptiveCodec::get_num_codes() const
+{
+  return codes.size();
+}
+
+const LinearCode& AdaptiveCodec::get_code( uint index ) const
+{
+  return codes[ index ]->code;
+}
+
+uint AdaptiveCodec::get_current() const
+{
+  return current;
+}
+
+double AdaptiveCodec::get_error_rate() const
+{
+  return error_rate;
+}
+
+double AdaptiveCodec::residual_rate( uint index,
+                                     double bit_error_rate ) const
+{
+  //one less the chance of at most t errors among n bits
+  const LinearCode &code = codes[ index ]->code;
+  uint code_length = code.get_code_length();
+  uint correctable = code.get_correction_capability();
+  double correct = 0;
+  double choose = 1;
+  for( uint i = 0; i <= correctable and i <= code_length; i++ )
+  {
+    correct += choose * pow( bit_error_rate, i ) *
+      pow( 1 - bit_error_rate, code_length - i );
+    choose = choose * ( code_length - i ) / ( i + 1 );
+  }
+  return correct < 1 ? 1 - correct : 0;
+}
+
+uint AdaptiveCodec::choose_code( double bit_error_rate ) const
+{
+  uint best = 0;
+  bool best_meets = false;
+  double best_residual = 2;
+  for( uint i = 0; i < codes.size(); i++ )
+  {
+    double residual = residual_rate( i, bit_error_rate );
+    bool meets = residual <= target_residual;
+    bool better;
+    if( meets != best_meets )
+    {
+      better = meets;
+    }
+    else if( meets and codes[ i ]->rate != codes[ best ]->rate )
+    {
+      better = codes[ i ]->rate > codes[ best ]->rate;
+    }
+    else
+    {
+      better = residual < best_residual;
+    }
+    if( better )
+    {
+      best = i;
+      best_meets = meets;
+      best_residual = residual;
+    }
+  }
+  return best;
+}
+
+void AdaptiveCodec::encode_block( Span< const uint > messages,
+                                  Span< uint > encoded ) const
+{
+  codes[ current ]->code.encode_batch( messages, encoded );
+}
+
+void AdaptiveCodec::decode_block( Span< const uint > received,
+                                  Span< uint > messages )
+{
+  if( codes.empty() )
+  {
+    cout << "the catalog has no codes." << endl;
+    return;
+  }
+
+  //decode to codewords first, so the distance each word was moved
+  //can be counted, then read the messages off in place
+  const CatalogCode &entry = *codes[ current ];
+  entry.search.decode_batch( received, messages );
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    block_errors += __builtin_popcount( received[ i ] ^ messages[ i ] );
+    messages[ i ] = entry.code.extract_message( messages[ i ] );
+  }
+  block_words += received.size();
+}
+
+uint AdaptiveCodec::end_block()
+{
+  if( codes.empty() or block_words == 0 )
+  {
+    return current;
+  }
+
+  //the errors seen are a lower bound on the errors made, since a word
+  //with more than t errors may land nearer another codeword
+  double block_rate = static_cast< double >( block_errors ) /
+    ( block_words * codes[ current ]->code.get_code_length() );
+  error_rate = estimated ?
+    smoothing * block_rate + ( 1 - smoothing ) * error_rate : block_rate;
+  estimated = true;
+  blocks_on_code[ current ]++;
+  blocks++;
+  block_words = 0;
+  block_errors = 0;
+
+  uint next = choose_code( error_rate );
+  if( next != current )
+  {
+    TraceScope trace( "code switch", next );
+    switches++;
+    current = next;
+  }
+  return current;
+}
+
+void AdaptiveCodec::print_report( ostream &out ) const
+{
+  out << "adaptive codec: " << blocks << " blocks, " << switches
+      << " switches, estimated bit error rate " << error_rate << endl;
+  for( uint i = 0; i < codes.size(); i++ )
+  {
+    const LinearCode &code = codes[ i ]->code;
+    out << "  [" << code.get_code_length() << ", " << code.get_dimension()
+        << ", " << code.get_minimum_distance() << "] rate "
+        << codes[ i ]->rate << ": " << blocks_on_code[ i ] << " blocks"
+        << endl;
+  }
+}
+
+#endif
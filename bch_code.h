@@ -0,0 +1,659 @@
+#ifndef BCH_CODE_H
+#define BCH_CODE_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include "galois_field.h"
+#include "long_word.h"
+#include "word_span.h"
+#include "codec_stats.h"
+#include "linear_code.h"
+
+using namespace std;
+
+/*
+ * the most errors a BCH code may be built to correct. it bounds the
+ * scratch space the decoder keeps on the stack.
+ */
+const uint MAX_BCH_CORRECTION = 512;
+
+/*
+ * the number of positions the Chien search evaluates together
+ */
+const uint CHIEN_LANES = 16;
+
+/**
+ * A primitive narrow-sense binary BCH code of length n = 2^m - 1,
+ * built from its designed distance. The generator polynomial is the
+ * least common multiple of the minimal polynomials of
+ * alpha^1 .. alpha^( designed distance - 1 ). Encoding is systematic:
+ * the message occupies coordinates n - k .. n - 1 and the parity
+ * coordinates 0 .. n - k - 1. Decoding computes the syndromes over
+ * GF(2^m), finds the error locator with Berlekamp-Massey and its
+ * roots with a Chien search.
+ * @author agent
+ * @version 18 October 2026
+ */
+class BCHCode
+{
+public:
+  /**
+   * Constructor specifying the field and designed distance
+   * @param degree m, so the code length is 2^m - 1 (3 <= m <= 16)
+   * @param designed_distance the designed distance of the code
+   */
+  BCHCode( uint degree, uint designed_distance );
+
+  /**
+   * Return the code length
+   */
+  uint get_code_length() const;
+
+  /**
+   * Return the dimension of the code
+   */
+  uint get_dimension() const;
+
+  /**
+   * Return the designed distance
+   */
+  uint get_designed_distance() const;
+
+  /**
+   * Return the number of errors the decoder corrects
+   */
+  uint get_correction_capability() const;
+
+  /**
+   * Return the generator polynomial, coefficient i at coordinate i
+   */
+  const LongWord& get_generator_polynomial() const;
+
+  /**
+   * Return the generator matrix. Row r is the codeword of message
+   * bit k - 1 - r, the layout LinearCode uses.
+   */
+  const vector< LongWord >& get_generator() const;
+
+  /**
+   * Return the parity check matrix, one row per parity coordinate
+   */
+  const vector< LongWord >& get_parity_check() const;
+
+  /**
+   * encode a message systematically
+   * @param message the k bit message
+   * @return the codeword
+   */
+  LongWord encode_word( const LongWord &message ) const;
+
+  /**
+   * extract the message from a codeword
+   * @param code_word the codeword
+   * @return the k bit message
+   */
+  LongWord extract_message( const LongWord &code_word ) const;
+
+  /**
+   * correct a received word in place. does no allocation.
+   * @param received the received word
+   * @return the number of errors corrected, or -1 if the word could
+   * not be decoded, in which case it is left unchanged
+   */
+  int decode_word( LongWord &received ) const;
+
+  /**
+   * correct a batch of received words in place. may be called from
+   * several threads at once.
+   * @param received the received words
+   * @param corrected the number of errors corrected in each word,
+   * or -1 where decoding failed
+   */
+  void decode_batch( Span< LongWord > received,
+                     Span< int > corrected ) const;
+
+  /**
+   * create the LinearCode with the same generator and parity check
+   * matrices. only codes of length at most 32 fit in a uint, and the
+   * code words are enumerated, so keep the dimension small.
+   * @return the linear code, or the code of length 0 if n > 32
+   */
+  LinearCode to_linear_code() const;
+
+private:
+
+  /**
+   * find the generator polynomial from the cyclotomic cosets
+   */
+  void build_generator_polynomial();
+
+  /**
+   * find the generator and parity check matrices
+   */
+  void build_matrices();
+
+  /**
+   * find the lane offsets used by the Chien search
+   */
+  void build_chien_tables();
+
+  /**
+   * determine the syndromes S_1 .. S_2t of a received word
+   * @param received the received word
+   * @param syndromes the syndromes, indexed from 1
+   * @return whether or not every syndrome is zero
+   */
+  bool find_syndromes( const LongWord &received, uint* syndromes ) const;
+
+  /**
+   * find the error locator with the Berlekamp-Massey algorithm
+   * @param syndromes the syndromes, indexed from 1
+   * @param locator the coefficients of the error locator
+   * @return the degree of the locator
+   */
+  uint berlekamp_massey( const uint* syndromes, uint* locator ) const;
+
+  /**
+   * find the roots of the error locator and flip the coordinates
+   * they locate
+   * @param locator the coefficients of the error locator
+   * @param locator_degree its degree
+   * @param positions the located coordinates
+   * @return the number of roots found
+   */
+  uint chien_search( const uint* locator, uint locator_degree,
+                     uint* positions ) const;
+
+  GaloisField field;
+  uint code_length;
+  uint dimension;
+  uint designed_distance;
+  uint correction_capability;
+  LongWord generator_polynomial;
+  vector< LongWord > parity_rows;
+  vector< LongWord > generator;
+  vector< LongWord > parity_check;
+  vector< uint > chien_lane_offsets;
+  vector< uint > chien_chunk_strides;
+};
+
+BCHCode::BCHCode( uint degree, uint param_designed_distance )
+: field( degree ), code_length( ( 1u << degree ) - 1 ), dimension( 0 ),
+  designed_distance( param_designed_distance )
+{
+  TraceScope trace( "bch construction" );
+
+  if( designed_distance > code_length )
+  {
+    cout << "designed distance exceeds the code length." << endl;
+    designed_distance = code_length;
+  }
+  correction_capability = designed_distance > 0 ?
+    ( designed_distance - 1 ) / 2 : 0;
+  if( correction_capability > MAX_BCH_CORRECTION )
+  {
+    cout << "designed distance exceeds the decoder limit." << endl;
+    correction_capability = MAX_BCH_CORRECTION;
+    designed_distance = 2 * MAX_BCH_CORRECTION + 1;
+  }
+
+  build_generator_polynomial();
+  build_matrices();
+  build_chien_tables();
+}
+
+void BCHCode::build_generator_polynomial()
+{
+  //collect the exponents of the zeros of the code, closing each of
+  //alpha^1 .. alpha^( d - 1 ) under squaring
+  vector< bool > is_zero( code_length, false );
+  vector< uint > coefficients( 1, 1 );
+  for( uint i = 1; i < designed_distance; i++ )
+  {
+    if( is_zero.at( i % code_length ) )
+    {
+      continue;
+    }
+
+    //multiply in the minimal polynomial of alpha^i, the product of
+    //( x + alpha^j ) over the cyclotomic coset of i
+    uint j = i % code_length;
+    do
+    {
+      is_zero.at( j ) = true;
+      uint root = field.alpha_power( j );
+      coefficients.push_back( 0 );
+      for( uint place = coefficients.size() - 1; place > 0; place-- )
+      {
+        coefficients.at( place ) = coefficients.at( place - 1 ) ^
+          field.multiply( coefficients.at( place ), root );
+      }
+      coefficients.at( 0 ) = field.multiply( coefficients.at( 0 ), root );
+      j = ( 2 * j ) % code_length;
+    }
+    while( j != i % code_length );
+  }
+
+  //the product of the minimal polynomials has binary coefficients
+  generator_polynomial = new_long_word( coefficients.size() );
+  for( uint place = 0; place < coefficients.size(); place++ )
+  {
+    if( coefficients.at( place ) == 1 )
+    {
+      set_bit( generator_polynomial, place );
+    }
+  }
+  dimension = code_length - ( coefficients.size() - 1 );
+}
+
+void BCHCode::build_matrices()
+{
+  //parity_rows[ p ] is x^( n - k + p ) mod g(x), the parity added
+  //by message bit p. start from x^( n - k ) mod g(x), which is g(x)
+  //without its leading term, and multiply by x each step
+  uint redundancy = code_length - dimension;
+  LongWord remainder = new_long_word( code_length );
+  for( uint place = 0; place < redundancy; place++ )
+  {
+    if( get_bit( generator_polynomial, place ) )
+    {
+      set_bit( remainder, place );
+    }
+  }
+
+  parity_rows.clear();
+  for( uint p = 0; p < dimension; p++ )
+  {
+    parity_rows.push_back( remainder );
+
+    //multiply by x, then reduce the x^( n - k ) term by g(x)
+    if( redundancy == 0 )
+    {
+      continue;
+    }
+    uint carry = get_bit( remainder, redundancy - 1 );
+    for( uint block = remainder.size() - 1; block > 0; block-- )
+    {
+      remainder[ block ] = ( remainder[ block ] << 1 ) |
+        ( remainder[ block - 1 ] >> 63 );
+    }
+    remainder[ 0 ] <<= 1;
+    if( get_bit( remainder, redundancy ) )
+    {
+      flip_bit( remainder, redundancy );
+    }
+    if( carry )
+    {
+      for( uint place = 0; place < redundancy; place++ )
+      {
+        if( get_bit( generator_polynomial, place ) )
+        {
+          flip_bit( remainder, place );
+        }
+      }
+    }
+  }
+
+  //row r of G encodes message bit k - 1 - r
+  generator.clear();
+  for( uint r = 0; r < dimension; r++ )
+  {
+    uint p = dimension - 1 - r;
+    LongWord row = parity_rows.at( p );
+    set_bit( row, redundancy + p );
+    generator.push_back( row );
+  }
+
+  //row j of H checks parity coordinate j against the message
+  //coordinates whose parity row covers it
+  parity_check.clear();
+  for( uint j = 0; j < redundancy; j++ )
+  {
+    LongWord row = new_long_word( code_length );
+    set_bit( row, j );
+    for( uint p = 0; p < dimension; p++ )
+    {
+      if( get_bit( parity_rows.at( p ), j ) )
+      {
+        set_bit( row, redundancy + p );
+      }
+    }
+    parity_check.push_back( row );
+  }
+}
+
+void BCHCode::build_chien_tables()
+{
+  //the term lambda_j alpha^( -i j ) has log log( lambda_j ) + i
+  //( n - j ), so position i + l of a chunk is lane_offset( j, l )
+  //past position i, and the next chunk is chunk_stride( j ) further
+  uint terms = correction_capability + 1;
+  chien_lane_offsets.assign( terms * CHIEN_LANES, 0 );
+  chien_chunk_strides.assign( terms, 0 );
+  for( uint j = 0; j < terms; j++ )
+  {
+    uint stride = ( code_length - j % code_length ) % code_length;
+    for( uint lane = 0; lane < CHIEN_LANES; lane++ )
+    {
+      chien_lane_offsets.at( j * CHIEN_LANES + lane ) =
+        static_cast< uint >( ( uint64_t( lane ) * stride ) % code_length );
+    }
+    chien_chunk_strides.at( j ) = static_cast< uint >(
+      ( uint64_t( CHIEN_LANES ) * stride ) % code_length );
+  }
+}
+
+uint BCHCode::get_code_length() const
+{
+  return code_length;
+}
+
+uint BCHCode::get_dimension() const
+{
+  return dimension;
+}
+
+uint BCHCode::get_designed_distance() const
+{
+  return designed_distance;
+}
+
+uint BCHCode::get_correction_capability() const
+{
+  return correction_capability;
+}
+
+const LongWord& BCHCode::get_generator_polynomial() const
+{
+  return generator_polynomial;
+}
+
+const vector< LongWord >& BCHCode::get_generator() const
+{
+  return generator;
+}
+
+const vector< LongWord >& BCHCode::get_parity_check() const
+{
+  return parity_check;
+}
+
+LongWord BCHCode::encode_word( const LongWord &message ) const
+{
+  //copy the message into the high coordinates and add the parity
+  //row of every nonzero message bit
+  uint redundancy = code_length - dimension;
+  LongWord code_word = new_long_word( code_length );
+  for( uint block = 0; block < message.size(); block++ )
+  {
+    uint64_t bits = message[ block ];
+    while( bits != 0 )
+    {
+      uint p = block * 64 + __builtin_ctzll( bits );
+      bits &= bits - 1;
+      if( p >= dimension )
+      {
+        break;
+      }
+      add_long_word( code_word, parity_rows[ p ] );
+      set_bit( code_word, redundancy + p );
+    }
+  }
+  CodecStats::count( WORDS_ENCODED );
+  return code_word;
+}
+
+LongWord BCHCode::extract_message( const LongWord &code_word ) const
+{
+  uint redundancy = code_length - dimension;
+  LongWord message = new_long_word( dimension );
+  for( uint p = 0; p < dimension; p++ )
+  {
+    if( get_bit( code_word, redundancy + p ) )
+    {
+      set_bit( message, p );
+    }
+  }
+  return message;
+}
+
+bool BCHCode::find_syndromes( const LongWord &received,
+                              uint* syndromes ) const
+{
+  const vector< uint16_t > &antilog = field.get_antilog_table();
+  uint checks = 2 * correction_capability;
+  for( uint j = 0; j <= checks; j++ )
+  {
+    syndromes[ j ] = 0;
+  }
+
+  //S_j = r( alpha^j ). only the odd syndromes are summed, since
+  //S_2j = S_j^2 for a binary word
+  for( uint block = 0; block < received.size(); block++ )
+  {
+    uint64_t bits = received[ block ];
+    while( bits != 0 )
+    {
+      uint position = block * 64 + __builtin_ctzll( bits );
+      bits &= bits - 1;
+      uint exponent = position % code_length;
+      uint step = ( 2 * exponent ) % code_length;
+      for( uint j = 1; j <= checks; j += 2 )
+      {
+        syndromes[ j ] ^= antilog[ exponent ];
+        exponent += step;
+        if( exponent >= code_length )
+        {
+          exponent -= code_length;
+        }
+      }
+    }
+  }
+
+  bool all_zero = true;
+  for( uint j = 1; j <= checks; j++ )
+  {
+    if( j % 2 == 0 )
+    {
+      syndromes[ j ] = field.multiply( syndromes[ j / 2 ],
+                                       syndromes[ j / 2 ] );
+    }
+    if( syndromes[ j ] != 0 )
+    {
+      all_zero = false;
+    }
+  }
+  return all_zero;
+}
+
+uint BCHCode::berlekamp_massey( const uint* syndromes,
+                                uint* locator ) const
+{
+  uint checks = 2 * correction_capability;
+  uint previous[ 2 * MAX_BCH_CORRECTION + 2 ];
+  uint scratch[ 2 * MAX_BCH_CORRECTION + 2 ];
+  for( uint i = 0; i <= checks; i++ )
+  {
+    locator[ i ] = 0;
+    previous[ i ] = 0;
+  }
+  locator[ 0 ] = 1;
+  previous[ 0 ] = 1;
+
+  uint degree = 0;
+  uint shift = 1;
+  uint previous_discrepancy = 1;
+  for( uint r = 0; r < checks; r++ )
+  {
+    //the discrepancy between S_( r + 1 ) and the value the current
+    //locator predicts for it
+    uint discrepancy = syndromes[ r + 1 ];
+    for( uint i = 1; i <= degree; i++ )
+    {
+      discrepancy ^= field.multiply( locator[ i ],
+                                     syndromes[ r + 1 - i ] );
+    }
+
+    if( discrepancy == 0 )
+    {
+      shift++;
+      continue;
+    }
+
+    //locator -= ( discrepancy / previous ) x^shift previous
+    uint scale = field.divide( discrepancy, previous_discrepancy );
+    bool lengthen = 2 * degree <= r;
+    if( lengthen )
+    {
+      for( uint i = 0; i <= checks; i++ )
+      {
+        scratch[ i ] = locator[ i ];
+      }
+    }
+    for( uint i = 0; i + shift <= checks; i++ )
+    {
+      locator[ i + shift ] ^= field.multiply( scale, previous[ i ] );
+    }
+    if( lengthen )
+    {
+      degree = r + 1 - degree;
+      for( uint i = 0; i <= checks; i++ )
+      {
+        previous[ i ] = scratch[ i ];
+      }
+      previous_discrepancy = discrepancy;
+      shift = 1;
+    }
+    else
+    {
+      shift++;
+    }
+  }
+  return degree;
+}
+
+uint BCHCode::chien_search( const uint* locator, uint locator_degree,
+                            uint* positions ) const
+{
+  const uint16_t* antilog = field.get_antilog_table().data();
+  const uint16_t* log = field.get_log_table().data();
+
+  //the log of each nonzero term at the start of the current chunk
+  uint term_logs[ MAX_BCH_CORRECTION + 1 ];
+  uint term_indices[ MAX_BCH_CORRECTION + 1 ];
+  uint num_terms = 0;
+  for( uint j = 1; j <= locator_degree; j++ )
+  {
+    if( locator[ j ] != 0 )
+    {
+      term_logs[ num_terms ] = log[ locator[ j ] ];
+      term_indices[ num_terms ] = j;
+      num_terms++;
+    }
+  }
+
+  //evaluate the locator at alpha^( -i ) for CHIEN_LANES positions
+  //at a time. the lanes are independent and laid out so that, in an
+  //optimized build with gathers, the inner loop vectorizes into table
+  //gathers and xors
+  uint num_roots = 0;
+  for( uint chunk = 0; chunk < code_length; chunk += CHIEN_LANES )
+  {
+    uint sums[ CHIEN_LANES ];
+    for( uint lane = 0; lane < CHIEN_LANES; lane++ )
+    {
+      sums[ lane ] = locator[ 0 ];
+    }
+    for( uint t = 0; t < num_terms; t++ )
+    {
+      const uint* offsets =
+        &chien_lane_offsets[ term_indices[ t ] * CHIEN_LANES ];
+      uint start = term_logs[ t ];
+      for( uint lane = 0; lane < CHIEN_LANES; lane++ )
+      {
+        sums[ lane ] ^= antilog[ start + offsets[ lane ] ];
+      }
+      start += chien_chunk_strides[ term_indices[ t ] ];
+      term_logs[ t ] = start >= code_length ? start - code_length : start;
+    }
+
+    for( uint lane = 0; lane < CHIEN_LANES; lane++ )
+    {
+      if( sums[ lane ] == 0 and chunk + lane < code_length )
+      {
+        if( num_roots == locator_degree )
+        {
+          //more roots than the degree cannot happen for a valid
+          //locator, so report it as a failure
+          return num_roots + 1;
+        }
+        positions[ num_roots ] = chunk + lane;
+        num_roots++;
+      }
+    }
+  }
+  return num_roots;
+}
+
+int BCHCode::decode_word( LongWord &received ) const
+{
+  uint syndromes[ 2 * MAX_BCH_CORRECTION + 2 ];
+  uint locator[ 2 * MAX_BCH_CORRECTION + 2 ];
+  uint positions[ MAX_BCH_CORRECTION + 1 ];
+
+  int corrected = 0;
+  if( !find_syndromes( received, syndromes ) )
+  {
+    //a locator of degree L has L roots exactly when at most t errors
+    //occurred; otherwise the word is beyond the decoding radius
+    uint locator_degree = berlekamp_massey( syndromes, locator );
+    uint num_roots = locator_degree > correction_capability ? 0 :
+      chien_search( locator, locator_degree, positions );
+    if( locator_degree > correction_capability or
+        num_roots != locator_degree )
+    {
+      corrected = -1;
+    }
+    else
+    {
+      for( uint i = 0; i < num_roots; i++ )
+      {
+        flip_bit( received, positions[ i ] );
+      }
+      corrected = num_roots;
+    }
+  }
+
+  if( CodecStats::is_enabled() )
+  {
+    CodecStats::count( WORDS_DECODED );
+    if( corrected < 0 )
+    {
+      CodecStats::count( DECODE_FAILURES );
+    }
+    else
+    {
+      CodecStats::count( ERRORS_CORRECTED, corrected );
+    }
+  }
+  return corrected;
+}
+
+void BCHCode::decode_batch( Span< LongWord > received,
+                            Span< int > corrected ) const
+{
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    corrected[ i ] = decode_word( received[ i ] );
+  }
+}
+
+LinearCode BCHCode::to_linear_code() const
+{
+  return narrow_linear_code( generator, parity_check, code_length );
+}
+
+#endif
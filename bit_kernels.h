@@ -0,0 +1,841 @@
+#ifndef BIT_KERNELS_H
+#define BIT_KERNELS_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <iostream>
+#include <immintrin.h>
+
+using namespace std;
+
+/*
+ * the instruction set levels there are kernels for
+ */
+enum CpuLevel
+{
+  CPU_SCALAR,
+  CPU_SSE42,
+  CPU_AVX2,
+  CPU_AVX512,
+  NUM_CPU_LEVELS
+};
+
+/*
+ * the most received words a batched tile kernel takes at once
+ */
+const uint TILE_MAX_RECEIVED = 16;
+
+/*
+ * the hot bit kernels of one instruction set level. rows are uints,
+ * one row of a matrix each, at most 32 of them where a result packs a
+ * bit per row.
+ */
+struct BitKernels
+{
+  CpuLevel level;
+  const char* name;
+
+  //the hamming weight of a word
+  uint ( *weight )( uint word );
+
+  //bit r of the result is the parity of rows[ r ] & word
+  uint ( *syndrome )( const uint* rows, uint num_rows, uint word );
+
+  //the sum of rows[ num_rows - 1 - p ] over the set bits p of message
+  uint ( *encode )( const uint* rows, uint num_rows, uint message );
+
+  //the least hamming distance from received to any of words
+  uint ( *tile_min )( const uint* words, uint count, uint received );
+
+  //least[ r ] is the least hamming distance from received[ r ] to any
+  //of words, each word loaded once for every received word
+  void ( *tile_min_batch )( const uint* words, uint count,
+                            const uint* received, uint num_received,
+                            uint* least );
+
+  //bit r of columns[ c ] is bit c of rows[ r ]
+  void ( *transpose )( const uint* rows, uint num_rows, uint num_columns,
+                       uint* columns );
+
+  //add rows[ pivot_row ] to every other row with a bit under pivot_mask
+  void ( *eliminate )( uint* rows, uint num_rows, uint pivot_row,
+                       uint pivot_mask );
+
+  //the bits of word under mask, gathered into the low bits in order
+  uint ( *gather_bits )( uint word, uint mask );
+};
+
+//the bodies are written once and inlined into a function per target,
+//so the same loop compiles to popcnt where the target has it
+
+/**
+ * find the parities of a word with each of a set of rows
+ * @param rows the rows
+ * @param num_rows the number of rows, at most 32
+ * @param word the word
+ * @return the parities, bit r for row r
+ */
+static inline __attribute__(( always_inline ))
+uint syndrome_body( const uint* rows, uint num_rows, uint word )
+{
+  uint result = 0;
+  for( uint r = 0; r < num_rows; r++ )
+  {
+    result |= static_cast< uint >( __builtin_popcount( rows[ r ] & word ) & 1 )
+      << r;
+  }
+  return result;
+}
+
+/**
+ * add the rows a message selects, branch free
+ * @param rows the rows
+ * @param num_rows the number of rows, at most 32
+ * @param message the message; bit p selects row num_rows - 1 - p
+ * @return the sum of the rows
+ */
+static inline __attribute__(( always_inline ))
+uint encode_body( const uint* rows, uint num_rows, uint message )
+{
+  uint result = 0;
+  for( uint r = 0; r < num_rows; r++ )
+  {
+    uint bit = ( message >> ( num_rows - 1 - r ) ) & 1;
+    result ^= rows[ r ] & ( 0u - bit );
+  }
+  return result;
+}
+
+/**
+ * find the least distance from a received word to a run of words
+ * @param words the words
+ * @param count the number of words
+ * @param received the received word
+ * @return the least hamming distance, or UINT_MAX if count is 0
+ */
+static inline __attribute__(( always_inline ))
+uint tile_min_body( const uint* words, uint count, uint received )
+{
+  uint least = UINT_MAX;
+  for( uint i = 0; i < count; i++ )
+  {
+    uint distance = __builtin_popcount( words[ i ] ^ received );
+    least = distance < least ? distance : least;
+  }
+  return least;
+}
+
+/**
+ * find the least distance from each of a batch of received words to a
+ * run of words
+ * @param words the words
+ * @param count the number of words
+ * @param received the received words
+ * @param num_received the number of received words, at most
+ * TILE_MAX_RECEIVED
+ * @param least the least hamming distance of each received word, or
+ * UINT_MAX if count is 0
+ */
+static inline __attribute__(( always_inline ))
+void tile_min_batch_body( const uint* words, uint count,
+                          const uint* received, uint num_received,
+                          uint* least )
+{
+  for( uint r = 0; r < num_received; r++ )
+  {
+    least[ r ] = UINT_MAX;
+  }
+  for( uint i = 0; i < count; i++ )
+  {
+    uint word = words[ i ];
+    for( uint r = 0; r < num_received; r++ )
+    {
+      uint distance = __builtin_popcount( word ^ received[ r ] );
+      least[ r ] = distance < least[ r ] ? distance : least[ r ];
+    }
+  }
+}
+
+/**
+ * transpose a matrix of at most 32 rows
+ * @param rows the rows
+ * @param num_rows the number of rows
+ * @param num_columns the number of columns, at most 32
+ * @param columns the columns, num_columns of them
+ */
+static inline __attribute__(( always_inline ))
+void transpose_body( const uint* rows, uint num_rows, uint num_columns,
+                     uint* columns )
+{
+  for( uint c = 0; c < num_columns; c++ )
+  {
+    uint column = 0;
+    for( uint r = 0; r < num_rows; r++ )
+    {
+      column |= ( ( rows[ r ] >> c ) & 1 ) << r;
+    }
+    columns[ c ] = column;
+  }
+}
+
+/**
+ * clear a column of every row but the pivot row by adding the pivot
+ * row to the rows with a bit there, branch free
+ * @param rows the rows
+ * @param num_rows the number of rows
+ * @param pivot_row the index of the pivot row
+ * @param pivot_mask the bit of the column
+ */
+static inline __attribute__(( always_inline ))
+void eliminate_body( uint* rows, uint num_rows, uint pivot_row,
+                     uint pivot_mask )
+{
+  uint pivot = rows[ pivot_row ];
+  for( uint r = 0; r < num_rows; r++ )
+  {
+    uint has_bit = ( rows[ r ] & pivot_mask ) != 0;
+    rows[ r ] ^= pivot & ( 0u - has_bit );
+  }
+  rows[ pivot_row ] = pivot;
+}
+
+/**
+ * gather the bits of a word under a mask into the low bits, in order,
+ * one bit at a time
+ * @param word the word
+ * @param mask the places to gather
+ * @return the gathered bits
+ */
+static inline __attribute__(( always_inline ))
+uint gather_bits_body( uint word, uint mask )
+{
+  uint gathered = 0;
+  for( uint bit = 0; mask != 0; bit++ )
+  {
+    uint place = __builtin_ctz( mask );
+    gathered |= ( ( word >> place ) & 1 ) << bit;
+    mask &= mask - 1;
+  }
+  return gathered;
+}
+
+/* scalar: no instructions past the x86-64 baseline */
+
+uint weight_scalar( uint word )
+{
+  //the SWAR count, since the baseline has no popcnt
+  word = word - ( ( word >> 1 ) & 0x55555555 );
+  word = ( word & 0x33333333 ) + ( ( word >> 2 ) & 0x33333333 );
+  word = ( word + ( word >> 4 ) ) & 0x0F0F0F0F;
+  return ( word * 0x01010101 ) >> 24;
+}
+
+uint syndrome_scalar( const uint* rows, uint num_rows, uint word )
+{
+  return syndrome_body( rows, num_rows, word );
+}
+
+uint encode_scalar( const uint* rows, uint num_rows, uint message )
+{
+  return encode_body( rows, num_rows, message );
+}
+
+uint tile_min_scalar( const uint* words, uint count, uint received )
+{
+  return tile_min_body( words, count, received );
+}
+
+void tile_min_batch_scalar( const uint* words, uint count,
+                            const uint* received, uint num_received,
+                            uint* least )
+{
+  tile_min_batch_body( words, count, received, num_received, least );
+}
+
+void transpose_scalar( const uint* rows, uint num_rows, uint num_columns,
+                       uint* columns )
+{
+  transpose_body( rows, num_rows, num_columns, columns );
+}
+
+void eliminate_scalar( uint* rows, uint num_rows, uint pivot_row,
+                       uint pivot_mask )
+{
+  eliminate_body( rows, num_rows, pivot_row, pivot_mask );
+}
+
+uint gather_bits_scalar( uint word, uint mask )
+{
+  return gather_bits_body( word, mask );
+}
+
+/* SSE4.2: the scalar loops with the popcnt instruction */
+
+__attribute__(( target( "popcnt,sse4.2" ) ))
+uint weight_sse42( uint word )
+{
+  return __builtin_popcount( word );
+}
+
+__attribute__(( target( "popcnt,sse4.2" ) ))
+uint syndrome_sse42( const uint* rows, uint num_rows, uint word )
+{
+  return syndrome_body( rows, num_rows, word );
+}
+
+__attribute__(( target( "popcnt,sse4.2" ) ))
+uint tile_min_sse42( const uint* words, uint count, uint received )
+{
+  return tile_min_body( words, count, received );
+}
+
+__attribute__(( target( "popcnt,sse4.2" ) ))
+void tile_min_batch_sse42( const uint* words, uint count,
+                           const uint* received, uint num_received,
+                           uint* least )
+{
+  tile_min_batch_body( words, count, received, num_received, least );
+}
+
+/* AVX2: eight rows or words to a vector */
+
+/**
+ * count the bits of each 32 bit lane with nibble lookups
+ * @param x the lanes
+ * @return the count of each lane
+ */
+__attribute__(( target( "avx2" ) ))
+static inline __m256i popcount_lanes_avx2( __m256i x )
+{
+  const __m256i nibble_counts = _mm256_setr_epi8(
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+  const __m256i low_nibbles = _mm256_set1_epi8( 0x0F );
+  __m256i low = _mm256_and_si256( x, low_nibbles );
+  __m256i high = _mm256_and_si256( _mm256_srli_epi16( x, 4 ), low_nibbles );
+  __m256i bytes = _mm256_add_epi8( _mm256_shuffle_epi8( nibble_counts, low ),
+                                   _mm256_shuffle_epi8( nibble_counts, high ) );
+  bytes = _mm256_add_epi32( bytes, _mm256_srli_epi32( bytes, 8 ) );
+  bytes = _mm256_add_epi32( bytes, _mm256_srli_epi32( bytes, 16 ) );
+  return _mm256_and_si256( bytes, _mm256_set1_epi32( 0x3F ) );
+}
+
+/**
+ * find the least of eight lanes
+ * @param lanes the lanes
+ * @return the least
+ */
+__attribute__(( target( "avx2" ) ))
+static inline uint fold_min_avx2( __m256i lanes )
+{
+  __m128i half = _mm_min_epu32( _mm256_castsi256_si128( lanes ),
+                                _mm256_extracti128_si256( lanes, 1 ) );
+  half = _mm_min_epu32( half, _mm_shuffle_epi32( half, 0x4E ) );
+  half = _mm_min_epu32( half, _mm_shuffle_epi32( half, 0xB1 ) );
+  return static_cast< uint >( _mm_cvtsi128_si32( half ) );
+}
+
+/**
+ * find the parities of a word with eight rows at a time, folding each
+ * lane to its parity and gathering the parities with movemask
+ */
+__attribute__(( target( "avx2,popcnt" ) ))
+uint syndrome_avx2( const uint* rows, uint num_rows, uint word )
+{
+  __m256i broadcast = _mm256_set1_epi32( static_cast< int >( word ) );
+  uint result = 0;
+  uint r = 0;
+  for( ; r + 8 <= num_rows; r += 8 )
+  {
+    __m256i x = _mm256_and_si256( broadcast, _mm256_loadu_si256(
+      reinterpret_cast< const __m256i* >( rows + r ) ) );
+
+    //fold each lane to its parity, then move the parities to bits
+    x = _mm256_xor_si256( x, _mm256_srli_epi32( x, 16 ) );
+    x = _mm256_xor_si256( x, _mm256_srli_epi32( x, 8 ) );
+    x = _mm256_xor_si256( x, _mm256_srli_epi32( x, 4 ) );
+    x = _mm256_xor_si256( x, _mm256_srli_epi32( x, 2 ) );
+    x = _mm256_xor_si256( x, _mm256_srli_epi32( x, 1 ) );
+    uint bits = _mm256_movemask_ps(
+      _mm256_castsi256_ps( _mm256_slli_epi32( x, 31 ) ) );
+    result |= bits << r;
+  }
+
+  //a multiple of eight rows leaves none, and at 32 the shift by r
+  //would be undefined
+  if( r < num_rows )
+  {
+    result |= syndrome_body( rows + r, num_rows - r, word ) << r;
+  }
+  return result;
+}
+
+/**
+ * add the rows a message selects, eight rows at a time, each lane
+ * shifting its own message bit down with a variable shift
+ */
+__attribute__(( target( "avx2" ) ))
+uint encode_avx2( const uint* rows, uint num_rows, uint message )
+{
+  __m256i broadcast = _mm256_set1_epi32( static_cast< int >( message ) );
+  const __m256i lane_index = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+  const __m256i one = _mm256_set1_epi32( 1 );
+  __m256i sum = _mm256_setzero_si256();
+  uint r = 0;
+  for( ; r + 8 <= num_rows; r += 8 )
+  {
+    //row r + j takes message bit num_rows - 1 - r - j
+    __m256i shifts = _mm256_sub_epi32(
+      _mm256_set1_epi32( static_cast< int >( num_rows - 1 - r ) ), lane_index );
+    __m256i bits = _mm256_and_si256( _mm256_srlv_epi32( broadcast, shifts ),
+                                     one );
+    __m256i mask = _mm256_sub_epi32( _mm256_setzero_si256(), bits );
+    sum = _mm256_xor_si256( sum, _mm256_and_si256( mask, _mm256_loadu_si256(
+      reinterpret_cast< const __m256i* >( rows + r ) ) ) );
+  }
+  __m128i half = _mm_xor_si128( _mm256_castsi256_si128( sum ),
+                                _mm256_extracti128_si256( sum, 1 ) );
+  half = _mm_xor_si128( half, _mm_shuffle_epi32( half, 0x4E ) );
+  half = _mm_xor_si128( half, _mm_shuffle_epi32( half, 0xB1 ) );
+  uint result = static_cast< uint >( _mm_cvtsi128_si32( half ) );
+
+  //the remaining rows take the lowest message bits
+  for( ; r < num_rows; r++ )
+  {
+    uint bit = ( message >> ( num_rows - 1 - r ) ) & 1;
+    result ^= rows[ r ] & ( 0u - bit );
+  }
+  return result;
+}
+
+/**
+ * find the least distance to a run of words, eight words at a time.
+ * AVX2 has no vector popcount, so each byte is counted with a nibble
+ * table lookup and the bytes of each word summed.
+ */
+__attribute__(( target( "avx2,popcnt" ) ))
+uint tile_min_avx2( const uint* words, uint count, uint received )
+{
+  __m256i broadcast = _mm256_set1_epi32( static_cast< int >( received ) );
+  __m256i least = _mm256_set1_epi32( -1 );
+  uint i = 0;
+  for( ; i + 8 <= count; i += 8 )
+  {
+    __m256i x = _mm256_xor_si256( broadcast, _mm256_loadu_si256(
+      reinterpret_cast< const __m256i* >( words + i ) ) );
+    least = _mm256_min_epu32( least, popcount_lanes_avx2( x ) );
+  }
+
+  //fold the eight lanes, then finish the tail one word at a time
+  uint result = fold_min_avx2( least );
+  uint tail = tile_min_body( words + i, count - i, received );
+  return tail < result ? tail : result;
+}
+
+/**
+ * find the least distance of a batch of received words to a run of
+ * words, loading eight words at a time and running every received
+ * word against them
+ */
+__attribute__(( target( "avx2,popcnt" ) ))
+void tile_min_batch_avx2( const uint* words, uint count,
+                          const uint* received, uint num_received,
+                          uint* least )
+{
+  __m256i lane_least[ TILE_MAX_RECEIVED ];
+  for( uint r = 0; r < num_received; r++ )
+  {
+    lane_least[ r ] = _mm256_set1_epi32( -1 );
+  }
+  uint i = 0;
+  for( ; i + 8 <= count; i += 8 )
+  {
+    __m256i block = _mm256_loadu_si256(
+      reinterpret_cast< const __m256i* >( words + i ) );
+    for( uint r = 0; r < num_received; r++ )
+    {
+      __m256i x = _mm256_xor_si256( block, _mm256_set1_epi32(
+        static_cast< int >( received[ r ] ) ) );
+      lane_least[ r ] = _mm256_min_epu32( lane_least[ r ],
+                                          popcount_lanes_avx2( x ) );
+    }
+  }
+
+  //the tail one word at a time, then fold the lanes into it
+  tile_min_batch_body( words + i, count - i, received, num_received,
+                       least );
+  for( uint r = 0; r < num_received; r++ )
+  {
+    uint result = fold_min_avx2( lane_least[ r ] );
+    least[ r ] = result < least[ r ] ? result : least[ r ];
+  }
+}
+
+/**
+ * transpose eight rows at a time, shifting bit c of each to its sign
+ * bit and gathering the signs with movemask
+ */
+__attribute__(( target( "avx2" ) ))
+void transpose_avx2( const uint* rows, uint num_rows, uint num_columns,
+                     uint* columns )
+{
+  for( uint c = 0; c < num_columns; c++ )
+  {
+    columns[ c ] = 0;
+  }
+  uint r = 0;
+  for( ; r + 8 <= num_rows; r += 8 )
+  {
+    __m256i block = _mm256_loadu_si256(
+      reinterpret_cast< const __m256i* >( rows + r ) );
+    for( uint c = 0; c < num_columns; c++ )
+    {
+      __m256i shifted = _mm256_sllv_epi32(
+        block, _mm256_set1_epi32( static_cast< int >( 31 - c ) ) );
+      uint bits = _mm256_movemask_ps( _mm256_castsi256_ps( shifted ) );
+      columns[ c ] |= bits << r;
+    }
+  }
+  for( ; r < num_rows; r++ )
+  {
+    for( uint c = 0; c < num_columns; c++ )
+    {
+      columns[ c ] |= ( ( rows[ r ] >> c ) & 1 ) << r;
+    }
+  }
+}
+
+/**
+ * clear a column, eight rows at a time with a compare for the mask
+ */
+__attribute__(( target( "avx2" ) ))
+void eliminate_avx2( uint* rows, uint num_rows, uint pivot_row,
+                     uint pivot_mask )
+{
+  uint pivot = rows[ pivot_row ];
+  __m256i pivot_lanes = _mm256_set1_epi32( static_cast< int >( pivot ) );
+  __m256i mask_lanes = _mm256_set1_epi32( static_cast< int >( pivot_mask ) );
+  __m256i zero = _mm256_setzero_si256();
+  uint r = 0;
+  for( ; r + 8 <= num_rows; r += 8 )
+  {
+    __m256i* block = reinterpret_cast< __m256i* >( rows + r );
+    __m256i x = _mm256_loadu_si256( block );
+    __m256i clear = _mm256_cmpeq_epi32( _mm256_and_si256( x, mask_lanes ),
+                                        zero );
+    _mm256_storeu_si256( block, _mm256_xor_si256(
+      x, _mm256_andnot_si256( clear, pivot_lanes ) ) );
+  }
+  for( ; r < num_rows; r++ )
+  {
+    uint has_bit = ( rows[ r ] & pivot_mask ) != 0;
+    rows[ r ] ^= pivot & ( 0u - has_bit );
+  }
+  rows[ pivot_row ] = pivot;
+}
+
+/**
+ * gather the bits of a word under a mask with a single pext
+ */
+__attribute__(( target( "bmi2" ) ))
+uint gather_bits_bmi2( uint word, uint mask )
+{
+  return _pext_u32( word, mask );
+}
+
+/* AVX-512: sixteen rows or words to a vector, with masked tails and
+ * the vector popcount */
+
+/**
+ * the lanes of a block of sixteen that are before an end
+ * @param remaining the elements left from the start of the block
+ * @return the mask of the lanes to use
+ */
+static inline __mmask16 tail_lanes( uint remaining )
+{
+  return remaining >= 16 ? static_cast< __mmask16 >( 0xFFFF ) :
+    static_cast< __mmask16 >( ( 1u << remaining ) - 1 );
+}
+
+/**
+ * find the parities of a word with sixteen rows at a time, the parity
+ * being the low bit of the vector popcount
+ */
+__attribute__(( target( "avx512f,avx512vpopcntdq,popcnt" ) ))
+uint syndrome_avx512( const uint* rows, uint num_rows, uint word )
+{
+  __m512i broadcast = _mm512_set1_epi32( static_cast< int >( word ) );
+  __m512i one = _mm512_set1_epi32( 1 );
+  uint result = 0;
+  for( uint r = 0; r < num_rows; r += 16 )
+  {
+    __mmask16 lanes = tail_lanes( num_rows - r );
+    __m512i x = _mm512_and_si512( broadcast,
+                                  _mm512_maskz_loadu_epi32( lanes, rows + r ) );
+    uint bits = _mm512_test_epi32_mask( _mm512_popcnt_epi32( x ), one );
+    result |= bits << r;
+  }
+  return result;
+}
+
+/**
+ * add the rows a message selects, sixteen rows at a time
+ */
+__attribute__(( target( "avx512f" ) ))
+uint encode_avx512( const uint* rows, uint num_rows, uint message )
+{
+  __m512i broadcast = _mm512_set1_epi32( static_cast< int >( message ) );
+  const __m512i lane_index = _mm512_setr_epi32(
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+  __m512i one = _mm512_set1_epi32( 1 );
+  __m512i sum = _mm512_setzero_si512();
+  for( uint r = 0; r < num_rows; r += 16 )
+  {
+    //row r + j takes message bit num_rows - 1 - r - j; the lanes past
+    //the end are masked out
+    __mmask16 lanes = tail_lanes( num_rows - r );
+    __m512i shifts = _mm512_sub_epi32(
+      _mm512_set1_epi32( static_cast< int >( num_rows - 1 - r ) ), lane_index );
+    __mmask16 take = _mm512_mask_test_epi32_mask(
+      lanes, _mm512_maskz_srlv_epi32( lanes, broadcast, shifts ), one );
+    sum = _mm512_mask_xor_epi32( sum, take, sum,
+                                 _mm512_maskz_loadu_epi32( lanes, rows + r ) );
+  }
+  //fold the sixteen lanes
+  uint lane_sum[ 16 ];
+  _mm512_storeu_si512( lane_sum, sum );
+  uint result = 0;
+  for( uint lane = 0; lane < 16; lane++ )
+  {
+    result ^= lane_sum[ lane ];
+  }
+  return result;
+}
+
+/**
+ * find the least distance to a run of words, sixteen words at a time
+ * with the vector popcount
+ */
+__attribute__(( target( "avx512f,avx512vpopcntdq" ) ))
+uint tile_min_avx512( const uint* words, uint count, uint received )
+{
+  __m512i broadcast = _mm512_set1_epi32( static_cast< int >( received ) );
+  __m512i least = _mm512_set1_epi32( -1 );
+  for( uint i = 0; i < count; i += 16 )
+  {
+    //the lanes past the end are masked out of the load and the min
+    __mmask16 lanes = tail_lanes( count - i );
+    __m512i x = _mm512_xor_si512(
+      broadcast, _mm512_maskz_loadu_epi32( lanes, words + i ) );
+    least = _mm512_mask_min_epu32( least, lanes, least,
+                                   _mm512_popcnt_epi32( x ) );
+  }
+
+  //fold the sixteen lanes
+  uint lane_least[ 16 ];
+  _mm512_storeu_si512( lane_least, least );
+  uint result = UINT_MAX;
+  for( uint lane = 0; lane < 16; lane++ )
+  {
+    result = lane_least[ lane ] < result ? lane_least[ lane ] : result;
+  }
+  return result;
+}
+
+/**
+ * find the least distance of a batch of received words to a run of
+ * words, loading sixteen words at a time and running every received
+ * word against them
+ */
+__attribute__(( target( "avx512f,avx512vpopcntdq" ) ))
+void tile_min_batch_avx512( const uint* words, uint count,
+                            const uint* received, uint num_received,
+                            uint* least )
+{
+  __m512i lane_least[ TILE_MAX_RECEIVED ];
+  for( uint r = 0; r < num_received; r++ )
+  {
+    lane_least[ r ] = _mm512_set1_epi32( -1 );
+  }
+  for( uint i = 0; i < count; i += 16 )
+  {
+    __mmask16 lanes = tail_lanes( count - i );
+    __m512i block = _mm512_maskz_loadu_epi32( lanes, words + i );
+    for( uint r = 0; r < num_received; r++ )
+    {
+      __m512i x = _mm512_xor_si512( block, _mm512_set1_epi32(
+        static_cast< int >( received[ r ] ) ) );
+      lane_least[ r ] = _mm512_mask_min_epu32( lane_least[ r ], lanes,
+                                               lane_least[ r ],
+                                               _mm512_popcnt_epi32( x ) );
+    }
+  }
+  //fold the sixteen lanes of each
+  for( uint r = 0; r < num_received; r++ )
+  {
+    uint folded[ 16 ];
+    _mm512_storeu_si512( folded, lane_least[ r ] );
+    least[ r ] = UINT_MAX;
+    for( uint lane = 0; lane < 16; lane++ )
+    {
+      least[ r ] = folded[ lane ] < least[ r ] ? folded[ lane ] : least[ r ];
+    }
+  }
+}
+
+/**
+ * transpose sixteen rows at a time, one mask test per column
+ */
+__attribute__(( target( "avx512f" ) ))
+void transpose_avx512( const uint* rows, uint num_rows, uint num_columns,
+                       uint* columns )
+{
+  for( uint c = 0; c < num_columns; c++ )
+  {
+    columns[ c ] = 0;
+  }
+  for( uint r = 0; r < num_rows; r += 16 )
+  {
+    __mmask16 lanes = tail_lanes( num_rows - r );
+    __m512i block = _mm512_maskz_loadu_epi32( lanes, rows + r );
+    for( uint c = 0; c < num_columns; c++ )
+    {
+      uint bits = _mm512_test_epi32_mask( block, _mm512_set1_epi32(
+        static_cast< int >( 1u << c ) ) );
+      columns[ c ] |= bits << r;
+    }
+  }
+}
+
+/**
+ * clear a column, sixteen rows at a time with a masked xor
+ */
+__attribute__(( target( "avx512f" ) ))
+void eliminate_avx512( uint* rows, uint num_rows, uint pivot_row,
+                       uint pivot_mask )
+{
+  uint pivot = rows[ pivot_row ];
+  __m512i pivot_lanes = _mm512_set1_epi32( static_cast< int >( pivot ) );
+  __m512i mask_lanes = _mm512_set1_epi32( static_cast< int >( pivot_mask ) );
+  for( uint r = 0; r < num_rows; r += 16 )
+  {
+    __mmask16 lanes = tail_lanes( num_rows - r );
+    __m512i x = _mm512_maskz_loadu_epi32( lanes, rows + r );
+    __mmask16 has_bit = _mm512_mask_test_epi32_mask( lanes, x, mask_lanes );
+    _mm512_mask_storeu_epi32( rows + r, lanes, _mm512_mask_xor_epi32(
+      x, has_bit, x, pivot_lanes ) );
+  }
+  rows[ pivot_row ] = pivot;
+}
+
+/**
+ * determine the widest level the processor supports. the environment
+ * variable LINEAR_CODE_ISA = scalar, sse42, avx2 or avx512 lowers it,
+ * to pin a level across a mixed fleet or to test the narrower kernels.
+ * @return the level
+ */
+CpuLevel detect_cpu_level()
+{
+  __builtin_cpu_init();
+  CpuLevel level = CPU_SCALAR;
+  if( __builtin_cpu_supports( "sse4.2" ) and
+      __builtin_cpu_supports( "popcnt" ) )
+  {
+    level = CPU_SSE42;
+    if( __builtin_cpu_supports( "avx2" ) )
+    {
+      level = CPU_AVX2;
+      if( __builtin_cpu_supports( "avx512f" ) and
+          __builtin_cpu_supports( "avx512vpopcntdq" ) )
+      {
+        level = CPU_AVX512;
+      }
+    }
+  }
+
+  const char* requested = getenv( "LINEAR_CODE_ISA" );
+  if( requested != nullptr )
+  {
+    const char* names[ NUM_CPU_LEVELS ] =
+      { "scalar", "sse42", "avx2", "avx512" };
+    for( uint i = 0; i < NUM_CPU_LEVELS; i++ )
+    {
+      if( strcmp( requested, names[ i ] ) == 0 and
+          static_cast< CpuLevel >( i ) < level )
+      {
+        level = static_cast< CpuLevel >( i );
+      }
+    }
+  }
+  return level;
+}
+
+/**
+ * build the kernel table of a level. each level takes the kernels of
+ * the level below where it has none of its own.
+ * @param level the level, which the processor must support
+ * @return the table
+ */
+BitKernels bit_kernels_for( CpuLevel level )
+{
+  BitKernels kernels;
+  kernels.level = CPU_SCALAR;
+  kernels.name = "scalar";
+  kernels.weight = weight_scalar;
+  kernels.syndrome = syndrome_scalar;
+  kernels.encode = encode_scalar;
+  kernels.tile_min = tile_min_scalar;
+  kernels.tile_min_batch = tile_min_batch_scalar;
+  kernels.transpose = transpose_scalar;
+  kernels.eliminate = eliminate_scalar;
+  kernels.gather_bits = gather_bits_scalar;
+  if( level >= CPU_SSE42 )
+  {
+    kernels.level = CPU_SSE42;
+    kernels.name = "sse42";
+    kernels.weight = weight_sse42;
+    kernels.syndrome = syndrome_sse42;
+    kernels.tile_min = tile_min_sse42;
+    kernels.tile_min_batch = tile_min_batch_sse42;
+  }
+  if( level >= CPU_AVX2 )
+  {
+    kernels.level = CPU_AVX2;
+    kernels.name = "avx2";
+    kernels.syndrome = syndrome_avx2;
+    kernels.encode = encode_avx2;
+    kernels.tile_min = tile_min_avx2;
+    kernels.tile_min_batch = tile_min_batch_avx2;
+    kernels.transpose = transpose_avx2;
+    kernels.eliminate = eliminate_avx2;
+    if( __builtin_cpu_supports( "bmi2" ) )
+    {
+      kernels.gather_bits = gather_bits_bmi2;
+    }
+  }
+  if( level >= CPU_AVX512 )
+  {
+    kernels.level = CPU_AVX512;
+    kernels.name = "avx512";
+    kernels.syndrome = syndrome_avx512;
+    kernels.encode = encode_avx512;
+    kernels.tile_min = tile_min_avx512;
+    kernels.tile_min_batch = tile_min_batch_avx512;
+    kernels.transpose = transpose_avx512;
+    kernels.eliminate = eliminate_avx512;
+  }
+  return kernels;
+}
+
+/**
+ * Return the kernels for this processor, chosen on first use
+ */
+const BitKernels& bit_kernels()
+{
+  static const BitKernels kernels = bit_kernels_for( detect_cpu_level() );
+  return kernels;
+}
+
+#endif
@@ -0,0 +1,411 @@
+#ifndef BOUNDED_DISTANCE_DECODER_H
+#define BOUNDED_DISTANCE_DECODER_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <random>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "linear_code.h"
+
+using namespace std;
+
+/**
+ * A bounded distance decoder: only the error patterns of weight at
+ * most t are tabulated, so the table grows as ( n choose t ) rather
+ * than 2^( n - k ), and a syndrome that is not in the table is
+ * reported as a failure instead of being decoded to a distant word.
+ * The table is open addressing with linear probing; each slot is one
+ * 64 bit word holding the syndrome in the high half and the error
+ * pattern in the low half, so a probe touches one cache line. A
+ * syndrome of two patterns of the same least weight is ambiguous and
+ * kept with an empty pattern, which also decodes as a failure.
+ * @author agent
+ * @version 18 October 2026
+ */
+class BoundedDistanceDecoder
+{
+public:
+  /**
+   * Constructor building the table of a code
+   * @param code the code
+   * @param max_errors t, the heaviest error pattern tabulated
+   * @param num_threads the threads that build the table
+   */
+  BoundedDistanceDecoder( const LinearCode &code, uint max_errors,
+                          uint num_threads = 1 );
+
+  /**
+   * decode a received word
+   * @param received the received word
+   * @param decoded the codeword within t of it
+   * @return the number of errors corrected, or -1 if there is no
+   * unique codeword within t, in which case decoded is the received
+   * word
+   */
+  int decode_word( uint received, uint &decoded ) const;
+
+  /**
+   * decode a batch of received words. may be called from several
+   * threads at once.
+   * @param received the received words
+   * @param decoded the decoded words
+   * @param corrected the errors corrected in each word, or -1 where
+   * decoding failed
+   */
+  void decode_batch( Span< const uint > received, Span< uint > decoded,
+                     Span< int > corrected ) const;
+
+  /**
+   * Return the number of syndromes in the table
+   */
+  uint64_t get_num_entries() const;
+
+  /**
+   * Return the memory used by the table in bytes
+   */
+  uint64_t get_table_bytes() const;
+
+  /**
+   * Return the time taken to build the table in nanoseconds
+   */
+  uint64_t get_build_nanoseconds() const;
+
+  /**
+   * measure the mean time of one syndrome and probe
+   * @param samples the number of random words looked up
+   * @return the mean nanoseconds per lookup
+   */
+  double measure_lookup_nanoseconds( uint samples = 1 << 16 ) const;
+
+  /**
+   * print the size of the table and the lookup latency
+   * @param out the stream to print to
+   */
+  void print_report( ostream &out ) const;
+
+private:
+
+  /**
+   * insert the patterns of one weight whose lowest coordinate is one
+   * of a thread's share
+   * @param weight the weight of the patterns
+   * @param thread_index the thread
+   */
+  void insert_patterns( uint weight, uint thread_index );
+
+  /**
+   * insert every extension of a partial pattern
+   * @param remaining the coordinates still to add
+   * @param next the lowest coordinate that may be added
+   * @param partial_syndrome the syndrome of the partial pattern
+   * @param partial_pattern the partial pattern
+   * @param weight the weight of the finished patterns
+   */
+  void insert_extensions( uint remaining, uint next,
+                          uint partial_syndrome, uint partial_pattern,
+                          uint weight );
+
+  /**
+   * insert one pattern, keeping the lighter of two with one syndrome
+   * @param syndrome the syndrome of the pattern
+   * @param pattern the error pattern
+   * @param weight its weight
+   */
+  void insert( uint syndrome, uint pattern, uint weight );
+
+  /**
+   * find the slot of a syndrome
+   * @param syndrome the syndrome
+   * @return the first slot to probe
+   */
+  uint64_t home_slot( uint syndrome ) const;
+
+  /**
+   * probe the table for a nonzero syndrome
+   * @param syndrome the syndrome
+   * @return its error pattern, or 0 if it is absent or ambiguous
+   */
+  uint lookup( uint syndrome ) const;
+
+  const LinearCode &code;
+  uint code_length;
+  uint max_errors;
+  uint num_threads;
+  vector< uint > columns;
+  uint64_t num_slots;
+  unique_ptr< atomic< uint64_t >[] > slots;
+  atomic< uint64_t > num_entries;
+  uint64_t build_nanoseconds;
+};
+
+BoundedDistanceDecoder::BoundedDistanceDecoder( const LinearCode &param_code,
+                                                uint param_max_errors,
+                                                uint param_num_threads )
+: code( param_code ), code_length( param_code.get_code_length() ),
+  max_errors( param_max_errors ),
+  num_threads( max( param_num_threads, 1u ) ), num_entries( 0 )
+{
+  TraceScope trace( "bounded distance table build" );
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  for( uint place = 0; place < code_length; place++ )
+  {
+    columns.push_back( code.syndrome( 1u << place ) );
+  }
+
+  //size the table for a load factor of at most one half
+  uint64_t num_patterns = 0;
+  uint64_t choose = 1;
+  for( uint weight = 1; weight <= max_errors; weight++ )
+  {
+    choose = choose * ( code_length - weight + 1 ) / weight;
+    num_patterns += choose;
+  }
+  num_slots = 16;
+  while( num_slots < 2 * num_patterns )
+  {
+    num_slots <<= 1;
+  }
+  slots.reset( new atomic< uint64_t >[ num_slots ] );
+  for( uint64_t slot = 0; slot < num_slots; slot++ )
+  {
+    slots[ slot ].store( 0, memory_order_relaxed );
+  }
+
+  //insert one weight at a time so a lighter pattern is always in
+  //the table before a heavier one with the same syndrome
+  for( uint weight = 1; weight <= max_errors; weight++ )
+  {
+    vector< thread > workers;
+    for( uint t = 1; t < num_threads; t++ )
+    {
+      workers.push_back( thread( &BoundedDistanceDecoder::insert_patterns,
+                                 this, weight, t ) );
+    }
+    insert_patterns( weight, 0 );
+    for( thread &worker : workers )
+    {
+      worker.join();
+    }
+  }
+
+  build_nanoseconds = chrono::duration_cast< chrono::nanoseconds >(
+    chrono::steady_clock::now() - start ).count();
+}
+
+uint64_t BoundedDistanceDecoder::home_slot( uint syndrome ) const
+{
+  //fibonacci hashing spreads neighboring syndromes apart
+  return ( uint64_t( syndrome ) * 0x9E3779B97F4A7C15ull ) >>
+    ( 64 - __builtin_ctzll( num_slots ) );
+}
+
+void BoundedDistanceDecoder::insert( uint syndrome, uint pattern,
+                                     uint weight )
+{
+  //a pattern with syndrome 0 is a codeword, so t is past the
+  //minimum distance; the decoder never looks it up
+  if( syndrome == 0 )
+  {
+    return;
+  }
+
+  uint64_t entry = ( uint64_t( syndrome ) << 32 ) | pattern;
+  for( uint64_t slot = home_slot( syndrome ); ;
+       slot = ( slot + 1 ) & ( num_slots - 1 ) )
+  {
+    uint64_t current = slots[ slot ].load( memory_order_relaxed );
+    while( true )
+    {
+      if( current == 0 )
+      {
+        if( slots[ slot ].compare_exchange_weak( current, entry ) )
+        {
+          num_entries.fetch_add( 1, memory_order_relaxed );
+          return;
+        }
+        continue;
+      }
+      if( ( current >> 32 ) != syndrome )
+      {
+        break;
+      }
+
+      //the same syndrome. a lighter pattern stays; one of the same
+      //weight makes the syndrome ambiguous
+      uint existing = static_cast< uint >( current );
+      if( existing == 0 or
+          static_cast< uint >( __builtin_popcount( existing ) ) < weight )
+      {
+        return;
+      }
+      uint64_t ambiguous = uint64_t( syndrome ) << 32;
+      if( slots[ slot ].compare_exchange_weak( current, ambiguous ) )
+      {
+        return;
+      }
+    }
+  }
+}
+
+void BoundedDistanceDecoder::insert_extensions( uint remaining, uint next,
+                                                uint partial_syndrome,
+                                                uint partial_pattern,
+                                                uint weight )
+{
+  if( remaining == 0 )
+  {
+    insert( partial_syndrome, partial_pattern, weight );
+    return;
+  }
+  for( uint place = next; place + remaining <= code_length; place++ )
+  {
+    insert_extensions( remaining - 1, place + 1,
+                       partial_syndrome ^ columns[ place ],
+                       partial_pattern | ( 1u << place ), weight );
+  }
+}
+
+void BoundedDistanceDecoder::insert_patterns( uint weight,
+                                              uint thread_index )
+{
+  for( uint first = thread_index; first + weight <= code_length;
+       first += num_threads )
+  {
+    insert_extensions( weight - 1, first + 1, columns[ first ],
+                       1u << first, weight );
+  }
+}
+
+uint BoundedDistanceDecoder::lookup( uint syndrome ) const
+{
+  for( uint64_t slot = home_slot( syndrome ); ;
+       slot = ( slot + 1 ) & ( num_slots - 1 ) )
+  {
+    uint64_t entry = slots[ slot ].load( memory_order_relaxed );
+    if( entry == 0 )
+    {
+      return 0;
+    }
+    if( ( entry >> 32 ) == syndrome )
+    {
+      return static_cast< uint >( entry );
+    }
+  }
+}
+
+int BoundedDistanceDecoder::decode_word( uint received,
+                                         uint &decoded ) const
+{
+  uint syndrome = code.syndrome( received );
+  int corrected = -1;
+  decoded = received;
+  if( syndrome == 0 )
+  {
+    corrected = 0;
+  }
+  else
+  {
+    uint pattern = lookup( syndrome );
+    if( pattern != 0 )
+    {
+      decoded = received ^ pattern;
+      corrected = __builtin_popcount( pattern );
+    }
+  }
+
+  if( CodecStats::is_enabled() )
+  {
+    CodecStats::count( WORDS_DECODED );
+    if( corrected < 0 )
+    {
+      CodecStats::count( DECODE_FAILURES );
+    }
+    else
+    {
+      CodecStats::count( ERRORS_CORRECTED, corrected );
+      if( corrected > 0 )
+      {
+        CodecStats::count( SYNDROME_TABLE_HITS );
+      }
+    }
+  }
+  return corrected;
+}
+
+void BoundedDistanceDecoder::decode_batch( Span< const uint > received,
+                                           Span< uint > decoded,
+                                           Span< int > corrected ) const
+{
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    corrected[ i ] = decode_word( received[ i ], decoded[ i ] );
+  }
+}
+
+uint64_t BoundedDistanceDecoder::get_num_entries() const
+{
+  return num_entries.load();
+}
+
+uint64_t BoundedDistanceDecoder::get_table_bytes() const
+{
+  return num_slots * sizeof( uint64_t );
+}
+
+uint64_t BoundedDistanceDecoder::get_build_nanoseconds() const
+{
+  return build_nanoseconds;
+}
+
+double BoundedDistanceDecoder::measure_lookup_nanoseconds( uint samples ) const
+{
+  //look up codewords with up to t random errors, the traffic the
+  //table serves
+  mt19937 generator( 1 );
+  vector< uint > words;
+  const vector< uint > &code_words = code.get_code_words();
+  for( uint i = 0; i < samples; i++ )
+  {
+    uint word = code_words.at( generator() % code_words.size() );
+    for( uint e = 0; e < max_errors; e++ )
+    {
+      word ^= 1u << ( generator() % code_length );
+    }
+    words.push_back( word );
+  }
+
+  //time the syndrome and probe without the stats, so the samples
+  //are not counted as traffic
+  uint checksum = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for( uint word : words )
+  {
+    uint syndrome = code.syndrome( word );
+    checksum ^= syndrome == 0 ? 0 : lookup( syndrome );
+  }
+  uint64_t elapsed = chrono::duration_cast< chrono::nanoseconds >(
+    chrono::steady_clock::now() - start ).count();
+
+  //a volatile store keeps the loop from being optimized away
+  volatile uint sink = checksum;
+  (void)sink;
+  return static_cast< double >( elapsed ) / samples;
+}
+
+void BoundedDistanceDecoder::print_report( ostream &out ) const
+{
+  out << "bounded distance table: t = " << max_errors << ", "
+      << get_num_entries() << " syndromes in " << num_slots
+      << " slots, " << get_table_bytes() << " bytes, built in "
+      << build_nanoseconds / 1000.0 << " us" << endl;
+  out << "mean lookup: " << measure_lookup_nanoseconds() << " ns" << endl;
+}
+
+#endif
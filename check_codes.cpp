@@ -0,0 +1,854 @@
+/* A program checking the code families and decoders the main program
+ * does not build. Each check encodes random messages, adds errors the
+ * code must correct, and compares the decoding with what was sent.
+ * It prints a line per check and exits with 1 if any check fails.
+ * Build it with
+ *   g++ -O3 -march=native check_codes.cpp -o check_codes -lpthread
+ * @author agent
+ * @date October 18, 2026
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "cyclic_code.h"
+#include "bch_code.h"
+#include "reed_muller_code.h"
+#include "ldpc_code.h"
+#include "grand_decoder.h"
+#include "qary_code.h"
+#include "erasure_decoder.h"
+#include "bounded_distance_decoder.h"
+#include "trellis_decoder.h"
+
+using namespace std;
+
+/**
+ * print the outcome of a check
+ * @param name the name of the check
+ * @param failures the number of cases that failed
+ * @return whether or not the check passed
+ */
+bool report( const char* name, uint failures );
+
+/**
+ * return a random word of a given length and weight
+ * @param generator the source of randomness
+ * @param length the length of the word
+ * @param weight the weight of the word
+ * @return the word
+ */
+uint64_t random_error( mt19937_64 &generator, uint length, uint weight );
+
+/**
+ * return a random long word of a given length
+ * @param generator the source of randomness
+ * @param length the length of the word
+ * @return the word
+ */
+LongWord random_long_word( mt19937_64 &generator, uint length );
+
+/**
+ * flip a given number of distinct random places of a long word
+ * @param generator the source of randomness
+ * @param word the word
+ * @param length the length of the word
+ * @param weight the number of places to flip
+ */
+void add_long_error( mt19937_64 &generator, LongWord &word, uint length,
+                     uint weight );
+
+/**
+ * check that BCH codes correct every error of weight at most t, one
+ * word at a time and in batches, and that to_linear_code only takes
+ * codes that fit a uint
+ * @return whether or not the check passed
+ */
+bool check_bch_codes();
+
+/**
+ * check that first-order Reed-Muller codes decode every error of
+ * weight below a quarter of the length, one word at a time and in
+ * batches
+ * @return whether or not the check passed
+ */
+bool check_reed_muller_codes();
+
+/**
+ * check that the LDPC decoder leaves every frame it reports converged
+ * a codeword, decoded as it would be alone whatever frames share its
+ * batch
+ * @return whether or not the check passed
+ */
+bool check_ldpc_decoder();
+
+/**
+ * check that GRAND corrects every error of weight at most t, stops at
+ * its query cap, and decodes the same on one thread as on several
+ * @return whether or not the check passed
+ */
+bool check_grand_decoder();
+
+/**
+ * check the region arithmetic against the field, that a field it
+ * cannot pack is refused, and that Reed-Solomon codes and their copies
+ * correct every error of weight at most t
+ * @return whether or not the check passed
+ */
+bool check_qary_codes();
+
+/**
+ * check that the erasure decoder corrects v errors and e erasures
+ * whenever 2 v + e < d, alone and in a batch
+ * @return whether or not the check passed
+ */
+bool check_erasure_decoder();
+
+/**
+ * check that the bounded distance table decodes as LinearCode does
+ * within t, and gives up on words further than t from the code
+ * @return whether or not the check passed
+ */
+bool check_bounded_distance_decoder();
+
+/**
+ * check that the trellis decodes every word of a small code as near as
+ * LinearCode does, that soft decoding follows the reliable bits, and
+ * that a trellis too large to build is refused
+ * @return whether or not the check passed
+ */
+bool check_trellis_decoder();
+
+/**
+ * check that reencode_delta gives the encoding of the changed message,
+ * and that the batch applies every update in range and counts the rest
+ * @return whether or not the check passed
+ */
+bool check_reencode_delta();
+
+/**
+ * check that each derived code has the length, dimension and minimum
+ * distance the construction promises, and the same code words as a
+ * code built afresh from its matrices
+ * @return whether or not the check passed
+ */
+bool check_derived_codes();
+
+/**
+ * check that decode_message reads the same message as decode_word and
+ * extract_message, both on an information set where the generator
+ * matrix is systematic and on one where it is not
+ * @return whether or not the check passed
+ */
+bool check_information_sets();
+
+/**
+ * check that cyclic codes correct every error of weight at most t,
+ * by error trapping or by the Meggitt table, and agree with the
+ * LinearCode of the same matrices
+ * @return whether or not the check passed
+ */
+bool check_cyclic_codes();
+
+int main()
+{
+  bool passed = true;
+  passed = check_cyclic_codes() and passed;
+  passed = check_bch_codes() and passed;
+  passed = check_reed_muller_codes() and passed;
+  passed = check_ldpc_decoder() and passed;
+  passed = check_grand_decoder() and passed;
+  passed = check_qary_codes() and passed;
+  passed = check_erasure_decoder() and passed;
+  passed = check_bounded_distance_decoder() and passed;
+  passed = check_trellis_decoder() and passed;
+  passed = check_reencode_delta() and passed;
+  passed = check_derived_codes() and passed;
+  passed = check_information_sets() and passed;
+  return passed ? 0 : 1;
+}
+
+bool report( const char* name, uint failures )
+{
+  cout << ( failures == 0 ? "pass " : "FAIL " ) << name;
+  if( failures != 0 )
+  {
+    cout << ": " << failures << " cases";
+  }
+  cout << endl;
+  return failures == 0;
+}
+
+uint64_t random_error( mt19937_64 &generator, uint length, uint weight )
+{
+  uint64_t error = 0;
+  while( static_cast< uint >( __builtin_popcountll( error ) ) < weight )
+  {
+    error |= 1ull << ( generator() % length );
+  }
+  return error;
+}
+
+bool check_cyclic_codes()
+{
+  //the [7, 4] and [31, 26] hamming codes, the [23, 12, 7] golay code
+  //and the [63, 51, 5] BCH code
+  const uint lengths[] = { 7, 31, 23, 63 };
+  const uint64_t polynomials[] = { 0xB, 0x25, 0xC75, 0x1539 };
+  const uint capabilities[] = { 1, 1, 3, 2 };
+  mt19937_64 generator( 1 );
+  uint failures = 0;
+  for( uint c = 0; c < 4; c++ )
+  {
+    CyclicCode code( lengths[ c ], polynomials[ c ], capabilities[ c ] );
+    uint64_t message_mask = ( 1ull << code.get_dimension() ) - 1;
+    for( uint trial = 0; trial < 2000; trial++ )
+    {
+      uint64_t message = generator() & message_mask;
+      uint64_t code_word = code.encode_word( message );
+      uint weight = trial % ( code.get_correction_capability() + 1 );
+      uint64_t received = code_word ^
+        random_error( generator, lengths[ c ], weight );
+      int corrected = code.decode_word( received );
+      if( corrected != static_cast< int >( weight ) or
+          received != code_word or
+          code.extract_message( received ) != message )
+      {
+        failures++;
+      }
+    }
+  }
+
+  //the golay code as a LinearCode decodes the same words
+  CyclicCode golay( 23, 0xC75 );
+  LinearCode linear = golay.to_linear_code();
+  for( uint trial = 0; trial < 200; trial++ )
+  {
+    uint64_t received = golay.encode_word( generator() & 0xFFF ) ^
+      random_error( generator, 23, trial % 4 );
+    uint decoded = linear.decode_word( static_cast< uint >( received ) );
+    if( golay.decode_word( received ) < 0 or decoded != received )
+    {
+      failures++;
+    }
+  }
+  return report( "cyclic codes", failures );
+}
+
+LongWord random_long_word( mt19937_64 &generator, uint length )
+{
+  LongWord word = new_long_word( length );
+  for( uint place = 0; place < length; place++ )
+  {
+    if( generator() & 1 )
+    {
+      set_bit( word, place );
+    }
+  }
+  return word;
+}
+
+void add_long_error( mt19937_64 &generator, LongWord &word, uint length,
+                     uint weight )
+{
+  vector< uint > places;
+  while( places.size() < weight )
+  {
+    uint place = generator() % length;
+    if( find( places.begin(), places.end(), place ) == places.end() )
+    {
+      places.push_back( place );
+      flip_bit( word, place );
+    }
+  }
+}
+
+bool check_bch_codes()
+{
+  //BCH( 31, 21, 5 ), BCH( 63, 45, 7 ) and BCH( 255, 223, 9 )
+  const uint degrees[] = { 5, 6, 8 };
+  const uint distances[] = { 5, 7, 9 };
+  mt19937_64 generator( 2 );
+  uint failures = 0;
+  for( uint c = 0; c < 3; c++ )
+  {
+    BCHCode code( degrees[ c ], distances[ c ] );
+    uint length = code.get_code_length();
+    uint correctable = code.get_correction_capability();
+    vector< LongWord > sent;
+    vector< LongWord > received;
+    for( uint trial = 0; trial < 1000; trial++ )
+    {
+      LongWord code_word = code.encode_word(
+        random_long_word( generator, code.get_dimension() ) );
+      LongWord word = code_word;
+      add_long_error( generator, word, length, trial % ( correctable + 1 ) );
+      sent.push_back( code_word );
+      received.push_back( word );
+      if( code.decode_word( word ) !=
+          static_cast< int >( trial % ( correctable + 1 ) ) or
+          word != code_word )
+      {
+        failures++;
+      }
+    }
+    vector< int > corrected( received.size() );
+    code.decode_batch( Span< LongWord >( received ),
+                       Span< int >( corrected ) );
+    if( received != sent )
+    {
+      failures++;
+    }
+  }
+
+  BCHCode short_code( 5, 5 );
+  BCHCode long_code( 6, 5 );
+  if( short_code.to_linear_code().get_minimum_distance() != 5 or
+      long_code.to_linear_code().get_code_length() != 0 )
+  {
+    failures++;
+  }
+  return report( "BCH codes", failures );
+}
+
+bool check_reed_muller_codes()
+{
+  mt19937_64 generator( 3 );
+  uint failures = 0;
+  for( uint degree : { 3u, 5u, 10u } )
+  {
+    ReedMullerCode code( degree );
+    uint length = code.get_code_length();
+    uint correctable = ( code.get_minimum_distance() - 1 ) / 2;
+    uint message_mask = ( 1u << code.get_dimension() ) - 1;
+    vector< uint > messages;
+    vector< LongWord > received;
+    for( uint trial = 0; trial < 500; trial++ )
+    {
+      uint message = static_cast< uint >( generator() ) & message_mask;
+      LongWord word = code.encode_word( message );
+      add_long_error( generator, word, length, trial % ( correctable + 1 ) );
+      messages.push_back( message );
+      received.push_back( word );
+      if( code.decode_word( word ) != message )
+      {
+        failures++;
+      }
+    }
+    vector< uint > decoded( received.size() );
+    code.decode_batch( Span< const LongWord >( received ),
+                       Span< uint >( decoded ) );
+    if( decoded != messages )
+    {
+      failures++;
+    }
+  }
+
+  ReedMullerCode small_code( 5 );
+  if( small_code.to_linear_code().get_minimum_distance() != 16 )
+  {
+    failures++;
+  }
+  return report( "Reed-Muller codes", failures );
+}
+
+bool check_ldpc_decoder()
+{
+  //flips of 7% of the zero codeword of a gallager ( 240, 3, 6 ) code,
+  //where some frames converge and some do not
+  SparseParityCheck parity_check = SparseParityCheck::gallager( 240, 3, 6,
+                                                                1 );
+  LdpcDecoder decoder( parity_check, 30 );
+  mt19937_64 generator( 4 );
+  uint num_frames = 1600;
+  vector< LongWord > received( num_frames, new_long_word( 240 ) );
+  for( LongWord &word : received )
+  {
+    for( uint place = 0; place < 240; place++ )
+    {
+      if( generator() % 100 < 7 )
+      {
+        flip_bit( word, place );
+      }
+    }
+  }
+  vector< LongWord > decoded( num_frames );
+  vector< int > iterations( num_frames );
+  decoder.decode_hard_batch( Span< const LongWord >( received ),
+                             Span< LongWord >( decoded ),
+                             Span< int >( iterations ) );
+
+  uint failures = 0;
+  uint converged = 0;
+  for( uint frame = 0; frame < num_frames; frame++ )
+  {
+    if( iterations[ frame ] < 0 )
+    {
+      continue;
+    }
+    converged++;
+    LongWord alone;
+    int alone_iterations;
+    decoder.decode_hard_batch( Span< const LongWord >( &received[ frame ],
+                                                       1 ),
+                               Span< LongWord >( &alone, 1 ),
+                               Span< int >( &alone_iterations, 1 ) );
+    if( alone != decoded[ frame ] or
+        !parity_check.is_code_word( decoded[ frame ] ) )
+    {
+      failures++;
+    }
+  }
+  if( converged == 0 or converged == num_frames )
+  {
+    failures++;
+  }
+  return report( "LDPC decoder", failures );
+}
+
+bool check_grand_decoder()
+{
+  mt19937_64 generator( 5 );
+  uint failures = 0;
+
+  //the golay code corrects three errors
+  CyclicCode golay( 23, 0xC75 );
+  LinearCode golay_code = golay.to_linear_code();
+  GrandDecoder golay_decoder( golay_code, 3, 1u << 20 );
+  for( uint trial = 0; trial < 400; trial++ )
+  {
+    uint code_word = static_cast< uint >(
+      golay.encode_word( generator() & 0xFFF ) );
+    uint error = static_cast< uint >( random_error( generator, 23,
+                                                    trial % 4 ) );
+    uint decoded;
+    if( golay_decoder.decode_word( code_word ^ error, decoded ) !=
+        static_cast< int >( trial % 4 ) or decoded != code_word )
+    {
+      failures++;
+    }
+  }
+
+  //the [31, 26] hamming code with 20 queries: the zero pattern, then
+  //the single errors at places 0 to 18
+  CyclicCode hamming( 31, 0x25, 1 );
+  LinearCode hamming_code = hamming.to_linear_code();
+  GrandDecoder capped( hamming_code, 2, 20 );
+  uint decoded;
+  if( capped.decode_word( 1u << 18, decoded ) != 1 or
+      capped.decode_word( 1u << 19, decoded ) != -1 )
+  {
+    failures++;
+  }
+
+  //five errors in BCH( 31, 16 ) reach weights spread across threads
+  CyclicCode bch( 31, 0x8FAF, 3 );
+  LinearCode bch_code = bch.to_linear_code();
+  GrandDecoder serial( bch_code, 5, 200000, 1 );
+  GrandDecoder parallel( bch_code, 5, 200000, 4 );
+  for( uint trial = 0; trial < 8; trial++ )
+  {
+    uint received = static_cast< uint >(
+      bch.encode_word( generator() & 0xFFFF ) ^
+      random_error( generator, 31, 5 ) );
+    uint serial_decoded;
+    uint parallel_decoded;
+    if( serial.decode_word( received, serial_decoded ) !=
+        parallel.decode_word( received, parallel_decoded ) or
+        serial_decoded != parallel_decoded )
+    {
+      failures++;
+    }
+
+    float llrs[ 31 ];
+    for( uint place = 0; place < 31; place++ )
+    {
+      float magnitude = 0.5f + ( generator() % 100 ) / 20.0f;
+      llrs[ place ] = ( received >> place ) & 1 ? -magnitude : magnitude;
+    }
+    if( serial.decode_soft( llrs, serial_decoded ) !=
+        parallel.decode_soft( llrs, parallel_decoded ) or
+        serial_decoded != parallel_decoded )
+    {
+      failures++;
+    }
+  }
+  return report( "GRAND decoder", failures );
+}
+
+bool check_qary_codes()
+{
+  mt19937_64 generator( 6 );
+  uint failures = 0;
+  for( uint degree : { 4u, 8u } )
+  {
+    GaloisField field( degree );
+    GfRegion region( field );
+
+    //the kernels against symbol by symbol multiplication
+    const uint symbols = 200;
+    uint bytes = region.get_packed_bytes( symbols );
+    for( uint trial = 0; trial < 50; trial++ )
+    {
+      vector< uint8_t > source( bytes );
+      vector< uint8_t > target( bytes );
+      for( uint i = 0; i < bytes; i++ )
+      {
+        source[ i ] = static_cast< uint8_t >( generator() );
+        target[ i ] = static_cast< uint8_t >( generator() );
+      }
+      vector< uint8_t > expected = target;
+      uint coefficient = generator() % field.get_size();
+      for( uint place = 0; place < symbols; place++ )
+      {
+        region.set_symbol( expected.data(), place,
+          region.get_symbol( expected.data(), place ) ^
+          field.multiply( coefficient,
+                          region.get_symbol( source.data(), place ) ) );
+      }
+      region.multiply_add( target.data(), source.data(), coefficient,
+                           bytes );
+      if( target != expected )
+      {
+        failures++;
+      }
+    }
+
+    //a copy must decode after the original is gone
+    uint dimension = degree == 4 ? 9 : 223;
+    QaryLinearCode* original = new QaryLinearCode(
+      QaryLinearCode::reed_solomon( field, dimension ) );
+    QaryLinearCode code = *original;
+    delete original;
+
+    uint code_length = code.get_code_length();
+    uint correctable = code.get_correction_capability();
+    for( uint trial = 0; trial < 200; trial++ )
+    {
+      QaryWord message( code.get_message_bytes(), 0 );
+      for( uint place = 0; place < dimension; place++ )
+      {
+        region.set_symbol( message.data(), place,
+                           generator() % field.get_size() );
+      }
+      QaryWord code_word = code.encode_word( message );
+      QaryWord received = code_word;
+      uint errors = trial % ( correctable + 1 );
+      vector< uint > places( code_length );
+      for( uint place = 0; place < code_length; place++ )
+      {
+        places[ place ] = place;
+      }
+      shuffle( places.begin(), places.end(), generator );
+      for( uint i = 0; i < errors; i++ )
+      {
+        uint value = 1 + generator() % ( field.get_size() - 1 );
+        region.set_symbol( received.data(), places[ i ],
+          region.get_symbol( received.data(), places[ i ] ) ^ value );
+      }
+      if( code.decode_word( received ) != static_cast< int >( errors ) or
+          received != code_word )
+      {
+        failures++;
+      }
+    }
+  }
+
+  //a field whose symbols cannot be packed is refused, not resized
+  GaloisField odd_field( 3 );
+  GfRegion odd_region( odd_field );
+  vector< uint8_t > source = { 1, 2, 3, 4 };
+  vector< uint8_t > target = { 5, 6, 7, 8 };
+  odd_region.multiply_add( target.data(), source.data(), 3, 4 );
+  odd_region.multiply( target.data(), 3, 4 );
+  odd_region.set_symbol( target.data(), 1, 7 );
+  QaryLinearCode odd_code( odd_field, { QaryWord( 3, 0xFF ) }, 7 );
+  if( odd_region.is_valid() or target[ 0 ] != 5 or target[ 3 ] != 8 or
+      odd_region.get_symbol( target.data(), 0 ) != 0 or
+      odd_code.get_code_length() != 0 )
+  {
+    failures++;
+  }
+  return report( "q-ary codes", failures );
+}
+
+bool check_erasure_decoder()
+{
+  mt19937_64 generator( 7 );
+  uint failures = 0;
+  CyclicCode golay( 23, 0xC75 );
+  LinearCode code = golay.to_linear_code();
+  ErasureDecoder decoder( code );
+
+  const uint num_words = 600;
+  vector< uint > code_words( num_words );
+  vector< uint > received( num_words );
+  vector< uint > erasure_masks( num_words );
+  vector< int > errors( num_words );
+  for( uint i = 0; i < num_words; i++ )
+  {
+    //2 v + e is at most 6
+    uint erased = i % 7;
+    errors[ i ] = static_cast< int >( generator() %
+                                      ( ( 6 - erased ) / 2 + 1 ) );
+    uint pattern = static_cast< uint >( random_error( generator, 23,
+                                          erased + errors[ i ] ) );
+    uint erasure_mask = 0;
+    for( uint j = 0; j < erased; j++ )
+    {
+      erasure_mask |= pattern & ( 0u - pattern );
+      pattern &= pattern - 1;
+    }
+    code_words[ i ] = static_cast< uint >(
+      golay.encode_word( generator() & 0xFFF ) );
+    //erased bits are garbage, the rest carry the errors
+    received[ i ] = code_words[ i ] ^ pattern ^
+                    ( static_cast< uint >( generator() ) & erasure_mask );
+    erasure_masks[ i ] = erasure_mask;
+
+    uint decoded;
+    if( decoder.decode_word( received[ i ], erasure_mask, decoded ) !=
+        errors[ i ] or decoded != code_words[ i ] )
+    {
+      failures++;
+    }
+  }
+
+  vector< uint > decoded( num_words );
+  vector< int > corrected( num_words );
+  decoder.decode_batch( Span< const uint >( received ),
+                        Span< const uint >( erasure_masks ),
+                        Span< uint >( decoded ), Span< int >( corrected ) );
+  for( uint i = 0; i < num_words; i++ )
+  {
+    if( corrected[ i ] != errors[ i ] or decoded[ i ] != code_words[ i ] )
+    {
+      failures++;
+    }
+  }
+  return report( "erasure decoder", failures );
+}
+
+bool check_bounded_distance_decoder()
+{
+  mt19937_64 generator( 8 );
+  uint failures = 0;
+  CyclicCode bch( 31, 0x8FAF, 3 );
+  LinearCode code = bch.to_linear_code();
+  uint correctable = code.get_correction_capability();
+  BoundedDistanceDecoder decoder( code, correctable );
+  for( uint trial = 0; trial < 400; trial++ )
+  {
+    uint code_word = static_cast< uint >(
+      bch.encode_word( generator() & 0xFFFF ) );
+    uint errors = trial % ( correctable + 4 );
+    uint received = code_word ^
+      static_cast< uint >( random_error( generator, 31, errors ) );
+    uint nearest = code.decode_word( received );
+    uint distance = __builtin_popcount( nearest ^ received );
+    uint decoded;
+    int corrected = decoder.decode_word( received, decoded );
+    if( distance <= correctable ?
+        corrected != static_cast< int >( distance ) or decoded != nearest :
+        corrected != -1 or decoded != received )
+    {
+      failures++;
+    }
+  }
+  return report( "bounded distance decoder", failures );
+}
+
+bool check_trellis_decoder()
+{
+  mt19937_64 generator( 9 );
+  uint failures = 0;
+
+  //every word of BCH( 15, 7 ): ties may pick other codewords, so
+  //compare the distances
+  CyclicCode bch( 15, 0x1D1, 2 );
+  LinearCode code = bch.to_linear_code();
+  TrellisDecoder decoder( code );
+  for( uint received = 0; received < ( 1u << 15 ); received++ )
+  {
+    uint decoded = decoder.decode_word( received );
+    if( code.syndrome( decoded ) != 0 or
+        __builtin_popcount( decoded ^ received ) !=
+        __builtin_popcount( code.decode_word( received ) ^ received ) )
+    {
+      failures++;
+    }
+  }
+
+  //three weak wrong bits beyond t: any other codeword differs from the
+  //one sent in at least two reliable bits, so it is less likely
+  for( uint trial = 0; trial < 200; trial++ )
+  {
+    uint code_word = static_cast< uint >(
+      bch.encode_word( generator() & 0x7F ) );
+    uint weak = static_cast< uint >( random_error( generator, 15, 3 ) );
+    float llrs[ 15 ];
+    for( uint place = 0; place < 15; place++ )
+    {
+      bool sent_one = ( code_word >> place ) & 1;
+      bool flipped = ( weak >> place ) & 1;
+      float magnitude = flipped ? 0.1f : 1.0f;
+      llrs[ place ] = sent_one != flipped ? -magnitude : magnitude;
+    }
+    if( decoder.decode_soft( llrs ) != code_word )
+    {
+      failures++;
+    }
+  }
+
+  //RM( 1, 5 ) has 26 parity checks
+  ReedMullerCode reed_muller( 5 );
+  LinearCode wide_code = reed_muller.to_linear_code();
+  TrellisDecoder refused( wide_code );
+  if( refused.is_valid() or refused.decode_word( 12345 ) != 12345 )
+  {
+    failures++;
+  }
+  return report( "trellis decoder", failures );
+}
+
+bool check_reencode_delta()
+{
+  mt19937_64 generator( 10 );
+  uint failures = 0;
+  LinearCode code = CyclicCode( 23, 0xC75 ).to_linear_code();
+  uint dimension = code.get_dimension();
+  vector< uint > code_words;
+  vector< uint > expected;
+  vector< uint > offsets;
+  vector< uint > deltas;
+  for( uint trial = 0; trial < 200; trial++ )
+  {
+    uint message = generator() & ( ( 1u << dimension ) - 1 );
+    uint delta = static_cast< uint >(
+      random_error( generator, dimension, 1 + trial % 4 ) );
+    uint code_word = code.encode_word( message );
+    if( code.reencode_delta( code_word, delta ) !=
+        code.encode_word( message ^ delta ) )
+    {
+      failures++;
+    }
+    code_words.push_back( code_word );
+    expected.push_back( code.encode_word( message ^ delta ) );
+    offsets.push_back( trial );
+    deltas.push_back( delta );
+  }
+
+  //one offset past the codewords is skipped and counted
+  vector< uint > past_offsets = offsets;
+  vector< uint > past_deltas = deltas;
+  past_offsets.push_back( code_words.size() );
+  past_deltas.push_back( 1 );
+  if( code.reencode_delta_batch( code_words, past_offsets,
+                                 past_deltas ) != 1 or
+      code_words != expected )
+  {
+    failures++;
+  }
+
+  //deltas that do not match the offsets change nothing
+  if( code.reencode_delta_batch( code_words, offsets, past_deltas ) !=
+      offsets.size() or code_words != expected )
+  {
+    failures++;
+  }
+  return report( "reencode delta", failures );
+}
+
+bool check_derived_codes()
+{
+  uint failures = 0;
+  LinearCode golay = CyclicCode( 23, 0xC75 ).to_linear_code();
+  LinearCode simplex = CyclicCode( 7, 0x1D ).to_linear_code();
+
+  //the [23, 12, 7] Golay code extended, punctured, shortened, and
+  //extended then punctured back at the parity place; the [7, 3, 4]
+  //simplex code augmented by the all ones word is the Hamming code
+  vector< LinearCode > derived = { golay.extend(), golay.puncture( 0 ),
+                                   golay.shorten( 0 ),
+                                   golay.extend().puncture( 0 ),
+                                   simplex.augment( 0x7F ) };
+  const uint lengths[] = { 24, 22, 22, 23, 7 };
+  const uint dimensions[] = { 12, 12, 11, 12, 4 };
+  const uint distances[] = { 8, 6, 7, 7, 3 };
+  for( uint c = 0; c < derived.size(); c++ )
+  {
+    const LinearCode &code = derived[ c ];
+    LinearCode rebuilt( code.get_generator(), code.get_parity_check(),
+                        code.get_code_length() );
+    if( code.get_code_length() != lengths[ c ] or
+        code.get_dimension() != dimensions[ c ] or
+        code.get_minimum_distance() != distances[ c ] or
+        code.get_parity_check().size() != lengths[ c ] - dimensions[ c ] or
+        rebuilt.get_minimum_distance() != distances[ c ] or
+        rebuilt.get_code_words() != code.get_code_words() )
+    {
+      failures++;
+    }
+    for( uint row : code.get_generator() )
+    {
+      if( code.syndrome( row ) != 0 )
+      {
+        failures++;
+      }
+    }
+  }
+  return report( "derived codes", failures );
+}
+
+bool check_information_sets()
+{
+  mt19937_64 generator( 11 );
+  uint failures = 0;
+  CyclicCode golay( 23, 0xC75 );
+
+  //the code words carry the message in the leftmost places, where the
+  //generator matrix is the identity. the rightmost places are an
+  //information set too, where it is triangular instead
+  LinearCode systematic = golay.to_linear_code();
+  LinearCode triangular = systematic;
+  uint dimension = systematic.get_dimension();
+  vector< uint > permutation;
+  for( uint j = 0; j < dimension; j++ )
+  {
+    permutation.push_back( 22 - j );
+  }
+  if( !systematic.has_information_set() or
+      !triangular.set_information_set( permutation ) )
+  {
+    failures++;
+  }
+
+  const LinearCode* codes[] = { &systematic, &triangular };
+  for( const LinearCode* code : codes )
+  {
+    vector< uint > received;
+    vector< uint > messages;
+    for( uint trial = 0; trial < 400; trial++ )
+    {
+      uint message = generator() & ( ( 1u << dimension ) - 1 );
+      uint word = code->encode_word( message ) ^
+        static_cast< uint >( random_error( generator, 23, trial % 4 ) );
+      if( code->decode_message( word ) != message or
+          code->extract_message( code->decode_word( word ) ) != message )
+      {
+        failures++;
+      }
+      received.push_back( word );
+      messages.push_back( message );
+    }
+    vector< uint > decoded( received.size() );
+    code->decode_message_batch( received, decoded );
+    if( decoded != messages )
+    {
+      failures++;
+    }
+  }
+  return report( "information sets", failures );
+}
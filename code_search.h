@@ -0,0 +1,615 @@
+#ifndef CODE_SEARCH_H
+#define CODE_SEARCH_H
+
+#include <cstdint>
+#include <cstdio>
+#include <climits>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include "codec_stats.h"
+#include "trace.h"
+
+using namespace std;
+
+vector< uint > find_rref( vector< uint > code_matrix, uint code_size );
+
+/*
+ * the candidates a thread claims at a time
+ */
+const uint64_t SEARCH_BLOCK = 64;
+
+/*
+ * the least time between two checkpoints
+ */
+const double SEARCH_CHECKPOINT_SECONDS = 1.0;
+
+/*
+ * the random vectors the greedy construction tries for each row
+ */
+const uint GREEDY_TRIES = 4096;
+
+/*
+ * the largest dimension whose codewords the search enumerates
+ */
+const uint SEARCH_MAX_DIMENSION = 26;
+
+/*
+ * how candidate generator sets are made
+ */
+enum SearchMethod
+{
+  SEARCH_RANDOM,
+  SEARCH_GREEDY,
+  SEARCH_LEXICODE
+};
+
+/*
+ * what a search looks for and how it runs
+ */
+struct SearchOptions
+{
+  SearchMethod method;
+  uint64_t num_candidates;
+  uint num_threads;
+  uint num_kept;
+  uint seed;
+  string checkpoint_path;
+};
+
+/*
+ * a code found, ranked by its minimum distance and then by how few
+ * codewords have that weight
+ */
+struct FoundCode
+{
+  uint minimum_distance;
+  uint64_t num_minimum_words;
+  vector< uint > rows;
+};
+
+/**
+ * A search for a good [n, k] binary code. Candidates are spanning sets
+ * of k words: random words, a randomized greedy construction that only
+ * takes a row keeping every codeword at the distance aimed for, or the
+ * lexicode, the greedy construction over the words in order. Each
+ * candidate is put in rref by find_rref, and one of rank below k is
+ * dropped. Its codewords are walked in gray code order, one row added
+ * per step, and the walk stops as soon as the candidate cannot beat
+ * the worst code kept: a lighter codeword, or more codewords of the
+ * same weight. Threads claim blocks of SEARCH_BLOCK candidates, each
+ * made from its own seed, so random candidates are the same on any
+ * number of threads. Greedy candidates and lexicodes aim for the
+ * distance of the worst code kept, the odd greedy ones one further, so
+ * they depend on the order blocks finish in and differ from run to run
+ * when there are several threads. The checkpoint holds the candidates
+ * below which every block is done and the codes kept, rewritten at
+ * most every SEARCH_CHECKPOINT_SECONDS, and a search given the same
+ * checkpoint, n, k, method and seed resumes from it. Codes are written
+ * in the subset format main reads: the length, then one row per line.
+ * @author agent
+ * @version 18 October 2026
+ */
+class BestCodeSearch
+{
+public:
+  /**
+   * Constructor specifying the length and dimension
+   * @param code_length n, at most 32
+   * @param dimension k, at most SEARCH_MAX_DIMENSION
+   */
+  BestCodeSearch( uint code_length, uint dimension );
+
+  /**
+   * run a search
+   * @param options the method, budget, threads and checkpoint
+   * @return the codes kept, best first
+   */
+  vector< FoundCode > search( const SearchOptions &options );
+
+  /**
+   * Return the number of candidates made in the last search
+   */
+  uint64_t get_evaluated() const;
+
+  /**
+   * find the largest distance the Griesmer bound allows an [n, k]
+   * code
+   * @return the bound
+   */
+  uint griesmer_bound() const;
+
+  /**
+   * write a code in the subset format
+   * @param out the stream to write to
+   * @param code the code
+   */
+  void write_code( ostream &out, const FoundCode &code ) const;
+
+private:
+
+  /**
+   * make a candidate
+   * @param candidate the index of the candidate
+   * @param method how to make it
+   * @param rows the spanning set made
+   * @return whether or not one was made
+   */
+  bool make_candidate( uint64_t candidate, SearchMethod method,
+                       vector< uint > &rows ) const;
+
+  /**
+   * build a spanning set greedily, each row keeping every codeword at
+   * a distance
+   * @param distance the distance aimed for
+   * @param generator the source of random rows, or null to take the
+   * words in order, the lexicode
+   * @param rows the rows found
+   * @return whether or not k rows were found
+   */
+  bool build_greedy( uint distance, mt19937* generator,
+                     vector< uint > &rows ) const;
+
+  /**
+   * rank a candidate against the worst code kept
+   * @param rows the spanning set
+   * @param found the code, if it is kept
+   * @return whether or not it is good enough to keep
+   */
+  bool evaluate( const vector< uint > &rows, FoundCode &found ) const;
+
+  /**
+   * add a code to those kept, if it is good enough and new
+   * @param found the code
+   */
+  void keep( const FoundCode &found );
+
+  /**
+   * mark a block done and move the checkpoint past every block done
+   * @param block the block
+   */
+  void finish_block( uint64_t block );
+
+  /**
+   * work through blocks of candidates until the budget is spent
+   */
+  void search_blocks();
+
+  /**
+   * read a checkpoint written by a search with the same options
+   * @return the candidate to resume from
+   */
+  uint64_t read_checkpoint();
+
+  /**
+   * write the candidates done and the codes kept
+   */
+  void write_checkpoint() const;
+
+  uint code_length;
+  uint dimension;
+  uint word_mask;
+  SearchOptions options;
+  uint64_t start_candidate;
+  uint64_t num_blocks;
+  atomic< uint64_t > next_block;
+  atomic< uint64_t > evaluated;
+  atomic< uint64_t > worst_kept;
+  mutex kept_lock;
+  vector< FoundCode > kept;
+  vector< bool > block_done;
+  uint64_t blocks_below;
+  chrono::steady_clock::time_point last_checkpoint;
+};
+
+BestCodeSearch::BestCodeSearch( uint param_code_length,
+                                uint param_dimension )
+: code_length( param_code_length ), dimension( param_dimension ),
+  word_mask( 0 ), options(), start_candidate( 0 ), num_blocks( 0 ),
+  next_block( 0 ), evaluated( 0 ), worst_kept( 0 ), blocks_below( 0 )
+{
+  if( code_length == 0 or code_length > 32 )
+  {
+    cout << "searched codes must be 1 to 32 long." << endl;
+    code_length = min( max( code_length, 1u ), 32u );
+  }
+  if( dimension == 0 or dimension > code_length or
+      dimension > SEARCH_MAX_DIMENSION )
+  {
+    cout << "searched codes must have dimension 1 to min( n, "
+         << SEARCH_MAX_DIMENSION << " )." << endl;
+    dimension = min( max( dimension, 1u ),
+                     min( code_length, SEARCH_MAX_DIMENSION ) );
+  }
+  word_mask = code_length == 32 ? UINT_MAX : ( 1u << code_length ) - 1;
+}
+
+uint BestCodeSearch::griesmer_bound() const
+{
+  //the largest d with the sum of ceil( d / 2^i ), i < k, at most n
+  uint bound = 0;
+  for( uint distance = 1; distance <= code_length; distance++ )
+  {
+    uint length = 0;
+    for( uint i = 0; i < dimension; i++ )
+    {
+      length += ( distance + ( 1u << min( i, 31u ) ) - 1 ) >> min( i, 31u );
+    }
+    if( length <= code_length )
+    {
+      bound = distance;
+    }
+  }
+  return bound;
+}
+
+bool BestCodeSearch::build_greedy( uint distance, mt19937* generator,
+                                   vector< uint > &rows ) const
+{
+  //a row v keeps the distance when every word of the coset v + C
+  //weighs at least the distance. the codewords so far are kept to
+  //check against, doubling with each row
+  vector< uint > code_words( 1, 0 );
+  code_words.reserve( 1u << dimension );
+  rows.clear();
+  uint64_t next_word = 1;
+  while( rows.size() < dimension )
+  {
+    bool found = false;
+    for( uint tries = 0; !found; tries++ )
+    {
+      uint row;
+      if( generator != nullptr )
+      {
+        if( tries == GREEDY_TRIES )
+        {
+          return false;
+        }
+        row = ( *generator )() & word_mask;
+      }
+      else
+      {
+        if( next_word > word_mask )
+        {
+          return false;
+        }
+        row = next_word++;
+      }
+
+      found = true;
+      for( uint code_word : code_words )
+      {
+        if( static_cast< uint >( __builtin_popcount( row ^ code_word ) ) <
+            distance )
+        {
+          found = false;
+          break;
+        }
+      }
+      if( found )
+      {
+        rows.push_back( row );
+        size_t num_words = code_words.size();
+        for( size_t i = 0; i < num_words; i++ )
+        {
+          code_words.push_back( code_words[ i ] ^ row );
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool BestCodeSearch::make_candidate( uint64_t candidate,
+                                     SearchMethod method,
+                                     vector< uint > &rows ) const
+{
+  mt19937 generator( options.seed +
+                     static_cast< uint >( candidate ) * 2654435761u );
+  if( method == SEARCH_RANDOM )
+  {
+    rows.assign( dimension, 0 );
+    for( uint &row : rows )
+    {
+      row = generator() & word_mask;
+    }
+    return true;
+  }
+
+  //aim for the distance of the worst code kept: the ranking also
+  //counts the words of least weight, so a code at that distance may
+  //still beat it. odd greedy candidates reach one further, so the
+  //search still climbs past a distance it has filled
+  uint aim = max( static_cast< uint >( worst_kept.load() >> 32 ), 1u );
+  if( method == SEARCH_LEXICODE )
+  {
+    //the lexicodes are one candidate per distance, from the bound down
+    uint distance = griesmer_bound() >= candidate ?
+      griesmer_bound() - static_cast< uint >( candidate ) : 0;
+    if( distance == 0 or distance < aim )
+    {
+      return false;
+    }
+    return build_greedy( distance, nullptr, rows );
+  }
+  uint reach = aim + static_cast< uint >( candidate & 1 );
+  return build_greedy( min( reach, griesmer_bound() ), &generator, rows );
+}
+
+bool BestCodeSearch::evaluate( const vector< uint > &rows,
+                               FoundCode &found ) const
+{
+  //the rref is the canonical form kept, and its rank must be k
+  vector< uint > rref = find_rref( rows, code_length );
+  rref.erase( remove( rref.begin(), rref.end(), 0u ), rref.end() );
+  if( rref.size() < dimension )
+  {
+    return false;
+  }
+
+  //a candidate must beat the worst kept: ( d, -count ) packed so the
+  //comparison is one integer compare
+  uint64_t worst = worst_kept.load( memory_order_relaxed );
+  uint worst_distance = static_cast< uint >( worst >> 32 );
+  uint64_t worst_count = UINT32_MAX - ( worst & UINT32_MAX );
+
+  uint least = code_length + 1;
+  uint64_t num_least = 0;
+  uint code_word = 0;
+  uint64_t num_messages = 1ull << dimension;
+  for( uint64_t i = 1; i < num_messages; i++ )
+  {
+    code_word ^= rref[ __builtin_ctzll( i ) ];
+    uint weight = __builtin_popcount( code_word );
+    if( weight < least )
+    {
+      least = weight;
+      num_least = 1;
+    }
+    else if( weight == least )
+    {
+      num_least++;
+    }
+    else
+    {
+      continue;
+    }
+
+    if( least < worst_distance or
+        ( least == worst_distance and num_least >= worst_count ) )
+    {
+      return false;
+    }
+  }
+
+  found.minimum_distance = least;
+  found.num_minimum_words = num_least;
+  found.rows = rref;
+  return true;
+}
+
+void BestCodeSearch::keep( const FoundCode &found )
+{
+  lock_guard< mutex > guard( kept_lock );
+  for( const FoundCode &other : kept )
+  {
+    if( other.rows == found.rows )
+    {
+      return;
+    }
+  }
+
+  kept.push_back( found );
+  sort( kept.begin(), kept.end(),
+        []( const FoundCode &first, const FoundCode &second )
+        {
+          if( first.minimum_distance != second.minimum_distance )
+          {
+            return first.minimum_distance > second.minimum_distance;
+          }
+          if( first.num_minimum_words != second.num_minimum_words )
+          {
+            return first.num_minimum_words < second.num_minimum_words;
+          }
+          return first.rows < second.rows;
+        } );
+  if( kept.size() > options.num_kept )
+  {
+    kept.pop_back();
+  }
+  if( kept.size() == options.num_kept )
+  {
+    const FoundCode &worst = kept.back();
+    worst_kept =
+      ( static_cast< uint64_t >( worst.minimum_distance ) << 32 ) |
+      ( UINT32_MAX - min< uint64_t >( worst.num_minimum_words,
+                                      UINT32_MAX ) );
+  }
+}
+
+void BestCodeSearch::finish_block( uint64_t block )
+{
+  lock_guard< mutex > guard( kept_lock );
+  block_done[ block ] = true;
+  uint64_t old_below = blocks_below;
+  while( blocks_below < num_blocks and block_done[ blocks_below ] )
+  {
+    blocks_below++;
+  }
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  if( blocks_below != old_below and options.checkpoint_path != "" and
+      chrono::duration< double >( now - last_checkpoint ).count() >=
+      SEARCH_CHECKPOINT_SECONDS )
+  {
+    write_checkpoint();
+    last_checkpoint = now;
+  }
+}
+
+void BestCodeSearch::search_blocks()
+{
+  vector< uint > rows;
+  FoundCode found;
+  for( uint64_t block = next_block++; block < num_blocks;
+       block = next_block++ )
+  {
+    TraceScope trace( "search block", block );
+    uint64_t first = start_candidate + block * SEARCH_BLOCK;
+    uint64_t last = min( first + SEARCH_BLOCK, options.num_candidates );
+    for( uint64_t candidate = first; candidate < last; candidate++ )
+    {
+      if( !make_candidate( candidate, options.method, rows ) )
+      {
+        continue;
+      }
+      evaluated++;
+      if( evaluate( rows, found ) )
+      {
+        keep( found );
+      }
+    }
+    finish_block( block );
+  }
+}
+
+uint64_t BestCodeSearch::read_checkpoint()
+{
+  ifstream file( options.checkpoint_path );
+  uint length, checked_dimension, method, seed;
+  uint64_t candidate, num_codes;
+  if( !( file >> length >> checked_dimension >> method >> seed >>
+         candidate >> num_codes ) )
+  {
+    return 0;
+  }
+  if( length != code_length or checked_dimension != dimension or
+      method != options.method or seed != options.seed )
+  {
+    cerr << "the checkpoint " << options.checkpoint_path
+         << " is of another search; starting over" << endl;
+    return 0;
+  }
+
+  for( uint64_t i = 0; i < num_codes; i++ )
+  {
+    FoundCode found;
+    file >> found.minimum_distance >> found.num_minimum_words;
+    found.rows.assign( dimension, 0 );
+    for( uint &row : found.rows )
+    {
+      file >> row;
+    }
+    if( !file )
+    {
+      cerr << "the checkpoint " << options.checkpoint_path
+           << " is cut short; starting over" << endl;
+      kept.clear();
+      return 0;
+    }
+    keep( found );
+  }
+  return candidate;
+}
+
+void BestCodeSearch::write_checkpoint() const
+{
+  //write beside it and rename, so a crash leaves the old or the new
+  string temporary = options.checkpoint_path + ".tmp";
+  {
+    ofstream file( temporary, ios::trunc );
+    file << code_length << " " << dimension << " " << options.method << " "
+         << options.seed << " "
+         << min( options.num_candidates,
+                 start_candidate + blocks_below * SEARCH_BLOCK )
+         << " " << kept.size() << endl;
+    for( const FoundCode &found : kept )
+    {
+      file << found.minimum_distance << " " << found.num_minimum_words;
+      for( uint row : found.rows )
+      {
+        file << " " << row;
+      }
+      file << endl;
+    }
+    if( !file )
+    {
+      cerr << "could not write the checkpoint " << temporary << endl;
+      return;
+    }
+  }
+  if( rename( temporary.c_str(), options.checkpoint_path.c_str() ) != 0 )
+  {
+    cerr << "could not write the checkpoint " << options.checkpoint_path
+         << endl;
+  }
+}
+
+vector< FoundCode > BestCodeSearch::search(
+  const SearchOptions &param_options )
+{
+  TraceScope trace( "code search" );
+  options = param_options;
+  options.num_threads = max( options.num_threads, 1u );
+  options.num_kept = max( options.num_kept, 1u );
+  if( options.method == SEARCH_LEXICODE )
+  {
+    options.num_candidates = min< uint64_t >( options.num_candidates,
+                                              griesmer_bound() );
+  }
+
+  kept.clear();
+  worst_kept = 0;
+  evaluated = 0;
+  start_candidate = 0;
+  if( options.checkpoint_path != "" )
+  {
+    start_candidate = min( read_checkpoint(), options.num_candidates );
+  }
+  num_blocks = ( options.num_candidates - start_candidate +
+                 SEARCH_BLOCK - 1 ) / SEARCH_BLOCK;
+  next_block = 0;
+  block_done.assign( num_blocks, false );
+  blocks_below = 0;
+  last_checkpoint = chrono::steady_clock::now();
+
+  vector< thread > workers;
+  for( uint t = 1; t < options.num_threads; t++ )
+  {
+    workers.push_back( thread( &BestCodeSearch::search_blocks, this ) );
+  }
+  search_blocks();
+  for( thread &worker : workers )
+  {
+    worker.join();
+  }
+
+  if( options.checkpoint_path != "" )
+  {
+    write_checkpoint();
+  }
+  return kept;
+}
+
+uint64_t BestCodeSearch::get_evaluated() const
+{
+  return evaluated;
+}
+
+void BestCodeSearch::write_code( ostream &out, const FoundCode &code ) const
+{
+  out << code_length << endl;
+  for( uint row : code.rows )
+  {
+    out << row << endl;
+  }
+}
+
+#endif
@@ -0,0 +1,228 @@
+#ifndef CODEBOOK_SEARCH_H
+#define CODEBOOK_SEARCH_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "bit_kernels.h"
+#include "linear_code.h"
+
+using namespace std;
+
+/*
+ * the codewords searched per tile, 1 KiB. the words already within t
+ * of a codeword stop searching after each tile, so a tile is small
+ * enough for the stop to matter in a codebook of 2^12 words
+ */
+const uint CODEBOOK_TILE = 256;
+
+/*
+ * the received words run against each tile
+ */
+const uint SEARCH_BATCH = TILE_MAX_RECEIVED;
+
+/*
+ * a kernel finding the least distance from each of a batch of
+ * received words to a run of codewords
+ */
+typedef void ( *TileKernel )( const uint* words, uint count,
+                              const uint* received, uint num_received,
+                              uint* least );
+
+/**
+ * A nearest codeword search for codes whose dimension is too large for
+ * a hand scan and whose redundancy is too large for a syndrome table.
+ * The codebook is already a flat array of words, so a tile is a
+ * contiguous run the kernel streams through with xor and popcount,
+ * loading each codeword once for a whole batch of received words.
+ * After each tile, a word with a codeword within the correction
+ * capability stops searching, since no other codeword can be as
+ * close. The received words are masked to the n code bits first, so
+ * stray high bits cannot hide a codeword within t. The result is the
+ * codeword LinearCode::decode_word returns: the first in the codebook
+ * at the least distance.
+ * @author agent
+ * @version 18 October 2026
+ */
+class CodebookSearch
+{
+public:
+  /**
+   * Constructor choosing the widest kernel the processor supports
+   * @param code the code, which must outlive the search
+   */
+  CodebookSearch( const LinearCode &code );
+
+  /**
+   * decode a received word
+   * @param received the received word
+   * @return the nearest codeword
+   */
+  uint decode_word( uint received ) const;
+
+  /**
+   * decode a batch of received words. may be called from several
+   * threads at once.
+   * @param received the received words
+   * @param decoded the decoded words, as long as received
+   */
+  void decode_batch( Span< const uint > received,
+                     Span< uint > decoded ) const;
+
+  /**
+   * decode a batch of received words to their messages, read off the
+   * information set of the code
+   * @param received the received words
+   * @param messages the decoded messages, as long as received
+   */
+  void decode_message_batch( Span< const uint > received,
+                             Span< uint > messages ) const;
+
+  /**
+   * Return the name of the kernel in use
+   */
+  const char* get_kernel_name() const;
+
+private:
+
+  /**
+   * decode up to SEARCH_BATCH words against every tile
+   * @param received the first received word
+   * @param count the number of words, at most SEARCH_BATCH
+   * @param decoded the decoded words
+   */
+  void search_batch( const uint* received, uint count,
+                     uint* decoded ) const;
+
+  const LinearCode &code;
+  const vector< uint > &code_words;
+  uint correction_capability;
+  uint word_mask;
+  TileKernel kernel;
+  const char* kernel_name;
+};
+
+CodebookSearch::CodebookSearch( const LinearCode &param_code )
+: code( param_code ), code_words( param_code.get_code_words() ),
+  correction_capability( param_code.get_correction_capability() ),
+  word_mask( param_code.get_code_length() >= 32 ? UINT_MAX :
+             ( 1u << param_code.get_code_length() ) - 1 )
+{
+  kernel = bit_kernels().tile_min_batch;
+  kernel_name = bit_kernels().name;
+}
+
+const char* CodebookSearch::get_kernel_name() const
+{
+  return kernel_name;
+}
+
+void CodebookSearch::search_batch( const uint* received, uint count,
+                                   uint* decoded ) const
+{
+  uint least[ SEARCH_BATCH ];
+  uint masked[ SEARCH_BATCH ];
+  for( uint lane = 0; lane < count; lane++ )
+  {
+    least[ lane ] = UINT_MAX;
+    masked[ lane ] = received[ lane ] & word_mask;
+    decoded[ lane ] = received[ lane ];
+  }
+
+  //the lanes still searching, packed to the front for the kernel
+  uint active_lanes[ SEARCH_BATCH ];
+  uint active_words[ SEARCH_BATCH ];
+  uint tile_least[ SEARCH_BATCH ];
+  uint num_active = count;
+  for( uint lane = 0; lane < count; lane++ )
+  {
+    active_lanes[ lane ] = lane;
+    active_words[ lane ] = masked[ lane ];
+  }
+
+  uint num_words = code_words.size();
+  for( uint tile = 0; tile < num_words and num_active > 0;
+       tile += CODEBOOK_TILE )
+  {
+    const uint* words = code_words.data() + tile;
+    uint tile_size = min( CODEBOOK_TILE, num_words - tile );
+    kernel( words, tile_size, active_words, num_active, tile_least );
+
+    uint still_active = 0;
+    for( uint a = 0; a < num_active; a++ )
+    {
+      uint lane = active_lanes[ a ];
+      uint distance = tile_least[ a ];
+      if( distance < least[ lane ] )
+      {
+        //an improvement; the first codeword at that distance is the
+        //one a scan in codebook order would keep
+        least[ lane ] = distance;
+        uint i = 0;
+        while( static_cast< uint >(
+                 __builtin_popcount( words[ i ] ^ masked[ lane ] ) ) !=
+               distance )
+        {
+          i++;
+        }
+        decoded[ lane ] = words[ i ];
+      }
+      if( least[ lane ] > correction_capability )
+      {
+        active_lanes[ still_active ] = lane;
+        active_words[ still_active ] = masked[ lane ];
+        still_active++;
+      }
+    }
+    num_active = still_active;
+  }
+
+  if( CodecStats::is_enabled() )
+  {
+    for( uint lane = 0; lane < count; lane++ )
+    {
+      CodecStats::count( WORDS_DECODED );
+      if( least[ lane ] > correction_capability )
+      {
+        CodecStats::count( DECODE_FAILURES );
+      }
+      else
+      {
+        CodecStats::count( ERRORS_CORRECTED, least[ lane ] );
+      }
+    }
+  }
+}
+
+uint CodebookSearch::decode_word( uint received ) const
+{
+  uint decoded = 0;
+  search_batch( &received, 1, &decoded );
+  return decoded;
+}
+
+void CodebookSearch::decode_batch( Span< const uint > received,
+                                   Span< uint > decoded ) const
+{
+  for( size_t first = 0; first < received.size(); first += SEARCH_BATCH )
+  {
+    uint count = min< size_t >( SEARCH_BATCH, received.size() - first );
+    search_batch( received.data() + first, count, decoded.data() + first );
+  }
+}
+
+void CodebookSearch::decode_message_batch( Span< const uint > received,
+                                           Span< uint > messages ) const
+{
+  decode_batch( received, messages );
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    messages[ i ] = code.extract_message( messages[ i ] );
+  }
+}
+
+#endif
@@ -0,0 +1,442 @@
+#ifndef CODEC_SERVER_H
+#define CODEC_SERVER_H
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "linear_code.h"
+#include "decoder_tuner.h"
+
+using namespace std;
+
+/*
+ * the request operations
+ */
+enum ServerOperation
+{
+  SERVER_INFO,
+  SERVER_ENCODE,
+  SERVER_DECODE,
+  SERVER_DECODE_MESSAGE,
+  SERVER_SYNDROME
+};
+
+/*
+ * the response statuses
+ */
+enum ServerStatus
+{
+  SERVER_OK,
+  SERVER_UNKNOWN_CODE,
+  SERVER_UNKNOWN_OPERATION,
+  SERVER_TOO_LARGE
+};
+
+/*
+ * the most words in one request, and the size of each connection's
+ * input and output buffers
+ */
+const uint SERVER_MAX_WORDS = 1 << 16;
+const size_t SERVER_BUFFER_BYTES = 1 << 16;
+
+/*
+ * a code kept resident with the decoder tuned for it
+ */
+struct ServedCode
+{
+  ServedCode( LinearCode param_code, const string &choice_file,
+              uint64_t cache_capacity, bool allow_incomplete )
+  : code( move( param_code ) ),
+    decoder( code, DECODER_MEMORY_BUDGET, choice_file, allow_incomplete )
+  {
+    decoder.set_cache( cache_capacity );
+  }
+
+  LinearCode code;
+  TunedDecoder decoder;
+};
+
+/*
+ * the buffers of one connection, allocated once when it opens
+ */
+struct ServerConnection
+{
+  int input_fd;
+  int output_fd;
+  vector< uint8_t > input;
+  size_t input_start;
+  size_t input_end;
+  vector< uint8_t > output;
+  size_t output_size;
+  vector< uint > words;
+  vector< uint > results;
+};
+
+/**
+ * A server keeping constructed codes and their decoders resident, so
+ * the cost of building them is paid once rather than once per job.
+ * Requests and responses are frames of 32 bit words in host byte
+ * order. A request is ( operation, code, count ) followed by count
+ * words; the response is ( status, count ) followed by count words.
+ * The operations are
+ *   SERVER_INFO            n, k and d of the code
+ *   SERVER_ENCODE          messages to codewords
+ *   SERVER_DECODE          received words to codewords
+ *   SERVER_DECODE_MESSAGE  received words to messages
+ *   SERVER_SYNDROME        words to syndromes
+ * where a code is its index in the order the codes were added. A
+ * client may send any number of requests before reading: responses
+ * are buffered while more requests are waiting and written out before
+ * the server blocks for input, so pipelined requests share system
+ * calls. Each connection's buffers are allocated once, so a request
+ * does no allocation.
+ * @author agent
+ * @version 18 October 2026
+ */
+class CodecServer
+{
+public:
+  /**
+   * keep a code resident, with the fastest of the decoders for it
+   * @param code the code
+   * @param choice_file a file of earlier decoder picks, or empty
+   * @param cache_capacity the decoded words to cache, or 0 for none
+   * @param allow_incomplete whether or not the decoder may leave a
+   * word with more than t errors as it was received
+   * @return the index requests name it by
+   */
+  uint add_code( LinearCode code, const string &choice_file = "",
+                 uint64_t cache_capacity = 0,
+                 bool allow_incomplete = false );
+
+  /**
+   * print the decoder picked for each code and why
+   * @param out the stream to print to
+   */
+  void print_decoders( ostream &out ) const;
+
+  /**
+   * Return the number of codes resident
+   */
+  uint get_num_codes() const;
+
+  /**
+   * serve requests from one stream until it closes
+   * @param input_fd the descriptor requests are read from
+   * @param output_fd the descriptor responses are written to
+   */
+  void serve_stream( int input_fd, int output_fd ) const;
+
+  /**
+   * listen on a Unix domain socket, serving each connection on its
+   * own thread. does not return unless the socket cannot be opened.
+   * @param path the path of the socket
+   * @return -1
+   */
+  int serve_socket( const char* path ) const;
+
+private:
+
+  /**
+   * read bytes from a connection, flushing its responses first if
+   * it would block
+   * @param connection the connection
+   * @param bytes where to put them
+   * @param length the number of bytes
+   * @return whether or not they were read before the stream closed
+   */
+  bool read_bytes( ServerConnection &connection, void* bytes,
+                   size_t length ) const;
+
+  /**
+   * buffer bytes to write to a connection
+   * @param connection the connection
+   * @param bytes the bytes
+   * @param length the number of bytes
+   * @return whether or not the stream is still open
+   */
+  bool write_bytes( ServerConnection &connection, const void* bytes,
+                    size_t length ) const;
+
+  /**
+   * write out a connection's buffered responses
+   * @param connection the connection
+   * @return whether or not the stream is still open
+   */
+  bool flush( ServerConnection &connection ) const;
+
+  /**
+   * carry out one request
+   * @param operation the operation
+   * @param code_index the code
+   * @param count the number of words, already in connection.words
+   * @param connection the connection
+   * @return the status, with the results in connection.results
+   */
+  ServerStatus handle( uint operation, uint code_index, uint count,
+                       ServerConnection &connection ) const;
+
+  vector< unique_ptr< ServedCode > > codes;
+};
+
+uint CodecServer::add_code( LinearCode code, const string &choice_file,
+                           uint64_t cache_capacity, bool allow_incomplete )
+{
+  codes.push_back( unique_ptr< ServedCode >(
+    new ServedCode( move( code ), choice_file, cache_capacity,
+                    allow_incomplete ) ) );
+  return codes.size() - 1;
+}
+
+void CodecServer::print_decoders( ostream &out ) const
+{
+  for( const unique_ptr< ServedCode > &served : codes )
+  {
+    served->decoder.print_report( out );
+  }
+}
+
+uint CodecServer::get_num_codes() const
+{
+  return codes.size();
+}
+
+bool CodecServer::flush( ServerConnection &connection ) const
+{
+  size_t written = 0;
+  while( written < connection.output_size )
+  {
+    ssize_t result = write( connection.output_fd,
+                            connection.output.data() + written,
+                            connection.output_size - written );
+    if( result < 0 and errno == EINTR )
+    {
+      continue;
+    }
+    if( result <= 0 )
+    {
+      //EPIPE: the client closed its end before reading its responses
+      return false;
+    }
+    written += result;
+  }
+  connection.output_size = 0;
+  return true;
+}
+
+bool CodecServer::read_bytes( ServerConnection &connection, void* bytes,
+                              size_t length ) const
+{
+  uint8_t* target = static_cast< uint8_t* >( bytes );
+  while( length > 0 )
+  {
+    if( connection.input_start == connection.input_end )
+    {
+      //out of buffered requests, so the client is waiting on the
+      //responses so far
+      if( !flush( connection ) )
+      {
+        return false;
+      }
+      ssize_t result = read( connection.input_fd, connection.input.data(),
+                             connection.input.size() );
+      if( result < 0 and errno == EINTR )
+      {
+        continue;
+      }
+      if( result <= 0 )
+      {
+        return false;
+      }
+      connection.input_start = 0;
+      connection.input_end = result;
+    }
+    size_t chunk = min( length,
+                        connection.input_end - connection.input_start );
+    memcpy( target, connection.input.data() + connection.input_start,
+            chunk );
+    connection.input_start += chunk;
+    target += chunk;
+    length -= chunk;
+  }
+  return true;
+}
+
+bool CodecServer::write_bytes( ServerConnection &connection,
+                               const void* bytes, size_t length ) const
+{
+  const uint8_t* source = static_cast< const uint8_t* >( bytes );
+  while( length > 0 )
+  {
+    if( connection.output_size == connection.output.size() and
+        !flush( connection ) )
+    {
+      return false;
+    }
+    size_t chunk = min( length,
+                        connection.output.size() - connection.output_size );
+    memcpy( connection.output.data() + connection.output_size, source,
+            chunk );
+    connection.output_size += chunk;
+    source += chunk;
+    length -= chunk;
+  }
+  return true;
+}
+
+ServerStatus CodecServer::handle( uint operation, uint code_index,
+                                  uint count,
+                                  ServerConnection &connection ) const
+{
+  if( code_index >= codes.size() )
+  {
+    return SERVER_UNKNOWN_CODE;
+  }
+  const ServedCode &served = *codes[ code_index ];
+  Span< const uint > words( connection.words.data(), count );
+  Span< uint > results( connection.results.data(), count );
+
+  switch( operation )
+  {
+  case SERVER_INFO:
+    connection.results[ 0 ] = served.code.get_code_length();
+    connection.results[ 1 ] = served.code.get_dimension();
+    connection.results[ 2 ] = served.code.get_minimum_distance();
+    return SERVER_OK;
+  case SERVER_ENCODE:
+    served.code.encode_batch( words, results );
+    return SERVER_OK;
+  case SERVER_DECODE:
+    served.decoder.decode_batch( words, results );
+    return SERVER_OK;
+  case SERVER_DECODE_MESSAGE:
+    served.decoder.decode_message_batch( words, results );
+    return SERVER_OK;
+  case SERVER_SYNDROME:
+    served.code.syndrome_batch( words, results );
+    return SERVER_OK;
+  }
+  return SERVER_UNKNOWN_OPERATION;
+}
+
+void CodecServer::serve_stream( int input_fd, int output_fd ) const
+{
+  ServerConnection connection;
+  connection.input_fd = input_fd;
+  connection.output_fd = output_fd;
+  connection.input.resize( SERVER_BUFFER_BYTES );
+  connection.input_start = 0;
+  connection.input_end = 0;
+  connection.output.resize( SERVER_BUFFER_BYTES );
+  connection.output_size = 0;
+  connection.words.resize( SERVER_MAX_WORDS );
+  connection.results.resize( SERVER_MAX_WORDS );
+
+  uint header[ 3 ];
+  while( read_bytes( connection, header, sizeof( header ) ) )
+  {
+    uint operation = header[ 0 ];
+    uint code_index = header[ 1 ];
+    uint count = header[ 2 ];
+    TraceScope trace( "server request", operation );
+
+    //a request too large is read and dropped so the stream stays in
+    //step with the frames
+    ServerStatus status = SERVER_OK;
+    if( count > SERVER_MAX_WORDS )
+    {
+      status = SERVER_TOO_LARGE;
+      for( uint dropped = 0; dropped < count; dropped += SERVER_MAX_WORDS )
+      {
+        uint chunk = min( count - dropped, SERVER_MAX_WORDS );
+        if( !read_bytes( connection, connection.words.data(),
+                         chunk * sizeof( uint ) ) )
+        {
+          return;
+        }
+      }
+    }
+    else if( !read_bytes( connection, connection.words.data(),
+                          count * sizeof( uint ) ) )
+    {
+      return;
+    }
+
+    if( status == SERVER_OK )
+    {
+      status = handle( operation, code_index, count, connection );
+    }
+    uint result_count = 0;
+    if( status == SERVER_OK )
+    {
+      result_count = operation == SERVER_INFO ? 3 : count;
+    }
+    uint response[ 2 ] = { static_cast< uint >( status ), result_count };
+    if( !write_bytes( connection, response, sizeof( response ) ) or
+        !write_bytes( connection, connection.results.data(),
+                      result_count * sizeof( uint ) ) )
+    {
+      return;
+    }
+  }
+  flush( connection );
+}
+
+int CodecServer::serve_socket( const char* path ) const
+{
+  int listener = socket( AF_UNIX, SOCK_STREAM, 0 );
+  sockaddr_un address;
+  memset( &address, 0, sizeof( address ) );
+  address.sun_family = AF_UNIX;
+  if( listener < 0 or strlen( path ) >= sizeof( address.sun_path ) )
+  {
+    cerr << "could not open a socket at " << path << endl;
+    return -1;
+  }
+  strcpy( address.sun_path, path );
+  unlink( path );
+
+  //a client that hangs up early must close its connection, not end
+  //the server, so a write to it fails with EPIPE instead of a signal
+  signal( SIGPIPE, SIG_IGN );
+  if( bind( listener, reinterpret_cast< sockaddr* >( &address ),
+            sizeof( address ) ) < 0 or listen( listener, 16 ) < 0 )
+  {
+    cerr << "could not listen at " << path << ": "
+         << strerror( errno ) << endl;
+    close( listener );
+    return -1;
+  }
+
+  while( true )
+  {
+    int client = accept( listener, nullptr, nullptr );
+    if( client < 0 )
+    {
+      if( errno == EINTR )
+      {
+        continue;
+      }
+      cerr << "accept failed: " << strerror( errno ) << endl;
+      close( listener );
+      return -1;
+    }
+    thread( [ this, client ]()
+    {
+      serve_stream( client, client );
+      close( client );
+    } ).detach();
+  }
+}
+
+#endif
@@ -0,0 +1,439 @@
+#ifndef CODEC_STATS_H
+#define CODEC_STATS_H
+
+#include <cstdint>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "trace.h"
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+using namespace std;
+
+/*
+ * the counters kept for every thread that touches a code
+ */
+enum CodecCounter
+{
+  WORDS_ENCODED,
+  WORDS_DECODED,
+  ERRORS_CORRECTED,
+  DECODE_FAILURES,
+  SYNDROME_TABLE_HITS,
+  DECODE_CACHE_HITS,
+  DECODE_CACHE_MISSES,
+  NUM_CODEC_COUNTERS
+};
+
+/*
+ * the stages of the encode / transmit / decode pipeline
+ */
+enum CodecStage
+{
+  STAGE_READ,
+  STAGE_MAP,
+  STAGE_ENCODE,
+  STAGE_CHANNEL,
+  STAGE_DECODE,
+  STAGE_COMPARE,
+  NUM_CODEC_STAGES
+};
+
+/**
+ * Process wide instrumentation for the codec. Every thread writes
+ * only to its own block of counters, so recording is a relaxed
+ * load and store with no locked instructions. The blocks are kept
+ * on a lock-free list so they can be summed at any time, even after
+ * the thread that owned them has exited. When the stats are
+ * disabled every call reduces to a single relaxed load and branch.
+ * @author agent
+ * @version 18 October 2026
+ */
+class CodecStats
+{
+public:
+
+  /**
+   * The totals of every thread's counters and stage timers
+   */
+  struct Totals
+  {
+    uint64_t counters[ NUM_CODEC_COUNTERS ];
+    uint64_t stage_nanoseconds[ NUM_CODEC_STAGES ];
+    uint64_t stage_cycles[ NUM_CODEC_STAGES ];
+    uint64_t stage_calls[ NUM_CODEC_STAGES ];
+    uint threads;
+  };
+
+  /**
+   * turn recording on or off
+   * @param on whether or not to record
+   */
+  static void enable( bool on = true );
+
+  /**
+   * determine if recording is on for the calling thread
+   * @return whether or not the stats are recorded
+   */
+  static bool is_enabled();
+
+  /**
+   * stop or resume recording on the calling thread only, so work that
+   * is not traffic can run while other threads keep recording
+   * @param on whether or not to suppress the calling thread's stats
+   */
+  static void suppress( bool on = true );
+
+  /**
+   * determine if the calling thread's stats are suppressed
+   * @return whether or not they are suppressed
+   */
+  static bool is_suppressed();
+
+  /**
+   * add to one of the calling thread's counters
+   * @param counter the counter to add to
+   * @param amount the amount to add
+   */
+  static void count( CodecCounter counter, uint64_t amount = 1 );
+
+  /**
+   * add a measured interval to one of the calling thread's stages
+   * @param stage the stage that was timed
+   * @param nanoseconds the wall clock time of the interval
+   * @param cycles the cycle count of the interval
+   */
+  static void add_stage_time( CodecStage stage, uint64_t nanoseconds,
+                              uint64_t cycles );
+
+  /**
+   * sum the counters of every thread
+   * @return the totals
+   */
+  static Totals aggregate();
+
+  /**
+   * print a human readable summary of the totals
+   * @param out the stream to print to
+   */
+  static void print_text( ostream &out );
+
+  /**
+   * print the totals as a json object
+   * @param out the stream to print to
+   */
+  static void print_json( ostream &out );
+
+  /**
+   * return the name of a counter
+   * @param counter the counter
+   * @return its name
+   */
+  static const char* counter_name( CodecCounter counter );
+
+  /**
+   * return the name of a stage
+   * @param stage the stage
+   * @return its name
+   */
+  static const char* stage_name( CodecStage stage );
+
+  /**
+   * read the cycle counter, or 0 where there is none
+   * @return the current cycle count
+   */
+  static uint64_t read_cycles();
+
+private:
+
+  struct ThreadBlock
+  {
+    atomic< uint64_t > counters[ NUM_CODEC_COUNTERS ];
+    atomic< uint64_t > stage_nanoseconds[ NUM_CODEC_STAGES ];
+    atomic< uint64_t > stage_cycles[ NUM_CODEC_STAGES ];
+    atomic< uint64_t > stage_calls[ NUM_CODEC_STAGES ];
+    ThreadBlock* next;
+  };
+
+  /**
+   * return the calling thread's block, registering it on first use
+   * @return the block
+   */
+  static ThreadBlock& local_block();
+
+  /**
+   * add to a counter owned by the calling thread
+   * @param value the counter
+   * @param amount the amount to add
+   */
+  static void bump( atomic< uint64_t > &value, uint64_t amount );
+
+  static atomic< bool > enabled;
+  static thread_local bool suppressed;
+  static atomic< ThreadBlock* > blocks;
+};
+
+/**
+ * Times a stage from construction to destruction, and records it
+ * on the trace timeline when tracing is on
+ * @author agent
+ * @version 18 October 2026
+ */
+class StageTimer
+{
+public:
+  /**
+   * Constructor starting the timer
+   * @param stage the stage to be timed
+   */
+  StageTimer( CodecStage stage );
+
+  /**
+   * Destructor recording the elapsed time
+   */
+  ~StageTimer();
+
+private:
+  CodecStage stage;
+  bool running;
+  chrono::steady_clock::time_point start_time;
+  uint64_t start_cycles;
+  bool tracing;
+  uint64_t trace_start;
+};
+
+atomic< bool > CodecStats::enabled( false );
+thread_local bool CodecStats::suppressed( false );
+atomic< CodecStats::ThreadBlock* > CodecStats::blocks( nullptr );
+
+void CodecStats::enable( bool on )
+{
+  enabled.store( on, memory_order_relaxed );
+}
+
+bool CodecStats::is_enabled()
+{
+  return enabled.load( memory_order_relaxed ) and !suppressed;
+}
+
+void CodecStats::suppress( bool on )
+{
+  suppressed = on;
+}
+
+bool CodecStats::is_suppressed()
+{
+  return suppressed;
+}
+
+CodecStats::ThreadBlock& CodecStats::local_block()
+{
+  //each thread allocates its block once and never frees it, so the
+  //counts outlive the thread
+  static thread_local ThreadBlock* block = nullptr;
+  if( block == nullptr )
+  {
+    block = new ThreadBlock();
+    for( uint i = 0; i < NUM_CODEC_COUNTERS; i++ )
+    {
+      block -> counters[ i ].store( 0, memory_order_relaxed );
+    }
+    for( uint i = 0; i < NUM_CODEC_STAGES; i++ )
+    {
+      block -> stage_nanoseconds[ i ].store( 0, memory_order_relaxed );
+      block -> stage_cycles[ i ].store( 0, memory_order_relaxed );
+      block -> stage_calls[ i ].store( 0, memory_order_relaxed );
+    }
+
+    //push the block onto the list of all blocks
+    ThreadBlock* old_head = blocks.load( memory_order_relaxed );
+    do
+    {
+      block -> next = old_head;
+    }
+    while( !blocks.compare_exchange_weak( old_head, block,
+                                          memory_order_release,
+                                          memory_order_relaxed ) );
+  }
+  return *block;
+}
+
+void CodecStats::bump( atomic< uint64_t > &value, uint64_t amount )
+{
+  //only the owning thread writes, so no read-modify-write is needed
+  value.store( value.load( memory_order_relaxed ) + amount,
+               memory_order_relaxed );
+}
+
+void CodecStats::count( CodecCounter counter, uint64_t amount )
+{
+  if( !is_enabled() )
+  {
+    return;
+  }
+  bump( local_block().counters[ counter ], amount );
+}
+
+void CodecStats::add_stage_time( CodecStage stage,
+                                 uint64_t nanoseconds,
+                                 uint64_t cycles )
+{
+  if( !is_enabled() )
+  {
+    return;
+  }
+  ThreadBlock &block = local_block();
+  bump( block.stage_nanoseconds[ stage ], nanoseconds );
+  bump( block.stage_cycles[ stage ], cycles );
+  bump( block.stage_calls[ stage ], 1 );
+}
+
+CodecStats::Totals CodecStats::aggregate()
+{
+  Totals totals = Totals();
+  for( ThreadBlock* block = blocks.load( memory_order_acquire );
+       block != nullptr; block = block -> next )
+  {
+    totals.threads++;
+    for( uint i = 0; i < NUM_CODEC_COUNTERS; i++ )
+    {
+      totals.counters[ i ] +=
+        block -> counters[ i ].load( memory_order_relaxed );
+    }
+    for( uint i = 0; i < NUM_CODEC_STAGES; i++ )
+    {
+      totals.stage_nanoseconds[ i ] +=
+        block -> stage_nanoseconds[ i ].load( memory_order_relaxed );
+      totals.stage_cycles[ i ] +=
+        block -> stage_cycles[ i ].load( memory_order_relaxed );
+      totals.stage_calls[ i ] +=
+        block -> stage_calls[ i ].load( memory_order_relaxed );
+    }
+  }
+  return totals;
+}
+
+const char* CodecStats::counter_name( CodecCounter counter )
+{
+  switch( counter )
+  {
+  case WORDS_ENCODED: return "words_encoded";
+  case WORDS_DECODED: return "words_decoded";
+  case ERRORS_CORRECTED: return "errors_corrected";
+  case DECODE_FAILURES: return "decode_failures";
+  case SYNDROME_TABLE_HITS: return "syndrome_table_hits";
+  case DECODE_CACHE_HITS: return "decode_cache_hits";
+  case DECODE_CACHE_MISSES: return "decode_cache_misses";
+  default: return "unknown";
+  }
+}
+
+const char* CodecStats::stage_name( CodecStage stage )
+{
+  switch( stage )
+  {
+  case STAGE_READ: return "read";
+  case STAGE_MAP: return "map";
+  case STAGE_ENCODE: return "encode";
+  case STAGE_CHANNEL: return "channel";
+  case STAGE_DECODE: return "decode";
+  case STAGE_COMPARE: return "compare";
+  default: return "unknown";
+  }
+}
+
+void CodecStats::print_text( ostream &out )
+{
+  Totals totals = aggregate();
+  out << "codec stats (" << totals.threads << " threads)" << endl;
+  for( uint i = 0; i < NUM_CODEC_COUNTERS; i++ )
+  {
+    out << "  " << counter_name( static_cast< CodecCounter >( i ) )
+        << ": " << totals.counters[ i ] << endl;
+  }
+  uint64_t lookups = totals.counters[ DECODE_CACHE_HITS ] +
+    totals.counters[ DECODE_CACHE_MISSES ];
+  if( lookups > 0 )
+  {
+    out << "  decode_cache_hit_rate: "
+        << 100.0 * totals.counters[ DECODE_CACHE_HITS ] / lookups << "%"
+        << endl;
+  }
+  out << "stage timings" << endl;
+  for( uint i = 0; i < NUM_CODEC_STAGES; i++ )
+  {
+    out << "  " << stage_name( static_cast< CodecStage >( i ) )
+        << ": " << totals.stage_nanoseconds[ i ] / 1000.0 << " us, "
+        << totals.stage_cycles[ i ] << " cycles, "
+        << totals.stage_calls[ i ] << " calls" << endl;
+  }
+  out << endl;
+}
+
+void CodecStats::print_json( ostream &out )
+{
+  Totals totals = aggregate();
+  out << "{\"threads\": " << totals.threads << ", \"counters\": {";
+  for( uint i = 0; i < NUM_CODEC_COUNTERS; i++ )
+  {
+    out << ( i == 0 ? "" : ", " ) << "\""
+        << counter_name( static_cast< CodecCounter >( i ) ) << "\": "
+        << totals.counters[ i ];
+  }
+  out << "}, \"stages\": {";
+  for( uint i = 0; i < NUM_CODEC_STAGES; i++ )
+  {
+    out << ( i == 0 ? "" : ", " ) << "\""
+        << stage_name( static_cast< CodecStage >( i ) ) << "\": {"
+        << "\"nanoseconds\": " << totals.stage_nanoseconds[ i ]
+        << ", \"cycles\": " << totals.stage_cycles[ i ]
+        << ", \"calls\": " << totals.stage_calls[ i ] << "}";
+  }
+  out << "}}" << endl;
+}
+
+uint64_t CodecStats::read_cycles()
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+StageTimer::StageTimer( CodecStage param_stage )
+: stage( param_stage ), running( CodecStats::is_enabled() ),
+  start_cycles( 0 ), tracing( Trace::is_enabled() ), trace_start( 0 )
+{
+  if( running )
+  {
+    start_time = chrono::steady_clock::now();
+    start_cycles = CodecStats::read_cycles();
+  }
+  if( tracing )
+  {
+    trace_start = Trace::now();
+  }
+}
+
+StageTimer::~StageTimer()
+{
+  if( running )
+  {
+    uint64_t cycles = CodecStats::read_cycles() - start_cycles;
+    uint64_t nanoseconds =
+      chrono::duration_cast< chrono::nanoseconds >(
+        chrono::steady_clock::now() - start_time ).count();
+    CodecStats::add_stage_time( stage, nanoseconds, cycles );
+  }
+  if( tracing )
+  {
+    Trace::record( CodecStats::stage_name( stage ), trace_start,
+                   Trace::now() );
+  }
+}
+
+#endif
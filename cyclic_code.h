@@ -0,0 +1,573 @@
+#ifndef CYCLIC_CODE_H
+#define CYCLIC_CODE_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "trace.h"
+#include "linear_code.h"
+
+using namespace std;
+
+/*
+ * the message bytes the remainder tables cover, one table per byte
+ */
+const uint CYCLIC_SLICES = 8;
+
+/*
+ * the largest dimension whose codewords are enumerated to find the
+ * minimum distance
+ */
+const uint CYCLIC_ENUMERATED_DIMENSION = 24;
+
+/*
+ * the most syndromes the Meggitt table may hold
+ */
+const uint64_t MEGGITT_MAX_PATTERNS = 1 << 22;
+
+/*
+ * the most parity coordinates for which the Meggitt table is a bitmap
+ * indexed by syndrome rather than a sorted list
+ */
+const uint MEGGITT_BITMAP_REDUNDANCY = 24;
+
+/**
+ * A binary cyclic code of length n <= 64 built from a generator
+ * polynomial g(x) dividing x^n - 1, with coefficient i at bit i.
+ * Words are uint64_ts with coordinate i at bit i. Encoding is
+ * systematic, the layout BCHCode uses: the message occupies
+ * coordinates n - k .. n - 1 and the parity, x^( n - k ) m(x) mod
+ * g(x), coordinates 0 .. n - k - 1. The remainder is found the way a
+ * fast CRC is, slicing by 8: table j holds v(x) x^( n - k + 8 j ) mod
+ * g(x) for every byte v, so the parity of a message is one lookup per
+ * message byte. A syndrome is the remainder of the received word, the
+ * same lookups on its message part added to its parity part.
+ * Decoding shifts the syndrome cyclically, a multiply by x mod g(x).
+ * Error trapping looks for a shift that gathers every error into the
+ * parity coordinates, where the syndrome is the error itself; when
+ * no shift does, a Meggitt decoder corrects the coordinate shifted
+ * into place n - 1 whenever the syndrome is one of a pattern of
+ * weight at most t with an error there. With at most
+ * MEGGITT_BITMAP_REDUNDANCY parity coordinates the patterns' syndromes
+ * are a bitmap, so each shift is a few instructions.
+ * @author agent
+ * @version 18 October 2026
+ */
+class CyclicCode
+{
+public:
+  /**
+   * Constructor specifying the generator polynomial
+   * @param code_length n, at most 64
+   * @param generator_polynomial g(x), dividing x^n - 1
+   * @param correction_capability the errors to correct, or UINT_MAX
+   * to find it from the minimum distance, which needs a dimension of
+   * at most CYCLIC_ENUMERATED_DIMENSION
+   */
+  CyclicCode( uint code_length, uint64_t generator_polynomial,
+              uint correction_capability = UINT_MAX );
+
+  /**
+   * Return the code length
+   */
+  uint get_code_length() const;
+
+  /**
+   * Return the dimension of the code
+   */
+  uint get_dimension() const;
+
+  /**
+   * Return the number of errors the decoder corrects
+   */
+  uint get_correction_capability() const;
+
+  /**
+   * Return the generator polynomial, coefficient i at bit i
+   */
+  uint64_t get_generator_polynomial() const;
+
+  /**
+   * Return the generator matrix. Row r is the codeword of message
+   * bit k - 1 - r, the layout LinearCode uses.
+   */
+  const vector< uint64_t >& get_generator() const;
+
+  /**
+   * Return the parity check matrix, one row per parity coordinate
+   */
+  const vector< uint64_t >& get_parity_check() const;
+
+  /**
+   * encode a message systematically
+   * @param message the k bit message
+   * @return the codeword
+   */
+  uint64_t encode_word( uint64_t message ) const;
+
+  /**
+   * encode a batch of messages. does no allocation.
+   * @param messages the messages
+   * @param encoded the codewords, as long as messages
+   */
+  void encode_batch( Span< const uint64_t > messages,
+                     Span< uint64_t > encoded ) const;
+
+  /**
+   * extract the message from a codeword
+   * @param code_word the codeword
+   * @return the k bit message
+   */
+  uint64_t extract_message( uint64_t code_word ) const;
+
+  /**
+   * determine the syndrome of a word, its remainder mod g(x)
+   * @param word the word
+   * @return the syndrome
+   */
+  uint64_t syndrome( uint64_t word ) const;
+
+  /**
+   * correct a received word in place. does no allocation.
+   * @param received the received word
+   * @return the number of errors corrected, or -1 if the word could
+   * not be decoded, in which case it is left unchanged
+   */
+  int decode_word( uint64_t &received ) const;
+
+  /**
+   * correct a batch of received words in place. may be called from
+   * several threads at once.
+   * @param received the received words
+   * @param corrected the number of errors corrected in each word,
+   * or -1 where decoding failed
+   */
+  void decode_batch( Span< uint64_t > received,
+                     Span< int > corrected ) const;
+
+  /**
+   * create the LinearCode with the same generator and parity check
+   * matrices. only codes of length at most 32 fit in a uint, and the
+   * code words are enumerated, so keep the dimension small.
+   * @return the linear code, or the code of length 0 if n > 32
+   */
+  LinearCode to_linear_code() const;
+
+private:
+
+  /**
+   * find v(x) x^shift mod g(x) one coordinate at a time, for building
+   * the tables
+   * @param value v(x)
+   * @param shift the power of x
+   * @return the remainder
+   */
+  uint64_t remainder_of( uint64_t value, uint shift ) const;
+
+  /**
+   * find the remainder of the product of a syndrome and x
+   * @param syndrome the syndrome
+   * @return x times it, mod g(x)
+   */
+  uint64_t shift_syndrome( uint64_t syndrome ) const;
+
+  /**
+   * find the parity of a message, x^( n - k ) m(x) mod g(x)
+   * @param message the message
+   * @return the parity
+   */
+  uint64_t parity_of( uint64_t message ) const;
+
+  /**
+   * find the generator and parity check matrices
+   */
+  void build_matrices();
+
+  /**
+   * find the least weight of a nonzero codeword
+   * @return the minimum distance
+   */
+  uint find_minimum_distance() const;
+
+  /**
+   * determine whether a syndrome is one of the Meggitt patterns
+   * @param syndrome the syndrome
+   * @return whether or not coordinate n - 1 is in error
+   */
+  bool is_meggitt( uint64_t syndrome ) const;
+
+  /**
+   * add the syndromes of the patterns of weight at most t with an
+   * error in coordinate n - 1 to the Meggitt table
+   * @param remaining the errors still to place
+   * @param next the lowest coordinate left to place one in
+   * @param pattern the pattern so far
+   */
+  void fill_meggitt( uint remaining, uint next, uint64_t pattern );
+
+  uint code_length;
+  uint dimension;
+  uint redundancy;
+  uint correction_capability;
+  uint64_t generator_polynomial;
+  uint64_t word_mask;
+  uint64_t parity_mask;
+  uint64_t top_syndrome;
+  vector< uint64_t > slices;
+  vector< uint64_t > generator;
+  vector< uint64_t > parity_check;
+  vector< uint64_t > meggitt_syndromes;
+  vector< uint64_t > meggitt_bitmap;
+};
+
+CyclicCode::CyclicCode( uint param_code_length,
+                        uint64_t param_generator_polynomial,
+                        uint param_correction_capability )
+: code_length( param_code_length ), dimension( 0 ), redundancy( 0 ),
+  correction_capability( 0 ),
+  generator_polynomial( param_generator_polynomial ), word_mask( 0 ),
+  parity_mask( 0 ), top_syndrome( 0 )
+{
+  TraceScope trace( "cyclic construction" );
+
+  if( code_length == 0 or code_length > 64 )
+  {
+    cout << "cyclic codes must be 1 to 64 long." << endl;
+    code_length = min( max( code_length, 1u ), 64u );
+  }
+  word_mask = code_length == 64 ? ~0ull : ( 1ull << code_length ) - 1;
+  if( generator_polynomial == 0 or
+      static_cast< uint >( 63 - __builtin_clzll( generator_polynomial ) ) >=
+      code_length )
+  {
+    cout << "the generator polynomial must have degree below n." << endl;
+    generator_polynomial = 1;
+  }
+  redundancy = 63 - __builtin_clzll( generator_polynomial );
+  dimension = code_length - redundancy;
+  parity_mask = ( 1ull << redundancy ) - 1;
+
+  //the tables: slice j maps a byte v to v(x) x^( r + 8 j ) mod g(x)
+  slices.assign( CYCLIC_SLICES * 256, 0 );
+  for( uint j = 0; j < CYCLIC_SLICES; j++ )
+  {
+    for( uint v = 0; v < 256; v++ )
+    {
+      slices[ j * 256 + v ] = remainder_of( v, redundancy + 8 * j );
+    }
+  }
+  top_syndrome = remainder_of( 1, code_length - 1 );
+
+  //g(x) divides x^n - 1 exactly when x^n mod g(x) is 1
+  if( remainder_of( 1, code_length ) != 1 % generator_polynomial )
+  {
+    cout << "the generator polynomial does not divide x^"
+         << code_length << " - 1." << endl;
+  }
+
+  build_matrices();
+
+  if( param_correction_capability != UINT_MAX )
+  {
+    correction_capability = param_correction_capability;
+  }
+  else if( dimension <= CYCLIC_ENUMERATED_DIMENSION )
+  {
+    uint minimum_distance = find_minimum_distance();
+    correction_capability = minimum_distance > 0 ?
+      ( minimum_distance - 1 ) / 2 : 0;
+  }
+  else
+  {
+    cout << "give the correction capability of a cyclic code of "
+         << "dimension over " << CYCLIC_ENUMERATED_DIMENSION << "." << endl;
+  }
+
+  //the Meggitt table, sorted for lookup. error trapping still runs
+  //when it would be too large
+  uint64_t num_patterns = 0;
+  uint64_t choose = 1;
+  for( uint w = 0; w < correction_capability and w < code_length; w++ )
+  {
+    num_patterns += choose;
+    choose = choose * ( code_length - 1 - w ) / ( w + 1 );
+  }
+  if( num_patterns > MEGGITT_MAX_PATTERNS )
+  {
+    cout << "the Meggitt table is too large; decoding only traps "
+         << "errors." << endl;
+  }
+  else if( correction_capability > 0 )
+  {
+    meggitt_syndromes.reserve( num_patterns );
+    fill_meggitt( correction_capability - 1, 0,
+                  1ull << ( code_length - 1 ) );
+    if( redundancy <= MEGGITT_BITMAP_REDUNDANCY )
+    {
+      meggitt_bitmap.assign( ( ( 1ull << redundancy ) + 63 ) / 64, 0 );
+      for( uint64_t syndrome : meggitt_syndromes )
+      {
+        meggitt_bitmap[ syndrome / 64 ] |= 1ull << ( syndrome % 64 );
+      }
+      meggitt_syndromes.clear();
+      meggitt_syndromes.shrink_to_fit();
+    }
+    else
+    {
+      sort( meggitt_syndromes.begin(), meggitt_syndromes.end() );
+    }
+  }
+}
+
+uint64_t CyclicCode::remainder_of( uint64_t value, uint shift ) const
+{
+  //reduce v(x) from its top coordinate down, then multiply by x.
+  //with g(x) = 1 every remainder is 0, so the constant is reduced too
+  uint64_t remainder = 0;
+  for( uint place = 64; place > 0; place-- )
+  {
+    remainder = shift_syndrome( remainder ) ^
+      ( ( value >> ( place - 1 ) ) & 1 );
+    if( ( remainder >> redundancy ) & 1 )
+    {
+      remainder ^= generator_polynomial;
+    }
+  }
+  for( uint i = 0; i < shift; i++ )
+  {
+    remainder = shift_syndrome( remainder );
+  }
+  return remainder;
+}
+
+uint64_t CyclicCode::shift_syndrome( uint64_t syndrome ) const
+{
+  //branch free, since the carry is a coin flip on noisy words. the
+  //degree stays below 64 since r < n <= 64
+  syndrome <<= 1;
+  return syndrome ^
+    ( generator_polynomial & ( 0 - ( ( syndrome >> redundancy ) & 1 ) ) );
+}
+
+uint64_t CyclicCode::parity_of( uint64_t message ) const
+{
+  //one lookup per byte of the message, as slicing by 8 does
+  uint64_t parity = 0;
+  const uint64_t* table = slices.data();
+  for( ; message != 0; message >>= 8, table += 256 )
+  {
+    parity ^= table[ message & 0xFF ];
+  }
+  return parity;
+}
+
+void CyclicCode::build_matrices()
+{
+  //row r of G encodes message bit k - 1 - r
+  generator.clear();
+  for( uint r = 0; r < dimension; r++ )
+  {
+    uint p = dimension - 1 - r;
+    generator.push_back( parity_of( 1ull << p ) |
+                         ( 1ull << ( redundancy + p ) ) );
+  }
+
+  //row j of H checks parity coordinate j against the message
+  //coordinates whose parity covers it
+  parity_check.clear();
+  for( uint j = 0; j < redundancy; j++ )
+  {
+    uint64_t row = 1ull << j;
+    for( uint p = 0; p < dimension; p++ )
+    {
+      if( ( parity_of( 1ull << p ) >> j ) & 1 )
+      {
+        row |= 1ull << ( redundancy + p );
+      }
+    }
+    parity_check.push_back( row );
+  }
+}
+
+uint CyclicCode::find_minimum_distance() const
+{
+  //walk the codewords in gray code order, one row added per step
+  uint least = code_length;
+  uint64_t code_word = 0;
+  uint64_t num_messages = 1ull << dimension;
+  for( uint64_t i = 1; i < num_messages; i++ )
+  {
+    uint p = __builtin_ctzll( i );
+    code_word ^= generator[ dimension - 1 - p ];
+    least = min( least,
+                 static_cast< uint >( __builtin_popcountll( code_word ) ) );
+  }
+  return dimension == 0 ? 0 : least;
+}
+
+void CyclicCode::fill_meggitt( uint remaining, uint next, uint64_t pattern )
+{
+  meggitt_syndromes.push_back( syndrome( pattern ) );
+  if( remaining == 0 )
+  {
+    return;
+  }
+  for( uint place = next; place < code_length - 1; place++ )
+  {
+    fill_meggitt( remaining - 1, place + 1, pattern | ( 1ull << place ) );
+  }
+}
+
+bool CyclicCode::is_meggitt( uint64_t syndrome ) const
+{
+  if( !meggitt_bitmap.empty() )
+  {
+    return ( meggitt_bitmap[ syndrome / 64 ] >> ( syndrome % 64 ) ) & 1;
+  }
+  return binary_search( meggitt_syndromes.begin(), meggitt_syndromes.end(),
+                        syndrome );
+}
+
+uint CyclicCode::get_code_length() const
+{
+  return code_length;
+}
+
+uint CyclicCode::get_dimension() const
+{
+  return dimension;
+}
+
+uint CyclicCode::get_correction_capability() const
+{
+  return correction_capability;
+}
+
+uint64_t CyclicCode::get_generator_polynomial() const
+{
+  return generator_polynomial;
+}
+
+const vector< uint64_t >& CyclicCode::get_generator() const
+{
+  return generator;
+}
+
+const vector< uint64_t >& CyclicCode::get_parity_check() const
+{
+  return parity_check;
+}
+
+uint64_t CyclicCode::encode_word( uint64_t message ) const
+{
+  message &= dimension == 64 ? ~0ull : ( 1ull << dimension ) - 1;
+  CodecStats::count( WORDS_ENCODED );
+  return ( message << redundancy ) | parity_of( message );
+}
+
+void CyclicCode::encode_batch( Span< const uint64_t > messages,
+                               Span< uint64_t > encoded ) const
+{
+  for( size_t i = 0; i < messages.size(); i++ )
+  {
+    encoded[ i ] = encode_word( messages[ i ] );
+  }
+}
+
+uint64_t CyclicCode::extract_message( uint64_t code_word ) const
+{
+  return ( code_word & word_mask ) >> redundancy;
+}
+
+uint64_t CyclicCode::syndrome( uint64_t word ) const
+{
+  //the remainder of the message part, shifted up by x^r, plus the
+  //parity part, which is already reduced
+  word &= word_mask;
+  return parity_of( word >> redundancy ) ^ ( word & parity_mask );
+}
+
+int CyclicCode::decode_word( uint64_t &received ) const
+{
+  uint64_t first_syndrome = syndrome( received );
+  int corrected = 0;
+  if( first_syndrome != 0 )
+  {
+    corrected = -1;
+
+    //error trapping: after i shifts left the syndrome is the error
+    //itself once every error sits in the parity coordinates
+    uint64_t shifted = first_syndrome;
+    for( uint i = 0; i < code_length; i++ )
+    {
+      if( static_cast< uint >( __builtin_popcountll( shifted ) ) <=
+          correction_capability )
+      {
+        uint64_t error = i == 0 ? shifted :
+          ( ( shifted >> i ) | ( shifted << ( code_length - i ) ) ) &
+          word_mask;
+        received ^= error;
+        corrected = __builtin_popcountll( error );
+        break;
+      }
+      shifted = shift_syndrome( shifted );
+    }
+
+    //meggitt: after i shifts, coordinate n - 1 is coordinate n - 1 - i
+    //of the received word
+    if( corrected < 0 and
+        !( meggitt_syndromes.empty() and meggitt_bitmap.empty() ) )
+    {
+      uint64_t error = 0;
+      shifted = first_syndrome;
+      for( uint i = 0; i < code_length; i++ )
+      {
+        if( is_meggitt( shifted ) )
+        {
+          error |= 1ull << ( code_length - 1 - i );
+          shifted ^= top_syndrome;
+        }
+        shifted = shift_syndrome( shifted );
+      }
+      if( shifted == 0 and error != 0 )
+      {
+        received ^= error;
+        corrected = __builtin_popcountll( error );
+      }
+    }
+  }
+
+  if( CodecStats::is_enabled() )
+  {
+    CodecStats::count( WORDS_DECODED );
+    if( corrected < 0 )
+    {
+      CodecStats::count( DECODE_FAILURES );
+    }
+    else
+    {
+      CodecStats::count( ERRORS_CORRECTED, corrected );
+    }
+  }
+  return corrected;
+}
+
+void CyclicCode::decode_batch( Span< uint64_t > received,
+                               Span< int > corrected ) const
+{
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    corrected[ i ] = decode_word( received[ i ] );
+  }
+}
+
+LinearCode CyclicCode::to_linear_code() const
+{
+  return narrow_linear_code( generator, parity_check, code_length );
+}
+
+#endif
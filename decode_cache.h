@@ -0,0 +1,207 @@
+#ifndef DECODE_CACHE_H
+#define DECODE_CACHE_H
+
+#include <cstdint>
+#include <iostream>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "word_span.h"
+#include "codec_stats.h"
+
+using namespace std;
+
+/*
+ * the entries of one set of the cache, one cache line of them
+ */
+const uint DECODE_CACHE_WAYS = 8;
+
+/**
+ * A bounded cache of decoded words keyed by the received word, for
+ * traffic where the same received words recur. The cache is split
+ * into sets of DECODE_CACHE_WAYS entries, a received word living only
+ * in the set its hash picks, and each set runs CLOCK on its own: a
+ * hit sets the entry's reference bit, and an insert takes the first
+ * entry from the set's hand with its bit clear, clearing the bits it
+ * passes. An entry is one 64 bit word holding the received word and
+ * its decoding, so a reader always sees a matching pair and lookups
+ * take no lock; an insert only claims its victim with a compare and
+ * swap on the set's reference bits and hand. Every entry starts as
+ * 0 decoding to 0, which is right for any linear code, so there is
+ * no valid bit to keep. Hits and misses are counted in CodecStats.
+ * @author agent
+ * @version 18 October 2026
+ */
+class DecodeCache
+{
+public:
+  /**
+   * Constructor sizing the cache
+   * @param capacity the most words kept, rounded up to a power of 2
+   * sets
+   */
+  DecodeCache( uint64_t capacity );
+
+  /**
+   * look a received word up
+   * @param received the received word
+   * @param decoded its decoding, if it is kept
+   * @return whether or not it is kept
+   */
+  bool lookup( uint received, uint &decoded ) const;
+
+  /**
+   * keep the decoding of a received word, evicting another from its
+   * set
+   * @param received the received word
+   * @param decoded its decoding
+   */
+  void insert( uint received, uint decoded ) const;
+
+  /**
+   * decode a batch through the cache. the misses are gathered and
+   * decoded together, since batch decoders work best on batches, then
+   * scattered back and kept
+   * @param decoder the decoder of the misses, with a decode_batch of
+   * received words to codewords
+   * @param received the received words
+   * @param decoded the decoded codewords
+   */
+  template< typename Decoder >
+  void decode_batch( const Decoder &decoder, Span< const uint > received,
+                     Span< uint > decoded ) const;
+
+  /**
+   * Return the number of words the cache holds
+   */
+  uint64_t get_capacity() const;
+
+private:
+
+  /**
+   * Return the set a received word lives in
+   * @param received the received word
+   */
+  uint64_t set_of( uint received ) const;
+
+  uint64_t num_sets;
+  uint set_shift;
+  unique_ptr< atomic< uint64_t >[] > entries;
+  unique_ptr< atomic< uint32_t >[] > clocks;
+};
+
+DecodeCache::DecodeCache( uint64_t capacity )
+: num_sets( 1 ), set_shift( 64 )
+{
+  while( num_sets * DECODE_CACHE_WAYS < capacity )
+  {
+    num_sets <<= 1;
+    set_shift--;
+  }
+  entries.reset( new atomic< uint64_t >[ num_sets * DECODE_CACHE_WAYS ] );
+  clocks.reset( new atomic< uint32_t >[ num_sets ] );
+  for( uint64_t i = 0; i < num_sets * DECODE_CACHE_WAYS; i++ )
+  {
+    entries[ i ].store( 0, memory_order_relaxed );
+  }
+  for( uint64_t i = 0; i < num_sets; i++ )
+  {
+    clocks[ i ].store( 0, memory_order_relaxed );
+  }
+}
+
+uint64_t DecodeCache::set_of( uint received ) const
+{
+  //fibonacci hashing, taking the high bits
+  uint64_t hash = ( received + 1ull ) * 11400714819323198485ull;
+  return set_shift == 64 ? 0 : hash >> set_shift;
+}
+
+bool DecodeCache::lookup( uint received, uint &decoded ) const
+{
+  uint64_t set = set_of( received );
+  atomic< uint64_t >* ways = &entries[ set * DECODE_CACHE_WAYS ];
+  for( uint way = 0; way < DECODE_CACHE_WAYS; way++ )
+  {
+    uint64_t entry = ways[ way ].load( memory_order_relaxed );
+    if( static_cast< uint >( entry >> 32 ) == received )
+    {
+      //mark it used, writing the line only if it is not marked yet
+      uint32_t bit = 1u << way;
+      if( ( clocks[ set ].load( memory_order_relaxed ) & bit ) == 0 )
+      {
+        clocks[ set ].fetch_or( bit, memory_order_relaxed );
+      }
+      decoded = static_cast< uint >( entry );
+      CodecStats::count( DECODE_CACHE_HITS );
+      return true;
+    }
+  }
+  CodecStats::count( DECODE_CACHE_MISSES );
+  return false;
+}
+
+void DecodeCache::insert( uint received, uint decoded ) const
+{
+  //the low byte of a clock is the reference bits and the next byte
+  //the hand. sweep from the hand, clearing bits, to the first entry
+  //not referenced; after a full turn every bit is clear, so the sweep
+  //always ends
+  uint64_t set = set_of( received );
+  atomic< uint32_t > &clock = clocks[ set ];
+  uint32_t old_clock = clock.load( memory_order_relaxed );
+  uint32_t new_clock;
+  uint victim;
+  do
+  {
+    uint32_t referenced = old_clock & 0xFF;
+    uint hand = ( old_clock >> 8 ) % DECODE_CACHE_WAYS;
+    while( ( referenced >> hand ) & 1 )
+    {
+      referenced &= ~( 1u << hand );
+      hand = ( hand + 1 ) % DECODE_CACHE_WAYS;
+    }
+    victim = hand;
+    new_clock = referenced | ( ( ( hand + 1 ) % DECODE_CACHE_WAYS ) << 8 );
+  }
+  while( !clock.compare_exchange_weak( old_clock, new_clock,
+                                       memory_order_relaxed ) );
+
+  entries[ set * DECODE_CACHE_WAYS + victim ].store(
+    ( static_cast< uint64_t >( received ) << 32 ) | decoded,
+    memory_order_relaxed );
+}
+
+template< typename Decoder >
+void DecodeCache::decode_batch( const Decoder &decoder,
+                                Span< const uint > received,
+                                Span< uint > decoded ) const
+{
+  static thread_local vector< uint > miss_words;
+  static thread_local vector< uint > miss_results;
+  static thread_local vector< size_t > miss_places;
+  miss_words.clear();
+  miss_places.clear();
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    if( !lookup( received[ i ], decoded[ i ] ) )
+    {
+      miss_words.push_back( received[ i ] );
+      miss_places.push_back( i );
+    }
+  }
+  miss_results.resize( miss_words.size() );
+  decoder.decode_batch( miss_words, miss_results );
+  for( size_t j = 0; j < miss_words.size(); j++ )
+  {
+    decoded[ miss_places[ j ] ] = miss_results[ j ];
+    insert( miss_words[ j ], miss_results[ j ] );
+  }
+}
+
+uint64_t DecodeCache::get_capacity() const
+{
+  return num_sets * DECODE_CACHE_WAYS;
+}
+
+#endif
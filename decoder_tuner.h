@@ -0,0 +1,694 @@
+#ifndef DECODER_TUNER_H
+#define DECODER_TUNER_H
+
+#include <cstdint>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <random>
+#include <chrono>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "linear_code.h"
+#include "codebook_search.h"
+#include "bounded_distance_decoder.h"
+#include "trellis_decoder.h"
+#include "decode_cache.h"
+
+using namespace std;
+
+/*
+ * the decoders a code can be run with
+ */
+enum DecoderEngine
+{
+  ENGINE_COSET_SCAN,
+  ENGINE_SYNDROME_TABLE,
+  ENGINE_BOUNDED_DISTANCE,
+  ENGINE_CODEBOOK_SEARCH,
+  ENGINE_TRELLIS,
+  NUM_DECODER_ENGINES
+};
+
+/*
+ * the memory the tuner lets one code's decoder use, and the time it
+ * spends timing each engine
+ */
+const uint64_t DECODER_MEMORY_BUDGET = 1 << 26;
+const uint64_t TUNER_TRIAL_NANOSECONDS = 2000000;
+
+/*
+ * the words an engine is checked and timed on, and the words decoded
+ * between reads of the clock
+ */
+const uint TUNER_SAMPLES = 1024;
+const uint TUNER_CHUNK = 32;
+
+/**
+ * return the name of a decoder engine
+ * @param engine the engine
+ * @return its name
+ */
+const char* decoder_engine_name( DecoderEngine engine )
+{
+  switch( engine )
+  {
+  case ENGINE_COSET_SCAN: return "coset_scan";
+  case ENGINE_SYNDROME_TABLE: return "syndrome_table";
+  case ENGINE_BOUNDED_DISTANCE: return "bounded_distance";
+  case ENGINE_CODEBOOK_SEARCH: return "codebook_search";
+  case ENGINE_TRELLIS: return "trellis";
+  default: return "unknown";
+  }
+}
+
+/**
+ * A complete syndrome decoder: a table of the coset leader of every
+ * syndrome, 2^( n - k ) words, so decoding is one syndrome and one
+ * load. The leaders are found by running through the error patterns
+ * in order of weight until every syndrome has one.
+ * @author agent
+ * @version 18 October 2026
+ */
+class SyndromeTableDecoder
+{
+public:
+  /**
+   * Constructor building the table of a code
+   * @param code the code, which must outlive the decoder
+   */
+  SyndromeTableDecoder( const LinearCode &code );
+
+  /**
+   * decode a received word
+   * @param received the received word
+   * @return the received word less the leader of its coset
+   */
+  uint decode_word( uint received ) const;
+
+  /**
+   * Return the memory used by the table in bytes
+   */
+  uint64_t get_table_bytes() const;
+
+private:
+
+  /**
+   * give the syndromes with no leader yet the patterns of one weight
+   * extending a partial pattern
+   * @param remaining the bits still to place
+   * @param next the lowest place the next bit may take
+   * @param pattern the partial pattern
+   * @param syndrome its syndrome
+   */
+  void fill( uint remaining, uint next, uint pattern, uint syndrome );
+
+  const LinearCode &code;
+  uint code_length;
+  vector< uint > columns;
+  vector< uint > leaders;
+  vector< bool > has_leader;
+  uint num_filled;
+};
+
+SyndromeTableDecoder::SyndromeTableDecoder( const LinearCode &param_code )
+: code( param_code ), code_length( param_code.get_code_length() ),
+  num_filled( 0 )
+{
+  TraceScope trace( "syndrome table build" );
+  for( uint place = 0; place < code_length; place++ )
+  {
+    columns.push_back( code.syndrome( 1u << place ) );
+  }
+  uint num_syndromes = 1u << code.get_parity_check().size();
+  leaders.assign( num_syndromes, 0 );
+  has_leader.assign( num_syndromes, false );
+  has_leader[ 0 ] = true;
+  num_filled = 1;
+  for( uint weight = 1; weight <= code_length and
+         num_filled < num_syndromes; weight++ )
+  {
+    fill( weight, 0, 0, 0 );
+  }
+  has_leader.clear();
+  has_leader.shrink_to_fit();
+}
+
+void SyndromeTableDecoder::fill( uint remaining, uint next, uint pattern,
+                                 uint syndrome )
+{
+  if( remaining == 0 )
+  {
+    if( !has_leader[ syndrome ] )
+    {
+      has_leader[ syndrome ] = true;
+      leaders[ syndrome ] = pattern;
+      num_filled++;
+    }
+    return;
+  }
+  for( uint place = next; place + remaining <= code_length and
+         num_filled < leaders.size(); place++ )
+  {
+    fill( remaining - 1, place + 1, pattern | ( 1u << place ),
+          syndrome ^ columns[ place ] );
+  }
+}
+
+uint SyndromeTableDecoder::decode_word( uint received ) const
+{
+  uint leader = leaders[ code.syndrome( received ) ];
+  if( CodecStats::is_enabled() )
+  {
+    uint corrected = __builtin_popcount( leader );
+    CodecStats::count( WORDS_DECODED );
+    if( corrected > 0 )
+    {
+      CodecStats::count( SYNDROME_TABLE_HITS );
+    }
+    if( corrected > code.get_correction_capability() )
+    {
+      CodecStats::count( DECODE_FAILURES );
+    }
+    else
+    {
+      CodecStats::count( ERRORS_CORRECTED, corrected );
+    }
+  }
+  return received ^ leader;
+}
+
+uint64_t SyndromeTableDecoder::get_table_bytes() const
+{
+  return leaders.size() * sizeof( uint );
+}
+
+/*
+ * how one engine did when the tuner tried it
+ */
+struct EngineTrial
+{
+  DecoderEngine engine;
+  uint64_t bytes;
+  bool tried;
+  bool correct;
+  double nanoseconds_per_word;
+};
+
+/**
+ * A decoder that picks its engine when it is constructed. Each engine
+ * whose memory fits the budget is built, checked on codewords with up
+ * to t + 1 random errors, and timed; the fastest that is correct is
+ * kept and the rest are freed. An engine is correct when it returns
+ * the codeword sent for every word with at most t errors and, since
+ * the engines other than the bounded distance table are complete
+ * nearest neighbor decoders, a codeword as near as the nearest for
+ * every word. The bounded distance table reports failure beyond t, so
+ * it is a candidate only when incomplete decoding is allowed. With a
+ * choice file the pick is kept per code, keyed by n, k and a hash of
+ * the generator matrix, so the benchmark runs once per catalog entry.
+ * @author agent
+ * @version 18 October 2026
+ */
+class TunedDecoder
+{
+public:
+  /**
+   * Constructor choosing and building the engine for a code
+   * @param code the code, which must outlive the decoder
+   * @param memory_budget the most bytes the engine may use
+   * @param choice_file a file of earlier picks to read and add to, or
+   * empty for none
+   * @param allow_incomplete whether or not an engine may fail on
+   * words with more than t errors
+   */
+  TunedDecoder( const LinearCode &code,
+                uint64_t memory_budget = DECODER_MEMORY_BUDGET,
+                const string &choice_file = "",
+                bool allow_incomplete = false );
+
+  /**
+   * Return the engine in use
+   */
+  DecoderEngine get_engine() const;
+
+  /**
+   * put a cache of decoded words in front of the engine, for traffic
+   * where received words recur
+   * @param capacity the most words kept, or 0 for no cache
+   */
+  void set_cache( uint64_t capacity );
+
+  /**
+   * decode a received word
+   * @param received the received word
+   * @return the decoded codeword
+   */
+  uint decode_word( uint received ) const;
+
+  /**
+   * decode a batch of received words. may be called from several
+   * threads at once.
+   * @param received the received words
+   * @param decoded the decoded words, as long as received
+   */
+  void decode_batch( Span< const uint > received,
+                     Span< uint > decoded ) const;
+
+  /**
+   * decode a batch of received words to their messages
+   * @param received the received words
+   * @param messages the decoded messages, as long as received
+   */
+  void decode_message_batch( Span< const uint > received,
+                             Span< uint > messages ) const;
+
+  /**
+   * print each engine's memory, correctness and speed, and the pick,
+   * with the size and latency of the bounded distance table when it
+   * was tried
+   * @param out the stream to print to
+   */
+  void print_report( ostream &out ) const;
+
+private:
+
+  /**
+   * estimate the memory an engine needs for the code
+   * @param engine the engine
+   * @return the bytes
+   */
+  uint64_t estimate_bytes( DecoderEngine engine ) const;
+
+  /**
+   * build an engine, freeing any other
+   * @param engine the engine
+   */
+  void build( DecoderEngine engine );
+
+  /**
+   * decode with an engine that has been built
+   * @param engine the engine
+   * @param received the received word
+   * @return the decoded word
+   */
+  uint decode_with( DecoderEngine engine, uint received ) const;
+
+  /**
+   * build, check and time every engine that fits, and keep the best
+   * @param memory_budget the most bytes an engine may use
+   * @param allow_incomplete whether or not the bounded distance table
+   * is a candidate
+   */
+  void tune( uint64_t memory_budget, bool allow_incomplete );
+
+  /**
+   * Return the key a code's pick is kept under in a choice file
+   */
+  string choice_key() const;
+
+  /**
+   * look a code's pick up in a choice file
+   * @param choice_file the file
+   * @param chosen the pick
+   * @return whether or not there was one
+   */
+  bool load_choice( const string &choice_file,
+                    DecoderEngine &chosen ) const;
+
+  /**
+   * add a code's pick to a choice file
+   * @param choice_file the file
+   */
+  void save_choice( const string &choice_file ) const;
+
+  const LinearCode &code;
+  DecoderEngine engine;
+  vector< EngineTrial > trials;
+  string bounded_report;
+  unique_ptr< SyndromeTableDecoder > table;
+  unique_ptr< BoundedDistanceDecoder > bounded;
+  unique_ptr< CodebookSearch > search;
+  unique_ptr< TrellisDecoder > trellis;
+  unique_ptr< DecodeCache > cache;
+};
+
+TunedDecoder::TunedDecoder( const LinearCode &param_code,
+                            uint64_t memory_budget,
+                            const string &choice_file,
+                            bool allow_incomplete )
+: code( param_code ), engine( ENGINE_COSET_SCAN )
+{
+  TraceScope trace( "decoder tuning" );
+  DecoderEngine chosen;
+  if( choice_file != "" and load_choice( choice_file, chosen ) and
+      estimate_bytes( chosen ) <= memory_budget and
+      ( allow_incomplete or chosen != ENGINE_BOUNDED_DISTANCE ) )
+  {
+    build( chosen );
+    return;
+  }
+
+  tune( memory_budget, allow_incomplete );
+  if( choice_file != "" )
+  {
+    save_choice( choice_file );
+  }
+}
+
+uint64_t TunedDecoder::estimate_bytes( DecoderEngine candidate ) const
+{
+  uint code_length = code.get_code_length();
+  uint64_t num_syndromes = 1ull << code.get_parity_check().size();
+  switch( candidate )
+  {
+  case ENGINE_SYNDROME_TABLE:
+    return num_syndromes * sizeof( uint );
+  case ENGINE_BOUNDED_DISTANCE:
+  {
+    //slots for a load factor of at most one half
+    uint64_t num_patterns = 0;
+    uint64_t choose = 1;
+    for( uint weight = 1; weight <= code.get_correction_capability();
+         weight++ )
+    {
+      choose = choose * ( code_length - weight + 1 ) / weight;
+      num_patterns += choose;
+    }
+    uint64_t num_slots = 16;
+    while( num_slots < 2 * num_patterns )
+    {
+      num_slots <<= 1;
+    }
+    return num_slots * sizeof( uint64_t );
+  }
+  case ENGINE_TRELLIS:
+    //a decision byte per state per depth and two metric vectors, and
+    //none fit past the trellis's own limit
+    if( code.get_parity_check().size() > TRELLIS_MAX_REDUNDANCY )
+    {
+      return UINT64_MAX;
+    }
+    return num_syndromes * ( code_length + 2 * sizeof( float ) );
+  default:
+    //the scans run over the codebook the code already holds
+    return 0;
+  }
+}
+
+void TunedDecoder::build( DecoderEngine candidate )
+{
+  table.reset();
+  bounded.reset();
+  search.reset();
+  trellis.reset();
+  engine = candidate;
+  switch( candidate )
+  {
+  case ENGINE_SYNDROME_TABLE:
+    table.reset( new SyndromeTableDecoder( code ) );
+    break;
+  case ENGINE_BOUNDED_DISTANCE:
+    bounded.reset( new BoundedDistanceDecoder(
+      code, code.get_correction_capability() ) );
+    break;
+  case ENGINE_CODEBOOK_SEARCH:
+    search.reset( new CodebookSearch( code ) );
+    break;
+  case ENGINE_TRELLIS:
+    trellis.reset( new TrellisDecoder( code ) );
+    break;
+  default:
+    break;
+  }
+}
+
+uint TunedDecoder::decode_with( DecoderEngine candidate,
+                                uint received ) const
+{
+  switch( candidate )
+  {
+  case ENGINE_SYNDROME_TABLE:
+    return table->decode_word( received );
+  case ENGINE_BOUNDED_DISTANCE:
+  {
+    uint decoded = received;
+    bounded->decode_word( received, decoded );
+    return decoded;
+  }
+  case ENGINE_CODEBOOK_SEARCH:
+    return search->decode_word( received );
+  case ENGINE_TRELLIS:
+    return trellis->decode_word( received );
+  default:
+    return code.decode_word( received );
+  }
+}
+
+void TunedDecoder::tune( uint64_t memory_budget, bool allow_incomplete )
+{
+  //the trials are not traffic, so they are kept out of the stats,
+  //but only on this thread: others may be decoding meanwhile
+  bool suppressed = CodecStats::is_suppressed();
+  CodecStats::suppress();
+
+  //codewords with 0 to t + 1 random errors, and the distance of each
+  //to its nearest codeword
+  uint code_length = code.get_code_length();
+  uint correctable = code.get_correction_capability();
+  const vector< uint > &code_words = code.get_code_words();
+  mt19937 generator( 1 );
+  vector< uint > sent;
+  vector< uint > received;
+  vector< uint > errors;
+  vector< uint > nearest_distance;
+  vector< uint > decoded( TUNER_SAMPLES );
+  for( uint i = 0; i < TUNER_SAMPLES; i++ )
+  {
+    uint code_word = code_words[ generator() % code_words.size() ];
+    uint num_errors = generator() % ( correctable + 2 );
+    uint pattern = 0;
+    while( static_cast< uint >( __builtin_popcount( pattern ) ) <
+           min( num_errors, code_length ) )
+    {
+      pattern |= 1u << ( generator() % code_length );
+    }
+    sent.push_back( code_word );
+    received.push_back( code_word ^ pattern );
+    errors.push_back( __builtin_popcount( pattern ) );
+    nearest_distance.push_back( __builtin_popcount(
+      code.decode_word( code_word ^ pattern ) ^ code_word ^ pattern ) );
+  }
+
+  double best_time = 0;
+  bool found = false;
+  DecoderEngine best = ENGINE_COSET_SCAN;
+  for( uint e = 0; e < NUM_DECODER_ENGINES; e++ )
+  {
+    DecoderEngine candidate = static_cast< DecoderEngine >( e );
+    EngineTrial trial;
+    trial.engine = candidate;
+    trial.bytes = estimate_bytes( candidate );
+    trial.tried = trial.bytes <= memory_budget and
+      ( allow_incomplete or candidate != ENGINE_BOUNDED_DISTANCE );
+    trial.correct = false;
+    trial.nanoseconds_per_word = 0;
+    if( !trial.tried )
+    {
+      trials.push_back( trial );
+      continue;
+    }
+
+    //decode the samples until they run out or the time is up, so a
+    //slow engine costs no more than the time allowed
+    build( candidate );
+    trial.correct = true;
+    uint decoded_count = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    uint64_t elapsed = 0;
+    while( decoded_count < TUNER_SAMPLES and
+           elapsed < TUNER_TRIAL_NANOSECONDS )
+    {
+      //read the clock once per chunk so it does not dominate the
+      //time of the fast engines
+      uint chunk_end = min( decoded_count + TUNER_CHUNK, TUNER_SAMPLES );
+      for( uint i = decoded_count; i < chunk_end; i++ )
+      {
+        decoded[ i ] = decode_with( candidate, received[ i ] );
+      }
+      elapsed = chrono::duration_cast< chrono::nanoseconds >(
+        chrono::steady_clock::now() - start ).count();
+      decoded_count = chunk_end;
+    }
+    for( uint i = 0; i < decoded_count; i++ )
+    {
+      if( errors[ i ] <= correctable and decoded[ i ] != sent[ i ] )
+      {
+        trial.correct = false;
+      }
+      if( candidate != ENGINE_BOUNDED_DISTANCE and
+          static_cast< uint >( __builtin_popcount( decoded[ i ] ^
+            received[ i ] ) ) != nearest_distance[ i ] )
+      {
+        trial.correct = false;
+      }
+    }
+    trial.nanoseconds_per_word =
+      static_cast< double >( elapsed ) / decoded_count;
+    trials.push_back( trial );
+    if( candidate == ENGINE_BOUNDED_DISTANCE )
+    {
+      //the table is freed unless it is picked, so keep its report
+      ostringstream report;
+      bounded->print_report( report );
+      bounded_report = report.str();
+    }
+
+    if( trial.correct and
+        ( !found or trial.nanoseconds_per_word < best_time ) )
+    {
+      found = true;
+      best = candidate;
+      best_time = trial.nanoseconds_per_word;
+    }
+  }
+
+  build( best );
+  CodecStats::suppress( suppressed );
+}
+
+string TunedDecoder::choice_key() const
+{
+  //fnv-1a over the generator rows
+  uint64_t hash = 14695981039346656037ull;
+  for( uint row : code.get_generator() )
+  {
+    for( uint byte = 0; byte < 4; byte++ )
+    {
+      hash ^= ( row >> ( 8 * byte ) ) & 0xFF;
+      hash *= 1099511628211ull;
+    }
+  }
+  ostringstream key;
+  key << code.get_code_length() << " " << code.get_dimension() << " "
+      << hex << hash;
+  return key.str();
+}
+
+bool TunedDecoder::load_choice( const string &choice_file,
+                                DecoderEngine &chosen ) const
+{
+  ifstream file( choice_file );
+  string key = choice_key();
+  string line;
+  bool found = false;
+
+  //a later line for the same code overrides an earlier one
+  while( getline( file, line ) )
+  {
+    size_t split = line.rfind( ' ' );
+    if( split == string::npos or line.substr( 0, split ) != key )
+    {
+      continue;
+    }
+    string name = line.substr( split + 1 );
+    for( uint e = 0; e < NUM_DECODER_ENGINES; e++ )
+    {
+      if( name == decoder_engine_name( static_cast< DecoderEngine >( e ) ) )
+      {
+        chosen = static_cast< DecoderEngine >( e );
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+void TunedDecoder::save_choice( const string &choice_file ) const
+{
+  ofstream file( choice_file, ios::app );
+  if( !file )
+  {
+    cerr << "could not write the decoder choice to " << choice_file
+         << endl;
+    return;
+  }
+  file << choice_key() << " " << decoder_engine_name( engine ) << endl;
+}
+
+DecoderEngine TunedDecoder::get_engine() const
+{
+  return engine;
+}
+
+void TunedDecoder::set_cache( uint64_t capacity )
+{
+  cache.reset( capacity == 0 ? nullptr : new DecodeCache( capacity ) );
+}
+
+uint TunedDecoder::decode_word( uint received ) const
+{
+  uint decoded;
+  if( cache and cache->lookup( received, decoded ) )
+  {
+    return decoded;
+  }
+  decoded = decode_with( engine, received );
+  if( cache )
+  {
+    cache->insert( received, decoded );
+  }
+  return decoded;
+}
+
+void TunedDecoder::decode_batch( Span< const uint > received,
+                                 Span< uint > decoded ) const
+{
+  if( engine != ENGINE_CODEBOOK_SEARCH )
+  {
+    for( size_t i = 0; i < received.size(); i++ )
+    {
+      decoded[ i ] = decode_word( received[ i ] );
+    }
+    return;
+  }
+  if( !cache )
+  {
+    search->decode_batch( received, decoded );
+    return;
+  }
+  cache->decode_batch( *search, received, decoded );
+}
+
+void TunedDecoder::decode_message_batch( Span< const uint > received,
+                                         Span< uint > messages ) const
+{
+  decode_batch( received, messages );
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    messages[ i ] = code.extract_message( messages[ i ] );
+  }
+}
+
+void TunedDecoder::print_report( ostream &out ) const
+{
+  out << "[" << code.get_code_length() << ", " << code.get_dimension()
+      << "] decoder: " << decoder_engine_name( engine ) << endl;
+  for( const EngineTrial &trial : trials )
+  {
+    out << "  " << decoder_engine_name( trial.engine ) << ": "
+        << trial.bytes << " bytes";
+    if( !trial.tried )
+    {
+      out << ", not tried" << endl;
+      continue;
+    }
+    out << ", " << trial.nanoseconds_per_word << " ns per word"
+        << ( trial.correct ? "" : ", incorrect" ) << endl;
+  }
+  out << bounded_report;
+}
+
+#endif
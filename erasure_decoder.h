@@ -0,0 +1,268 @@
+#ifndef ERASURE_DECODER_H
+#define ERASURE_DECODER_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <climits>
+#include <unordered_map>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "linear_code.h"
+
+using namespace std;
+
+/*
+ * the elimination of the parity check columns at one set of erased
+ * places. reduced[ i ] is a combination of those columns with highest
+ * bit pivot[ i ], and combination[ i ] the erased places it combines.
+ */
+struct ErasureSolver
+{
+  uint erasure_mask;
+  uint rank;
+  bool unique;
+  uint pivot[ 32 ];
+  uint reduced[ 32 ];
+  uint combination[ 32 ];
+};
+
+/**
+ * A decoder for words some of whose places are known to be lost. With
+ * e erasures and no errors, the erased bits x satisfy H_E x = H r,
+ * r the received word with its erased bits cleared and H_E the columns
+ * of H at the erased places; the solution is unique when those columns
+ * are independent, which they are whenever e < d. The columns are
+ * eliminated as in find_rref, but each column is one word, so a row
+ * operation is one xor, and the elimination is kept and reused for
+ * every word of a batch with the same erasures. When the equations
+ * have no solution there are errors too, and the word is decoded to
+ * the codeword nearest it on the places that were not erased, which
+ * is correct when 2 v + e < d for v errors.
+ * @author agent
+ * @version 18 October 2026
+ */
+class ErasureDecoder
+{
+public:
+  /**
+   * Constructor specifying the code
+   * @param code the code, which must outlive the decoder
+   */
+  ErasureDecoder( const LinearCode &code );
+
+  /**
+   * decode a word with erasures
+   * @param received the received word; its erased bits are ignored
+   * @param erasure_mask the erased places
+   * @param decoded the decoded codeword
+   * @return the number of errors corrected outside the erasures, or
+   * -1 if the word cannot be decoded, in which case decoded is the
+   * received word
+   */
+  int decode_word( uint received, uint erasure_mask, uint &decoded ) const;
+
+  /**
+   * decode a batch of words with erasures. the elimination for each
+   * distinct erasure mask is done once per batch. may be called from
+   * several threads at once.
+   * @param received the received words
+   * @param erasure_masks the erased places of each word
+   * @param decoded the decoded words
+   * @param corrected the errors corrected in each word, or -1 where
+   * decoding failed
+   */
+  void decode_batch( Span< const uint > received,
+                     Span< const uint > erasure_masks,
+                     Span< uint > decoded, Span< int > corrected ) const;
+
+  /**
+   * eliminate the parity check columns at a set of erased places
+   * @param erasure_mask the erased places
+   * @param solver the elimination
+   */
+  void build_solver( uint erasure_mask, ErasureSolver &solver ) const;
+
+private:
+
+  /**
+   * decode a word with the elimination of its erasures
+   * @param received the received word
+   * @param solver the elimination of its erasures
+   * @param decoded the decoded codeword
+   * @return the errors corrected, or -1
+   */
+  int decode_with( uint received, const ErasureSolver &solver,
+                   uint &decoded ) const;
+
+  /**
+   * find the codeword nearest a word on the places not erased
+   * @param received the received word
+   * @param erasure_mask the erased places
+   * @param distance the distance on the places not erased
+   * @return the nearest codeword
+   */
+  uint nearest_unerased( uint received, uint erasure_mask,
+                         uint &distance ) const;
+
+  const LinearCode &code;
+  uint code_length;
+  uint word_mask;
+  vector< uint > columns;
+};
+
+ErasureDecoder::ErasureDecoder( const LinearCode &param_code )
+: code( param_code ), code_length( param_code.get_code_length() )
+{
+  word_mask = code_length < 32 ? ( 1u << code_length ) - 1 : UINT_MAX;
+  for( uint place = 0; place < code_length; place++ )
+  {
+    columns.push_back( code.syndrome( 1u << place ) );
+  }
+}
+
+void ErasureDecoder::build_solver( uint erasure_mask,
+                                   ErasureSolver &solver ) const
+{
+  //reduce each erased column by the pivots so far; a column that
+  //reduces to 0 depends on the others, so the erasures are not
+  //determined by the syndrome
+  solver.erasure_mask = erasure_mask & word_mask;
+  solver.rank = 0;
+  solver.unique = true;
+  for( uint rest = solver.erasure_mask; rest != 0; rest &= rest - 1 )
+  {
+    uint place = __builtin_ctz( rest );
+    uint column = columns[ place ];
+    uint combination = 1u << place;
+    for( uint i = 0; i < solver.rank; i++ )
+    {
+      if( ( column >> solver.pivot[ i ] ) & 1 )
+      {
+        column ^= solver.reduced[ i ];
+        combination ^= solver.combination[ i ];
+      }
+    }
+    if( column == 0 )
+    {
+      solver.unique = false;
+      continue;
+    }
+    solver.pivot[ solver.rank ] = 31 - __builtin_clz( column );
+    solver.reduced[ solver.rank ] = column;
+    solver.combination[ solver.rank ] = combination;
+    solver.rank++;
+  }
+}
+
+uint ErasureDecoder::nearest_unerased( uint received, uint erasure_mask,
+                                       uint &distance ) const
+{
+  uint known = ~erasure_mask & word_mask;
+  const vector< uint > &code_words = code.get_code_words();
+  uint nearest = received;
+  distance = UINT_MAX;
+  for( uint i = 0; i < code_words.size(); i++ )
+  {
+    uint this_distance =
+      __builtin_popcount( ( code_words[ i ] ^ received ) & known );
+    if( this_distance < distance )
+    {
+      distance = this_distance;
+      nearest = code_words[ i ];
+    }
+  }
+  return nearest;
+}
+
+int ErasureDecoder::decode_with( uint received, const ErasureSolver &solver,
+                                 uint &decoded ) const
+{
+  uint erasure_mask = solver.erasure_mask;
+  uint cleared = received & ~erasure_mask & word_mask;
+  int corrected = -1;
+  decoded = received;
+
+  //solve H_E x = H r by running the syndrome through the elimination
+  uint remainder = code.syndrome( cleared );
+  uint erased_bits = 0;
+  for( uint i = 0; i < solver.rank; i++ )
+  {
+    if( ( remainder >> solver.pivot[ i ] ) & 1 )
+    {
+      remainder ^= solver.reduced[ i ];
+      erased_bits ^= solver.combination[ i ];
+    }
+  }
+
+  if( remainder == 0 and solver.unique )
+  {
+    decoded = cleared | erased_bits;
+    corrected = 0;
+  }
+  else
+  {
+    //errors as well as erasures. the nearest codeword on the places
+    //not erased is right when twice the errors plus the erasures is
+    //less than the minimum distance
+    uint erasures = __builtin_popcount( erasure_mask );
+    uint distance = 0;
+    uint nearest = nearest_unerased( received, erasure_mask, distance );
+    if( 2 * distance + erasures < code.get_minimum_distance() )
+    {
+      decoded = nearest;
+      corrected = distance;
+    }
+  }
+
+  if( CodecStats::is_enabled() )
+  {
+    CodecStats::count( WORDS_DECODED );
+    if( corrected < 0 )
+    {
+      CodecStats::count( DECODE_FAILURES );
+    }
+    else
+    {
+      CodecStats::count( ERRORS_CORRECTED, corrected );
+    }
+  }
+  return corrected;
+}
+
+int ErasureDecoder::decode_word( uint received, uint erasure_mask,
+                                 uint &decoded ) const
+{
+  ErasureSolver solver;
+  build_solver( erasure_mask, solver );
+  return decode_with( received, solver, decoded );
+}
+
+void ErasureDecoder::decode_batch( Span< const uint > received,
+                                   Span< const uint > erasure_masks,
+                                   Span< uint > decoded,
+                                   Span< int > corrected ) const
+{
+  //one elimination per distinct mask. consecutive words usually
+  //share a mask, so the last one is checked before the cache
+  unordered_map< uint, ErasureSolver > solvers;
+  const ErasureSolver* last = nullptr;
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    uint erasure_mask = erasure_masks[ i ] & word_mask;
+    if( last == nullptr or last->erasure_mask != erasure_mask )
+    {
+      unordered_map< uint, ErasureSolver >::iterator it =
+        solvers.find( erasure_mask );
+      if( it == solvers.end() )
+      {
+        it = solvers.insert( { erasure_mask, ErasureSolver() } ).first;
+        build_solver( erasure_mask, it->second );
+      }
+      last = &it->second;
+    }
+    corrected[ i ] = decode_with( received[ i ], *last, decoded[ i ] );
+  }
+}
+
+#endif
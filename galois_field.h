@@ -0,0 +1,244 @@
+#ifndef GALOIS_FIELD_H
+#define GALOIS_FIELD_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+/**
+ * The finite field GF(2^m), 1 <= m <= 16, with multiplication done
+ * through log and antilog tables. Elements are the integers
+ * 0 .. 2^m - 1, read as polynomials in a root of the field polynomial.
+ * @author agent
+ * @version 18 October 2026
+ */
+class GaloisField
+{
+public:
+  /**
+   * Constructor using a standard primitive polynomial of degree m
+   * @param degree m, the degree of the extension
+   */
+  GaloisField( uint degree );
+
+  /**
+   * Constructor specifying the field polynomial and a primitive
+   * element
+   * @param degree m, the degree of the extension
+   * @param polynomial the field polynomial, including the x^m term
+   * @param primitive_element an element that generates the
+   * multiplicative group
+   */
+  GaloisField( uint degree, uint polynomial, uint primitive_element );
+
+  /**
+   * Return m, the degree of the extension
+   */
+  uint get_degree() const;
+
+  /**
+   * Return the number of elements, 2^m
+   */
+  uint get_size() const;
+
+  /**
+   * Return the field polynomial
+   */
+  uint get_polynomial() const;
+
+  /**
+   * Return the order of the multiplicative group, 2^m - 1
+   */
+  uint get_order() const;
+
+  /**
+   * multiply two elements
+   * @param first the first element
+   * @param second the second element
+   * @return the product
+   */
+  uint multiply( uint first, uint second ) const;
+
+  /**
+   * divide one element by another, nonzero, element
+   * @param dividend the dividend
+   * @param divisor the divisor
+   * @return the quotient
+   */
+  uint divide( uint dividend, uint divisor ) const;
+
+  /**
+   * return the multiplicative inverse of a nonzero element
+   * @param element the element
+   * @return its inverse
+   */
+  uint inverse( uint element ) const;
+
+  /**
+   * return a power of the primitive element
+   * @param exponent the exponent, any nonnegative integer
+   * @return alpha^exponent
+   */
+  uint alpha_power( uint exponent ) const;
+
+  /**
+   * return the discrete log of a nonzero element
+   * @param element the element
+   * @return the exponent e with alpha^e = element
+   */
+  uint log_of( uint element ) const;
+
+  /**
+   * return the antilog table, twice the order long so that the sum
+   * of two logs can be looked up without a reduction
+   */
+  const vector< uint16_t >& get_antilog_table() const;
+
+  /**
+   * return the log table. the log of 0 is undefined and stored as 0.
+   */
+  const vector< uint16_t >& get_log_table() const;
+
+private:
+
+  /**
+   * fill the log and antilog tables
+   */
+  void build_tables();
+
+  uint degree;
+  uint polynomial;
+  uint primitive_element;
+  uint order;
+  vector< uint16_t > antilog_table;
+  vector< uint16_t > log_table;
+};
+
+/*
+ * primitive polynomials of degree 0 .. 16, indexed by degree
+ */
+const uint PRIMITIVE_POLYNOMIALS[ 17 ] =
+{
+  0x1, 0x3, 0x7, 0xB, 0x13, 0x25, 0x43, 0x89, 0x11D, 0x211, 0x409,
+  0x805, 0x1053, 0x201B, 0x4443, 0x8003, 0x1100B
+};
+
+GaloisField::GaloisField( uint param_degree )
+: degree( param_degree ),
+  polynomial( PRIMITIVE_POLYNOMIALS[ param_degree ] ),
+  primitive_element( 2 ), order( ( 1u << param_degree ) - 1 )
+{
+  build_tables();
+}
+
+GaloisField::GaloisField( uint param_degree, uint param_polynomial,
+                          uint param_primitive_element )
+: degree( param_degree ), polynomial( param_polynomial ),
+  primitive_element( param_primitive_element ),
+  order( ( 1u << param_degree ) - 1 )
+{
+  build_tables();
+}
+
+void GaloisField::build_tables()
+{
+  antilog_table.assign( 2 * order + 1, 0 );
+  log_table.assign( order + 1, 0 );
+
+  //walk the powers of the primitive element, multiplying by it
+  //with shift and reduce
+  uint power = 1;
+  for( uint exponent = 0; exponent < order; exponent++ )
+  {
+    antilog_table.at( exponent ) = power;
+    antilog_table.at( exponent + order ) = power;
+    log_table.at( power ) = exponent;
+
+    uint product = 0;
+    uint multiplier = primitive_element;
+    uint shifted = power;
+    while( multiplier != 0 )
+    {
+      if( multiplier & 1 )
+      {
+        product ^= shifted;
+      }
+      multiplier >>= 1;
+      shifted <<= 1;
+      if( shifted & ( 1u << degree ) )
+      {
+        shifted ^= polynomial;
+      }
+    }
+    power = product;
+  }
+  antilog_table.at( 2 * order ) = antilog_table.at( 0 );
+}
+
+uint GaloisField::get_degree() const
+{
+  return degree;
+}
+
+uint GaloisField::get_size() const
+{
+  return order + 1;
+}
+
+uint GaloisField::get_polynomial() const
+{
+  return polynomial;
+}
+
+uint GaloisField::get_order() const
+{
+  return order;
+}
+
+uint GaloisField::multiply( uint first, uint second ) const
+{
+  if( first == 0 or second == 0 )
+  {
+    return 0;
+  }
+  return antilog_table[ log_table[ first ] + log_table[ second ] ];
+}
+
+uint GaloisField::divide( uint dividend, uint divisor ) const
+{
+  if( dividend == 0 )
+  {
+    return 0;
+  }
+  return antilog_table[ log_table[ dividend ] + order
+                        - log_table[ divisor ] ];
+}
+
+uint GaloisField::inverse( uint element ) const
+{
+  return antilog_table[ order - log_table[ element ] ];
+}
+
+uint GaloisField::alpha_power( uint exponent ) const
+{
+  return antilog_table[ exponent % order ];
+}
+
+uint GaloisField::log_of( uint element ) const
+{
+  return log_table[ element ];
+}
+
+const vector< uint16_t >& GaloisField::get_antilog_table() const
+{
+  return antilog_table;
+}
+
+const vector< uint16_t >& GaloisField::get_log_table() const
+{
+  return log_table;
+}
+
+#endif
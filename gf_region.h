@@ -0,0 +1,398 @@
+#ifndef GF_REGION_H
+#define GF_REGION_H
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <immintrin.h>
+#include "bit_kernels.h"
+#include "galois_field.h"
+
+using namespace std;
+
+/*
+ * the tables a region kernel multiplies by one coefficient with. a
+ * byte holds 8 / m packed symbols, and multiplying each of them by a
+ * constant is a linear map of the byte, so it splits into a lookup of
+ * the low nibble and a lookup of the high nibble, or one 8 x 8 bit
+ * matrix for GF2P8AFFINEQB.
+ */
+struct GfCoefficientTables
+{
+  uint coefficient;
+  uint8_t low_table[ 16 ];
+  uint8_t high_table[ 16 ];
+  uint64_t affine_matrix;
+  const uint16_t* log_table;
+  const uint16_t* antilog_table;
+  uint degree;
+};
+
+/*
+ * a kernel adding a constant times a region of packed symbols to
+ * another region
+ */
+typedef void ( *GfRegionKernel )( uint8_t* target, const uint8_t* source,
+                                  size_t length,
+                                  const GfCoefficientTables &tables );
+
+/**
+ * add a constant times a region to another region, symbol by symbol
+ * through the log and antilog tables
+ * @param target the region added to
+ * @param source the region multiplied
+ * @param length the length of the regions in bytes
+ * @param tables the tables of the constant
+ */
+void gf_multiply_add_scalar( uint8_t* target, const uint8_t* source,
+                             size_t length,
+                             const GfCoefficientTables &tables )
+{
+  uint degree = tables.degree;
+  uint symbol_mask = ( 1u << degree ) - 1;
+  uint coefficient_log = tables.log_table[ tables.coefficient ];
+  for( size_t i = 0; i < length; i++ )
+  {
+    uint byte = source[ i ];
+    uint product = 0;
+    for( uint offset = 0; offset < 8; offset += degree )
+    {
+      uint symbol = ( byte >> offset ) & symbol_mask;
+      if( symbol != 0 )
+      {
+        product |= static_cast< uint >( tables.antilog_table[
+          coefficient_log + tables.log_table[ symbol ] ] ) << offset;
+      }
+    }
+    target[ i ] ^= static_cast< uint8_t >( product );
+  }
+}
+
+/**
+ * add a constant times a region to another region, 32 bytes at a time
+ * with two PSHUFB nibble lookups
+ * @param target the region added to
+ * @param source the region multiplied
+ * @param length the length of the regions in bytes
+ * @param tables the tables of the constant
+ */
+__attribute__(( target( "avx2" ) ))
+void gf_multiply_add_avx2( uint8_t* target, const uint8_t* source,
+                           size_t length,
+                           const GfCoefficientTables &tables )
+{
+  const __m256i low_table = _mm256_broadcastsi128_si256( _mm_loadu_si128(
+    reinterpret_cast< const __m128i* >( tables.low_table ) ) );
+  const __m256i high_table = _mm256_broadcastsi128_si256( _mm_loadu_si128(
+    reinterpret_cast< const __m128i* >( tables.high_table ) ) );
+  const __m256i low_nibbles = _mm256_set1_epi8( 0x0F );
+
+  size_t i = 0;
+  for( ; i + 32 <= length; i += 32 )
+  {
+    __m256i x = _mm256_loadu_si256(
+      reinterpret_cast< const __m256i* >( source + i ) );
+    __m256i low = _mm256_and_si256( x, low_nibbles );
+    __m256i high = _mm256_and_si256( _mm256_srli_epi16( x, 4 ), low_nibbles );
+    __m256i product = _mm256_xor_si256(
+      _mm256_shuffle_epi8( low_table, low ),
+      _mm256_shuffle_epi8( high_table, high ) );
+    __m256i* out = reinterpret_cast< __m256i* >( target + i );
+    _mm256_storeu_si256( out, _mm256_xor_si256(
+      _mm256_loadu_si256( out ), product ) );
+  }
+  for( ; i < length; i++ )
+  {
+    target[ i ] ^= tables.low_table[ source[ i ] & 0x0F ] ^
+      tables.high_table[ source[ i ] >> 4 ];
+  }
+}
+
+/**
+ * add a constant times a region to another region, 32 bytes at a time
+ * with one GF2P8AFFINEQB bit matrix multiply
+ * @param target the region added to
+ * @param source the region multiplied
+ * @param length the length of the regions in bytes
+ * @param tables the tables of the constant
+ */
+__attribute__(( target( "gfni,avx2" ) ))
+void gf_multiply_add_gfni( uint8_t* target, const uint8_t* source,
+                           size_t length,
+                           const GfCoefficientTables &tables )
+{
+  const __m256i matrix =
+    _mm256_set1_epi64x( static_cast< long long >( tables.affine_matrix ) );
+
+  size_t i = 0;
+  for( ; i + 32 <= length; i += 32 )
+  {
+    __m256i x = _mm256_loadu_si256(
+      reinterpret_cast< const __m256i* >( source + i ) );
+    __m256i product = _mm256_gf2p8affine_epi64_epi8( x, matrix, 0 );
+    __m256i* out = reinterpret_cast< __m256i* >( target + i );
+    _mm256_storeu_si256( out, _mm256_xor_si256(
+      _mm256_loadu_si256( out ), product ) );
+  }
+  for( ; i < length; i++ )
+  {
+    target[ i ] ^= tables.low_table[ source[ i ] & 0x0F ] ^
+      tables.high_table[ source[ i ] >> 4 ];
+  }
+}
+
+/**
+ * Arithmetic on regions of packed symbols of GF(2^m), m = 1, 2, 4 or
+ * 8, so that a byte holds 8 / m symbols and symbol i of a region is
+ * bits m ( i mod 8 / m ) up of byte i / ( 8 / m ). Adding regions is
+ * xor; multiplying a region by a constant goes through the widest
+ * kernel the processor supports, as bit_kernels.h detects it, with the
+ * per coefficient tables built once. A field of any other degree is
+ * rejected: the region arithmetic is marked invalid and every region
+ * operation leaves its regions as they are.
+ * @author agent
+ * @version 18 October 2026
+ */
+class GfRegion
+{
+public:
+  /**
+   * Constructor building the tables of every coefficient
+   * @param field the field, which must outlive the region arithmetic
+   */
+  GfRegion( const GaloisField &field );
+
+  /**
+   * Return the field
+   */
+  const GaloisField& get_field() const;
+
+  /**
+   * Return whether or not the field's symbols can be packed
+   */
+  bool is_valid() const;
+
+  /**
+   * Return the number of symbols packed in a byte
+   */
+  uint get_symbols_per_byte() const;
+
+  /**
+   * Return the bytes needed to hold a number of packed symbols
+   * @param num_symbols the number of symbols
+   */
+  uint get_packed_bytes( uint num_symbols ) const;
+
+  /**
+   * return a symbol of a packed region
+   * @param region the region
+   * @param place the index of the symbol
+   * @return the symbol
+   */
+  uint get_symbol( const uint8_t* region, uint place ) const;
+
+  /**
+   * set a symbol of a packed region
+   * @param region the region
+   * @param place the index of the symbol
+   * @param value the symbol
+   */
+  void set_symbol( uint8_t* region, uint place, uint value ) const;
+
+  /**
+   * add a constant times one region to another, target += c source
+   * @param target the region added to
+   * @param source the region multiplied
+   * @param coefficient the constant
+   * @param length the length of the regions in bytes
+   */
+  void multiply_add( uint8_t* target, const uint8_t* source,
+                     uint coefficient, size_t length ) const;
+
+  /**
+   * multiply a region by a constant in place
+   * @param region the region
+   * @param coefficient the constant
+   * @param length the length of the region in bytes
+   */
+  void multiply( uint8_t* region, uint coefficient, size_t length ) const;
+
+  /**
+   * Return the name of the kernel in use
+   */
+  const char* get_kernel_name() const;
+
+private:
+
+  /**
+   * multiply each symbol of a byte by a constant
+   * @param coefficient the constant
+   * @param byte the packed symbols
+   * @return the packed products
+   */
+  uint multiply_byte( uint coefficient, uint byte ) const;
+
+  const GaloisField &field;
+  uint degree;
+  bool valid;
+  vector< GfCoefficientTables > coefficient_tables;
+  GfRegionKernel kernel;
+  const char* kernel_name;
+};
+
+GfRegion::GfRegion( const GaloisField &param_field )
+: field( param_field ), degree( param_field.get_degree() ), valid( true ),
+  kernel( gf_multiply_add_scalar ), kernel_name( "scalar" )
+{
+  if( degree != 1 and degree != 2 and degree != 4 and degree != 8 )
+  {
+    cout << "packed regions need m = 1, 2, 4 or 8." << endl;
+    valid = false;
+    kernel_name = "none";
+    return;
+  }
+
+  //bit i of the product is the parity of x with byte 7 - i of the
+  //affine matrix, so that byte gathers bit i of c times each bit of x
+  uint size = 1u << degree;
+  for( uint coefficient = 0; coefficient < size; coefficient++ )
+  {
+    uint64_t matrix = 0;
+    for( uint bit = 0; bit < 8; bit++ )
+    {
+      uint row = 0;
+      for( uint input = 0; input < 8; input++ )
+      {
+        row |= ( ( multiply_byte( coefficient, 1u << input ) >> bit ) & 1 )
+          << input;
+      }
+      matrix |= static_cast< uint64_t >( row ) << ( 8 * ( 7 - bit ) );
+    }
+    GfCoefficientTables tables;
+    tables.coefficient = coefficient;
+
+    //the low and high nibble tables are kept in the entry itself, so a
+    //copy of the region arithmetic points at nothing of the original
+    for( uint nibble = 0; nibble < 16; nibble++ )
+    {
+      tables.low_table[ nibble ] = multiply_byte( coefficient, nibble );
+      tables.high_table[ nibble ] = multiply_byte( coefficient,
+                                                   nibble << 4 );
+    }
+    tables.affine_matrix = matrix;
+    tables.log_table = field.get_log_table().data();
+    tables.antilog_table = field.get_antilog_table().data();
+    tables.degree = degree;
+    coefficient_tables.push_back( tables );
+  }
+
+  //the level honours LINEAR_CODE_ISA like the bit kernels; gfni is
+  //an extension of the avx2 level, as bmi2 is there
+  if( bit_kernels().level >= CPU_AVX2 )
+  {
+    kernel = gf_multiply_add_avx2;
+    kernel_name = "avx2";
+    if( __builtin_cpu_supports( "gfni" ) )
+    {
+      kernel = gf_multiply_add_gfni;
+      kernel_name = "gfni";
+    }
+  }
+}
+
+uint GfRegion::multiply_byte( uint coefficient, uint byte ) const
+{
+  uint symbol_mask = ( 1u << degree ) - 1;
+  uint product = 0;
+  for( uint offset = 0; offset < 8; offset += degree )
+  {
+    product |= field.multiply( coefficient,
+                               ( byte >> offset ) & symbol_mask ) << offset;
+  }
+  return product;
+}
+
+const GaloisField& GfRegion::get_field() const
+{
+  return field;
+}
+
+bool GfRegion::is_valid() const
+{
+  return valid;
+}
+
+uint GfRegion::get_symbols_per_byte() const
+{
+  return 8 / degree;
+}
+
+uint GfRegion::get_packed_bytes( uint num_symbols ) const
+{
+  return ( num_symbols * degree + 7 ) / 8;
+}
+
+uint GfRegion::get_symbol( const uint8_t* region, uint place ) const
+{
+  if( !valid )
+  {
+    return 0;
+  }
+  uint per_byte = 8 / degree;
+  return ( region[ place / per_byte ] >> ( degree * ( place % per_byte ) ) ) &
+    ( ( 1u << degree ) - 1 );
+}
+
+void GfRegion::set_symbol( uint8_t* region, uint place, uint value ) const
+{
+  if( !valid )
+  {
+    return;
+  }
+  uint per_byte = 8 / degree;
+  uint offset = degree * ( place % per_byte );
+  uint mask = ( ( 1u << degree ) - 1 ) << offset;
+  region[ place / per_byte ] = static_cast< uint8_t >(
+    ( region[ place / per_byte ] & ~mask ) | ( ( value << offset ) & mask ) );
+}
+
+void GfRegion::multiply_add( uint8_t* target, const uint8_t* source,
+                             uint coefficient, size_t length ) const
+{
+  if( !valid or coefficient == 0 )
+  {
+    return;
+  }
+  if( coefficient == 1 )
+  {
+    for( size_t i = 0; i < length; i++ )
+    {
+      target[ i ] ^= source[ i ];
+    }
+    return;
+  }
+  kernel( target, source, length, coefficient_tables[ coefficient ] );
+}
+
+void GfRegion::multiply( uint8_t* region, uint coefficient,
+                         size_t length ) const
+{
+  if( !valid )
+  {
+    return;
+  }
+
+  //the kernels add, so multiply a copy into the cleared region
+  static thread_local vector< uint8_t > copy;
+  copy.assign( region, region + length );
+  memset( region, 0, length );
+  multiply_add( region, copy.data(), coefficient, length );
+}
+
+const char* GfRegion::get_kernel_name() const
+{
+  return kernel_name;
+}
+
+#endif
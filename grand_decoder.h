@@ -0,0 +1,583 @@
+#ifndef GRAND_DECODER_H
+#define GRAND_DECODER_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "linear_code.h"
+
+using namespace std;
+
+/*
+ * the fewest candidates of one weight worth spreading across threads
+ */
+const uint64_t GRAND_PARALLEL_THRESHOLD = 1 << 16;
+
+/**
+ * Guessing random additive noise decoding. Error patterns are tried
+ * from most to least likely and the first one that turns the
+ * received word into a codeword is the decoding. Works with any
+ * LinearCode. Hard decisions try the patterns in order of increasing
+ * weight; soft decisions try them in order of the sum of the
+ * reliability ranks of the flipped coordinates (ORBGRAND). The
+ * syndrome of each candidate is the syndrome of its parent pattern
+ * plus one column of the parity check matrix, so every query is a
+ * single xor and compare. Decoding is abandoned after max_queries
+ * patterns, counted one by one.
+ * The patterns of one weight, or one rank sum, are split by their
+ * lowest coordinate, or highest rank, into at most n shares. When
+ * there are enough of them the shares are spread across a pool of
+ * threads started with the decoder. Each share is given the queries
+ * it would have had in order, so the decoding and the point it is
+ * abandoned at are the same on any number of threads.
+ * @author agent
+ * @version 18 October 2026
+ */
+class GrandDecoder
+{
+public:
+  /**
+   * Constructor specifying the code and the abandonment thresholds
+   * @param code the code
+   * @param max_weight the heaviest hard decision pattern tried
+   * @param max_queries the most patterns tried before abandoning
+   * @param num_threads the threads the patterns of one weight are
+   * spread across
+   */
+  GrandDecoder( const LinearCode &code, uint max_weight,
+                uint64_t max_queries, uint num_threads = 1 );
+
+  /**
+   * Destructor stopping the worker threads
+   */
+  ~GrandDecoder();
+
+  /**
+   * decode a hard decision word
+   * @param received the received word
+   * @param decoded the codeword found
+   * @return the weight of the error pattern, or -1 if decoding was
+   * abandoned, in which case decoded is the received word
+   */
+  int decode_word( uint received, uint &decoded ) const;
+
+  /**
+   * decode soft channel output
+   * @param llrs the llr of each coordinate, positive meaning 0,
+   * indexed by place value
+   * @param decoded the codeword found
+   * @return the weight of the error pattern, or -1 if decoding was
+   * abandoned, in which case decoded is the hard decision
+   */
+  int decode_soft( const float* llrs, uint &decoded ) const;
+
+  /**
+   * decode a batch of hard decision words
+   * @param received the received words
+   * @param decoded the decoded words
+   * @param weights the weight of each error pattern, or -1 where
+   * decoding was abandoned
+   */
+  void decode_batch( Span< const uint > received, Span< uint > decoded,
+                     Span< int > weights ) const;
+
+private:
+
+  /**
+   * search the shares of one weight in order, each with the queries
+   * left for it, across the pool when there are enough patterns
+   * @param num_shares the number of shares
+   * @param sizes the number of patterns in each share
+   * @param budget the queries left
+   * @param search_share search a share with at most a given number of
+   * queries, giving the pattern found
+   * @param pattern the first pattern found in order
+   * @return whether or not a pattern was found
+   */
+  bool search_shares( uint num_shares, const uint64_t* sizes,
+                      uint64_t budget,
+                      const function< bool( uint, uint64_t, uint& ) >
+                        &search_share,
+                      uint &pattern ) const;
+
+  /**
+   * extend a partial pattern by coordinates above a given one
+   * @param target the syndrome to match
+   * @param remaining the number of coordinates still to add
+   * @param next the lowest coordinate that may be added
+   * @param partial_syndrome the syndrome of the partial pattern
+   * @param partial_pattern the partial pattern
+   * @param queries the queries left, one taken per pattern tried
+   * @param pattern the pattern found
+   * @return whether or not a pattern was found
+   */
+  bool extend( uint target, uint remaining, uint next,
+               uint partial_syndrome, uint partial_pattern,
+               uint64_t &queries, uint &pattern ) const;
+
+  /**
+   * extend a soft pattern by a rank below the last one added
+   * @param target the syndrome to match
+   * @param remaining the logistic weight still to spend
+   * @param below the ranks added must be less than this
+   * @param order the coordinates by increasing reliability
+   * @param partial_syndrome the syndrome of the partial pattern
+   * @param partial_pattern the partial pattern
+   * @param queries the queries left, one taken per pattern tried
+   * @param pattern the pattern found
+   * @return whether or not a pattern was found
+   */
+  bool extend_soft( uint target, uint remaining, uint below,
+                    const uint* order, uint partial_syndrome,
+                    uint partial_pattern, uint64_t &queries,
+                    uint &pattern ) const;
+
+  /**
+   * the number of ways to choose coordinates
+   * @param from the coordinates to choose from
+   * @param chosen the number chosen
+   * @return from choose chosen
+   */
+  uint64_t choose( uint from, uint chosen ) const;
+
+  /**
+   * the number of sets of distinct ranks, each at most a bound, with
+   * a given sum
+   * @param most the bound
+   * @param sum the sum
+   * @return the number of sets
+   */
+  uint64_t num_rank_sets( uint most, uint sum ) const;
+
+  /**
+   * run a job on every thread of the pool and the caller, as thread
+   * 0, and wait for all of them
+   * @param job the job, given the index of its thread
+   */
+  void run_on_pool( const function< void( uint ) > &job ) const;
+
+  /**
+   * wait for jobs and run them until the decoder is destroyed
+   * @param thread_index the index of this thread
+   */
+  void work( uint thread_index );
+
+  const LinearCode &code;
+  uint code_length;
+  uint max_weight;
+  uint64_t max_queries;
+  uint num_threads;
+  vector< uint > columns;
+  uint most_rank_sum;
+  vector< uint64_t > rank_sets;
+  vector< thread > workers;
+  mutable mutex search_lock;
+  mutable mutex pool_lock;
+  mutable condition_variable job_ready;
+  mutable condition_variable job_done;
+  mutable const function< void( uint ) >* pool_job;
+  mutable uint64_t job_generation;
+  mutable uint workers_busy;
+  bool stopping;
+};
+
+GrandDecoder::GrandDecoder( const LinearCode &param_code,
+                            uint param_max_weight,
+                            uint64_t param_max_queries,
+                            uint param_num_threads )
+: code( param_code ), code_length( param_code.get_code_length() ),
+  max_weight( param_max_weight ), max_queries( param_max_queries ),
+  num_threads( min( max( param_num_threads, 1u ), 32u ) ),
+  pool_job( nullptr ), job_generation( 0 ), workers_busy( 0 ),
+  stopping( false )
+{
+  //the syndrome of the unit word at a coordinate is the column of
+  //the parity check matrix there
+  for( uint place = 0; place < code_length; place++ )
+  {
+    columns.push_back( code.syndrome( 1u << place ) );
+  }
+
+  //the sets of distinct ranks up to m summing to s, with or without m
+  most_rank_sum = code_length * ( code_length + 1 ) / 2;
+  rank_sets.assign( ( code_length + 1 ) * ( most_rank_sum + 1 ), 0 );
+  rank_sets[ 0 ] = 1;
+  for( uint most = 1; most <= code_length; most++ )
+  {
+    for( uint sum = 0; sum <= most_rank_sum; sum++ )
+    {
+      rank_sets[ most * ( most_rank_sum + 1 ) + sum ] =
+        num_rank_sets( most - 1, sum ) +
+        ( sum >= most ? num_rank_sets( most - 1, sum - most ) : 0 );
+    }
+  }
+
+  for( uint t = 1; t < num_threads; t++ )
+  {
+    workers.push_back( thread( &GrandDecoder::work, this, t ) );
+  }
+}
+
+GrandDecoder::~GrandDecoder()
+{
+  {
+    lock_guard< mutex > guard( pool_lock );
+    stopping = true;
+  }
+  job_ready.notify_all();
+  for( thread &worker : workers )
+  {
+    worker.join();
+  }
+}
+
+void GrandDecoder::work( uint thread_index )
+{
+  uint64_t seen = 0;
+  while( true )
+  {
+    const function< void( uint ) >* job;
+    {
+      unique_lock< mutex > guard( pool_lock );
+      job_ready.wait( guard, [ & ]()
+      {
+        return stopping or job_generation != seen;
+      } );
+      if( stopping )
+      {
+        return;
+      }
+      seen = job_generation;
+      job = pool_job;
+    }
+    ( *job )( thread_index );
+    {
+      lock_guard< mutex > guard( pool_lock );
+      workers_busy--;
+    }
+    job_done.notify_one();
+  }
+}
+
+void GrandDecoder::run_on_pool( const function< void( uint ) > &job ) const
+{
+  {
+    lock_guard< mutex > guard( pool_lock );
+    pool_job = &job;
+    workers_busy = workers.size();
+    job_generation++;
+  }
+  job_ready.notify_all();
+  job( 0 );
+  unique_lock< mutex > guard( pool_lock );
+  job_done.wait( guard, [ this ]()
+  {
+    return workers_busy == 0;
+  } );
+}
+
+uint64_t GrandDecoder::choose( uint from, uint chosen ) const
+{
+  if( chosen > from )
+  {
+    return 0;
+  }
+  uint64_t count = 1;
+  for( uint i = 0; i < chosen; i++ )
+  {
+    count = count * ( from - i ) / ( i + 1 );
+  }
+  return count;
+}
+
+uint64_t GrandDecoder::num_rank_sets( uint most, uint sum ) const
+{
+  if( sum > most_rank_sum )
+  {
+    return 0;
+  }
+  return rank_sets[ most * ( most_rank_sum + 1 ) + sum ];
+}
+
+bool GrandDecoder::extend( uint target, uint remaining, uint next,
+                           uint partial_syndrome, uint partial_pattern,
+                           uint64_t &queries, uint &pattern ) const
+{
+  if( remaining == 0 )
+  {
+    queries--;
+    if( partial_syndrome == target )
+    {
+      pattern = partial_pattern;
+      return true;
+    }
+    return false;
+  }
+  for( uint place = next; place + remaining <= code_length and queries > 0;
+       place++ )
+  {
+    if( extend( target, remaining - 1, place + 1,
+                partial_syndrome ^ columns[ place ],
+                partial_pattern | ( 1u << place ), queries, pattern ) )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool GrandDecoder::search_shares( uint num_shares, const uint64_t* sizes,
+                                  uint64_t budget,
+                                  const function< bool( uint, uint64_t,
+                                                        uint& ) >
+                                    &search_share,
+                                  uint &pattern ) const
+{
+  //share i may try the patterns of the budget left after the shares
+  //before it
+  uint64_t allowed[ 32 ];
+  uint64_t total = 0;
+  for( uint i = 0; i < num_shares; i++ )
+  {
+    allowed[ i ] = min( sizes[ i ], budget - min( budget, total ) );
+    total += sizes[ i ];
+  }
+
+  if( num_threads == 1 or min( total, budget ) < GRAND_PARALLEL_THRESHOLD )
+  {
+    for( uint i = 0; i < num_shares; i++ )
+    {
+      if( allowed[ i ] > 0 and search_share( i, allowed[ i ], pattern ) )
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //thread t takes shares t, t + T, t + 2T, ... the answer is the
+  //match in the earliest share, so a thread stops once an earlier
+  //share has one
+  atomic< uint > best_share( UINT_MAX );
+  uint found[ 32 ];
+  function< void( uint ) > job = [ & ]( uint thread_index )
+  {
+    for( uint i = thread_index; i < num_shares; i += num_threads )
+    {
+      if( i > best_share.load( memory_order_relaxed ) )
+      {
+        return;
+      }
+      uint candidate = 0;
+      if( allowed[ i ] > 0 and search_share( i, allowed[ i ], candidate ) )
+      {
+        found[ i ] = candidate;
+        uint current = best_share.load();
+        while( i < current and
+               !best_share.compare_exchange_weak( current, i ) )
+        {
+        }
+        return;
+      }
+    }
+  };
+  {
+    lock_guard< mutex > guard( search_lock );
+    run_on_pool( job );
+  }
+
+  uint best = best_share.load();
+  if( best == UINT_MAX )
+  {
+    return false;
+  }
+  pattern = found[ best ];
+  return true;
+}
+
+int GrandDecoder::decode_word( uint received, uint &decoded ) const
+{
+  uint target = code.syndrome( received );
+  int weight = -1;
+  uint pattern = 0;
+  uint64_t queries = 1;
+  if( target == 0 )
+  {
+    weight = 0;
+  }
+  for( uint w = 1; weight < 0 and w <= max_weight and w <= code_length and
+         queries < max_queries; w++ )
+  {
+    //share f holds the patterns whose lowest coordinate is f, which
+    //come before those of f + 1 in lexicographic order
+    uint num_shares = code_length - w + 1;
+    uint64_t sizes[ 32 ];
+    for( uint first = 0; first < num_shares; first++ )
+    {
+      sizes[ first ] = choose( code_length - 1 - first, w - 1 );
+    }
+    uint64_t budget = max_queries - queries;
+    if( search_shares( num_shares, sizes, budget,
+                       [ & ]( uint first, uint64_t allowed, uint &found )
+                       {
+                         return extend( target, w - 1, first + 1,
+                                        columns[ first ], 1u << first,
+                                        allowed, found );
+                       }, pattern ) )
+    {
+      weight = w;
+    }
+    queries += min( budget, choose( code_length, w ) );
+  }
+
+  decoded = weight < 0 ? received : received ^ pattern;
+  if( CodecStats::is_enabled() )
+  {
+    CodecStats::count( WORDS_DECODED );
+    if( weight < 0 )
+    {
+      CodecStats::count( DECODE_FAILURES );
+    }
+    else
+    {
+      CodecStats::count( ERRORS_CORRECTED, weight );
+    }
+  }
+  return weight;
+}
+
+bool GrandDecoder::extend_soft( uint target, uint remaining, uint below,
+                                const uint* order, uint partial_syndrome,
+                                uint partial_pattern, uint64_t &queries,
+                                uint &pattern ) const
+{
+  if( remaining == 0 )
+  {
+    queries--;
+    if( partial_syndrome == target )
+    {
+      pattern = partial_pattern;
+      return true;
+    }
+    return false;
+  }
+
+  //add distinct ranks in decreasing order. the ranks still to add
+  //are all below this one, so it must be at least the remainder
+  //less the most those can sum to
+  for( uint rank = min( remaining, below - 1 ); rank >= 1 and queries > 0;
+       rank-- )
+  {
+    uint most_below = rank * ( rank - 1 ) / 2;
+    if( rank + most_below < remaining )
+    {
+      break;
+    }
+    uint place = order[ rank - 1 ];
+    if( extend_soft( target, remaining - rank, rank, order,
+                     partial_syndrome ^ columns[ place ],
+                     partial_pattern | ( 1u << place ), queries,
+                     pattern ) )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+int GrandDecoder::decode_soft( const float* llrs, uint &decoded ) const
+{
+  //the hard decision, and the coordinates from least to most
+  //reliable
+  uint hard_decision = 0;
+  uint order[ 32 ];
+  for( uint place = 0; place < code_length; place++ )
+  {
+    if( llrs[ place ] < 0 )
+    {
+      hard_decision |= 1u << place;
+    }
+    order[ place ] = place;
+  }
+  sort( order, order + code_length, [ llrs ]( uint first, uint second )
+  {
+    return fabs( llrs[ first ] ) < fabs( llrs[ second ] );
+  } );
+
+  uint target = code.syndrome( hard_decision );
+  int weight = -1;
+  uint pattern = 0;
+  uint64_t queries = 1;
+  if( target == 0 )
+  {
+    weight = 0;
+  }
+
+  //the logistic weight of a pattern is the sum of its ranks. share i
+  //holds the patterns whose highest rank is top - i, tried in that
+  //order
+  for( uint logistic = 1; weight < 0 and logistic <= most_rank_sum and
+         queries < max_queries; logistic++ )
+  {
+    uint top = min( logistic, code_length );
+    uint64_t sizes[ 32 ];
+    uint64_t total = 0;
+    for( uint i = 0; i < top; i++ )
+    {
+      uint rank = top - i;
+      sizes[ i ] = num_rank_sets( rank - 1, logistic - rank );
+      total += sizes[ i ];
+    }
+    uint64_t budget = max_queries - queries;
+    if( search_shares( top, sizes, budget,
+                       [ & ]( uint share, uint64_t allowed, uint &found )
+                       {
+                         uint rank = top - share;
+                         uint place = order[ rank - 1 ];
+                         return extend_soft( target, logistic - rank, rank,
+                                             order, columns[ place ],
+                                             1u << place, allowed, found );
+                       }, pattern ) )
+    {
+      weight = __builtin_popcount( pattern );
+    }
+    queries += min( budget, total );
+  }
+
+  decoded = weight < 0 ? hard_decision : hard_decision ^ pattern;
+  if( CodecStats::is_enabled() )
+  {
+    CodecStats::count( WORDS_DECODED );
+    if( weight < 0 )
+    {
+      CodecStats::count( DECODE_FAILURES );
+    }
+    else
+    {
+      CodecStats::count( ERRORS_CORRECTED, weight );
+    }
+  }
+  return weight;
+}
+
+void GrandDecoder::decode_batch( Span< const uint > received,
+                                 Span< uint > decoded,
+                                 Span< int > weights ) const
+{
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    weights[ i ] = decode_word( received[ i ], decoded[ i ] );
+  }
+}
+
+#endif
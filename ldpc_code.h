@@ -0,0 +1,638 @@
+#ifndef LDPC_CODE_H
+#define LDPC_CODE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "long_word.h"
+#include "word_span.h"
+#include "codec_stats.h"
+
+using namespace std;
+
+/*
+ * the number of frames the min-sum decoder runs together, one per lane
+ */
+const uint LDPC_LANES = 16;
+
+/*
+ * the largest magnitude of a check to bit message
+ */
+const int LDPC_MAX_MESSAGE = 127;
+
+/**
+ * A parity check matrix stored sparsely, both by row (CSR) and by
+ * column (CSC). Row i of the dense matrix has ones at
+ * column_indices[ row_offsets[ i ] .. row_offsets[ i + 1 ] ), and each
+ * of those entries is an edge of the Tanner graph, numbered by its
+ * position in column_indices. The column view lists, for each
+ * coordinate, the rows that check it and the edge joining them.
+ * @author agent
+ * @version 18 October 2026
+ */
+class SparseParityCheck
+{
+public:
+  /**
+   * Constructor from the rows of a dense parity check matrix, in the
+   * uint layout LinearCode uses
+   * @param parity_check the rows of the parity check matrix
+   * @param code_length the length of the code
+   */
+  SparseParityCheck( const vector< uint > &parity_check,
+                     uint code_length );
+
+  /**
+   * Constructor from the rows of a dense parity check matrix of
+   * long words
+   * @param parity_check the rows of the parity check matrix
+   * @param code_length the length of the code
+   */
+  SparseParityCheck( const vector< LongWord > &parity_check,
+                     uint code_length );
+
+  /**
+   * create a random ( column weight, row weight ) regular parity
+   * check matrix by Gallager's construction: the first band of rows
+   * covers the coordinates in order, and every other band is a random
+   * column permutation of it
+   * @param code_length the length of the code, a multiple of the row
+   * weight
+   * @param column_weight the number of checks on each coordinate
+   * @param row_weight the number of coordinates in each check
+   * @param seed the seed of the permutations
+   * @return the parity check matrix
+   */
+  static SparseParityCheck gallager( uint code_length, uint column_weight,
+                                     uint row_weight, uint seed );
+
+  /**
+   * Return the code length
+   */
+  uint get_code_length() const;
+
+  /**
+   * Return the number of checks
+   */
+  uint get_num_checks() const;
+
+  /**
+   * Return the number of edges, the number of ones in the matrix
+   */
+  uint get_num_edges() const;
+
+  /**
+   * Return the largest number of coordinates in one check
+   */
+  uint get_max_row_weight() const;
+
+  /**
+   * Return the start of each row's edges, one more than the checks
+   */
+  const vector< uint >& get_row_offsets() const;
+
+  /**
+   * Return the coordinate of each edge, grouped by row
+   */
+  const vector< uint >& get_column_indices() const;
+
+  /**
+   * Return the start of each coordinate's entries in the column view
+   */
+  const vector< uint >& get_column_offsets() const;
+
+  /**
+   * Return the check of each entry in the column view
+   */
+  const vector< uint >& get_row_indices() const;
+
+  /**
+   * Return the edge of each entry in the column view
+   */
+  const vector< uint >& get_column_edges() const;
+
+  /**
+   * Return the dense rows, for finding a generator matrix
+   */
+  vector< LongWord > to_dense() const;
+
+  /**
+   * determine if a word satisfies every check
+   * @param word the word
+   * @return whether or not it is a codeword
+   */
+  bool is_code_word( const LongWord &word ) const;
+
+private:
+
+  /**
+   * Constructor for an empty matrix, filled in by the factories
+   */
+  SparseParityCheck();
+
+  /**
+   * build the column view from the row view
+   */
+  void build_columns();
+
+  uint code_length;
+  uint max_row_weight;
+  vector< uint > row_offsets;
+  vector< uint > column_indices;
+  vector< uint > column_offsets;
+  vector< uint > row_indices;
+  vector< uint > column_edges;
+};
+
+/**
+ * A layered min-sum belief propagation decoder. Check messages are
+ * 8 bit fixed point log likelihood ratios, positive for a 0, and the
+ * offset min-sum update subtracts one from every check message. The
+ * posteriors are 16 bit, wide enough to hold the channel llr plus
+ * every check message of a coordinate.
+ * LDPC_LANES frames are decoded together, stored lane-innermost so
+ * every check update is a run of independent lane operations that an
+ * optimized build vectorizes. A frame that satisfies every check is frozen
+ * while the others go on, so it decodes as it would alone. Decoding
+ * stops once every frame satisfies every check, or after the
+ * iteration cap.
+ * @author agent
+ * @version 18 October 2026
+ */
+class LdpcDecoder
+{
+public:
+  /**
+   * Constructor specifying the parity check matrix, which is copied
+   * so the decoder may outlive it
+   * @param parity_check the sparse parity check matrix
+   * @param max_iterations the iteration cap
+   */
+  LdpcDecoder( const SparseParityCheck &parity_check,
+               uint max_iterations );
+
+  /**
+   * decode a batch of frames from their channel llrs. may be called
+   * from several threads at once; each thread keeps its own scratch
+   * space, which grows once.
+   * @param llrs the llr of every coordinate of every frame, frame
+   * after frame, positive meaning 0
+   * @param decoded the hard decision of each frame
+   * @param iterations the iterations each frame took, or -1 where the
+   * cap was reached with checks still failing
+   */
+  void decode_batch( Span< const int8_t > llrs, Span< LongWord > decoded,
+                     Span< int > iterations ) const;
+
+  /**
+   * decode a batch of hard decision words, each bit given the same
+   * llr magnitude
+   * @param received the received words
+   * @param decoded the decoded words
+   * @param iterations the iterations each word took, or -1 on failure
+   * @param magnitude the llr magnitude of a received bit
+   */
+  void decode_hard_batch( Span< const LongWord > received,
+                          Span< LongWord > decoded,
+                          Span< int > iterations,
+                          int8_t magnitude = 16 ) const;
+
+private:
+
+  /**
+   * decode up to LDPC_LANES frames
+   * @param llrs the llrs of the first frame
+   * @param count the number of frames
+   * @param decoded the decoded frames
+   * @param iterations the iterations of each frame
+   */
+  void decode_lanes( const int8_t* llrs, uint count, LongWord* decoded,
+                     int* iterations ) const;
+
+  SparseParityCheck parity_check;
+  uint max_iterations;
+};
+
+SparseParityCheck::SparseParityCheck()
+: code_length( 0 ), max_row_weight( 0 )
+{
+}
+
+SparseParityCheck::SparseParityCheck( const vector< uint > &parity_check,
+                                      uint param_code_length )
+: code_length( param_code_length ), max_row_weight( 0 )
+{
+  row_offsets.push_back( 0 );
+  for( uint row = 0; row < parity_check.size(); row++ )
+  {
+    for( uint col = 0; col < code_length; col++ )
+    {
+      if( ( parity_check.at( row ) >> col ) & 1 )
+      {
+        column_indices.push_back( col );
+      }
+    }
+    row_offsets.push_back( column_indices.size() );
+  }
+  build_columns();
+}
+
+SparseParityCheck::SparseParityCheck(
+  const vector< LongWord > &parity_check, uint param_code_length )
+: code_length( param_code_length ), max_row_weight( 0 )
+{
+  row_offsets.push_back( 0 );
+  for( uint row = 0; row < parity_check.size(); row++ )
+  {
+    for( uint col = 0; col < code_length; col++ )
+    {
+      if( get_bit( parity_check.at( row ), col ) )
+      {
+        column_indices.push_back( col );
+      }
+    }
+    row_offsets.push_back( column_indices.size() );
+  }
+  build_columns();
+}
+
+SparseParityCheck SparseParityCheck::gallager( uint code_length,
+                                               uint column_weight,
+                                               uint row_weight,
+                                               uint seed )
+{
+  SparseParityCheck matrix;
+  matrix.code_length = code_length;
+  mt19937 generator( seed );
+
+  uint rows_per_band = code_length / row_weight;
+  vector< uint > permutation( code_length );
+  for( uint col = 0; col < code_length; col++ )
+  {
+    permutation.at( col ) = col;
+  }
+
+  matrix.row_offsets.push_back( 0 );
+  for( uint band = 0; band < column_weight; band++ )
+  {
+    if( band > 0 )
+    {
+      shuffle( permutation.begin(), permutation.end(), generator );
+    }
+    for( uint row = 0; row < rows_per_band; row++ )
+    {
+      vector< uint > columns;
+      for( uint place = 0; place < row_weight; place++ )
+      {
+        columns.push_back( permutation.at( row * row_weight + place ) );
+      }
+      sort( columns.begin(), columns.end() );
+      for( uint col : columns )
+      {
+        matrix.column_indices.push_back( col );
+      }
+      matrix.row_offsets.push_back( matrix.column_indices.size() );
+    }
+  }
+  matrix.build_columns();
+  return matrix;
+}
+
+void SparseParityCheck::build_columns()
+{
+  //count the entries of each column, then place each edge
+  max_row_weight = 0;
+  column_offsets.assign( code_length + 1, 0 );
+  for( uint row = 0; row + 1 < row_offsets.size(); row++ )
+  {
+    max_row_weight = max( max_row_weight,
+                          row_offsets.at( row + 1 ) - row_offsets.at( row ) );
+    for( uint edge = row_offsets.at( row ); edge < row_offsets.at( row + 1 );
+         edge++ )
+    {
+      column_offsets.at( column_indices.at( edge ) + 1 )++;
+    }
+  }
+  for( uint col = 0; col < code_length; col++ )
+  {
+    column_offsets.at( col + 1 ) += column_offsets.at( col );
+  }
+
+  row_indices.assign( column_indices.size(), 0 );
+  column_edges.assign( column_indices.size(), 0 );
+  vector< uint > next_entry( column_offsets.begin(),
+                             column_offsets.end() - 1 );
+  for( uint row = 0; row + 1 < row_offsets.size(); row++ )
+  {
+    for( uint edge = row_offsets.at( row ); edge < row_offsets.at( row + 1 );
+         edge++ )
+    {
+      uint entry = next_entry.at( column_indices.at( edge ) )++;
+      row_indices.at( entry ) = row;
+      column_edges.at( entry ) = edge;
+    }
+  }
+}
+
+uint SparseParityCheck::get_code_length() const
+{
+  return code_length;
+}
+
+uint SparseParityCheck::get_num_checks() const
+{
+  return row_offsets.size() - 1;
+}
+
+uint SparseParityCheck::get_num_edges() const
+{
+  return column_indices.size();
+}
+
+uint SparseParityCheck::get_max_row_weight() const
+{
+  return max_row_weight;
+}
+
+const vector< uint >& SparseParityCheck::get_row_offsets() const
+{
+  return row_offsets;
+}
+
+const vector< uint >& SparseParityCheck::get_column_indices() const
+{
+  return column_indices;
+}
+
+const vector< uint >& SparseParityCheck::get_column_offsets() const
+{
+  return column_offsets;
+}
+
+const vector< uint >& SparseParityCheck::get_row_indices() const
+{
+  return row_indices;
+}
+
+const vector< uint >& SparseParityCheck::get_column_edges() const
+{
+  return column_edges;
+}
+
+vector< LongWord > SparseParityCheck::to_dense() const
+{
+  vector< LongWord > rows;
+  for( uint row = 0; row < get_num_checks(); row++ )
+  {
+    LongWord dense_row = new_long_word( code_length );
+    for( uint edge = row_offsets.at( row ); edge < row_offsets.at( row + 1 );
+         edge++ )
+    {
+      flip_bit( dense_row, column_indices.at( edge ) );
+    }
+    rows.push_back( dense_row );
+  }
+  return rows;
+}
+
+bool SparseParityCheck::is_code_word( const LongWord &word ) const
+{
+  for( uint row = 0; row < get_num_checks(); row++ )
+  {
+    uint parity = 0;
+    for( uint edge = row_offsets[ row ]; edge < row_offsets[ row + 1 ];
+         edge++ )
+    {
+      parity ^= get_bit( word, column_indices[ edge ] );
+    }
+    if( parity != 0 )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+LdpcDecoder::LdpcDecoder( const SparseParityCheck &param_parity_check,
+                          uint param_max_iterations )
+: parity_check( param_parity_check ),
+  max_iterations( param_max_iterations )
+{
+}
+
+void LdpcDecoder::decode_lanes( const int8_t* llrs, uint count,
+                                LongWord* decoded, int* iterations ) const
+{
+  uint code_length = parity_check.get_code_length();
+  uint num_checks = parity_check.get_num_checks();
+  const uint* row_offsets = parity_check.get_row_offsets().data();
+  const uint* column_indices = parity_check.get_column_indices().data();
+
+  //per thread scratch: the posterior of every coordinate, the check
+  //to bit message of every edge and the bit to check messages of the
+  //row being updated, all lane-innermost
+  static thread_local vector< int16_t > posterior;
+  static thread_local vector< int8_t > messages;
+  static thread_local vector< int16_t > row_inputs;
+  posterior.resize( code_length * LDPC_LANES );
+  messages.assign( parity_check.get_num_edges() * LDPC_LANES, 0 );
+  row_inputs.resize( parity_check.get_max_row_weight() * LDPC_LANES );
+
+  for( uint col = 0; col < code_length; col++ )
+  {
+    for( uint lane = 0; lane < LDPC_LANES; lane++ )
+    {
+      posterior[ col * LDPC_LANES + lane ] = lane < count ?
+        llrs[ lane * code_length + col ] : LDPC_MAX_MESSAGE;
+    }
+  }
+
+  int lane_iterations[ LDPC_LANES ];
+  for( uint lane = 0; lane < LDPC_LANES; lane++ )
+  {
+    lane_iterations[ lane ] = -1;
+  }
+
+  for( uint iteration = 0; iteration <= max_iterations; iteration++ )
+  {
+    //check the hard decisions of every lane before each iteration
+    uint8_t failing[ LDPC_LANES ] = { 0 };
+    for( uint row = 0; row < num_checks; row++ )
+    {
+      uint8_t parity[ LDPC_LANES ] = { 0 };
+      for( uint edge = row_offsets[ row ]; edge < row_offsets[ row + 1 ];
+           edge++ )
+      {
+        const int16_t* bit = &posterior[ column_indices[ edge ] * LDPC_LANES ];
+        for( uint lane = 0; lane < LDPC_LANES; lane++ )
+        {
+          parity[ lane ] ^= bit[ lane ] < 0;
+        }
+      }
+      for( uint lane = 0; lane < LDPC_LANES; lane++ )
+      {
+        failing[ lane ] |= parity[ lane ];
+      }
+    }
+    bool all_done = true;
+    for( uint lane = 0; lane < LDPC_LANES; lane++ )
+    {
+      if( !failing[ lane ] and lane_iterations[ lane ] < 0 )
+      {
+        lane_iterations[ lane ] = iteration;
+      }
+      if( lane < count and lane_iterations[ lane ] < 0 )
+      {
+        all_done = false;
+      }
+    }
+    if( all_done or iteration == max_iterations )
+    {
+      break;
+    }
+
+    //a lane that has converged keeps its messages and posterior, so
+    //what it decodes to does not depend on the lanes beside it
+    uint8_t frozen[ LDPC_LANES ];
+    for( uint lane = 0; lane < LDPC_LANES; lane++ )
+    {
+      frozen[ lane ] = lane_iterations[ lane ] >= 0;
+    }
+
+    //one layer per check: remove the old check message, find the two
+    //least magnitudes and the sign product, and add the new message
+    for( uint row = 0; row < num_checks; row++ )
+    {
+      uint first_edge = row_offsets[ row ];
+      uint row_weight = row_offsets[ row + 1 ] - first_edge;
+      int min1[ LDPC_LANES ];
+      int min2[ LDPC_LANES ];
+      int min1_place[ LDPC_LANES ];
+      int sign[ LDPC_LANES ];
+      for( uint lane = 0; lane < LDPC_LANES; lane++ )
+      {
+        min1[ lane ] = LDPC_MAX_MESSAGE;
+        min2[ lane ] = LDPC_MAX_MESSAGE;
+        min1_place[ lane ] = -1;
+        sign[ lane ] = 0;
+      }
+
+      for( uint place = 0; place < row_weight; place++ )
+      {
+        uint edge = first_edge + place;
+        int16_t* bit = &posterior[ column_indices[ edge ] * LDPC_LANES ];
+        const int8_t* old_message = &messages[ edge * LDPC_LANES ];
+        int16_t* input = &row_inputs[ place * LDPC_LANES ];
+        for( uint lane = 0; lane < LDPC_LANES; lane++ )
+        {
+          //the posterior stays the exact sum of the channel llr and
+          //the check messages; only the magnitude sent to the check
+          //saturates, so removing an old message never flips a sign
+          int value = bit[ lane ] - old_message[ lane ];
+          input[ lane ] = static_cast< int16_t >( value );
+          int magnitude = min( value < 0 ? -value : value,
+                               LDPC_MAX_MESSAGE );
+          sign[ lane ] ^= value < 0;
+          bool new_min1 = magnitude < min1[ lane ];
+          min2[ lane ] = new_min1 ? min1[ lane ] :
+            min( min2[ lane ], magnitude );
+          min1_place[ lane ] = new_min1 ?
+            static_cast< int >( place ) : min1_place[ lane ];
+          min1[ lane ] = new_min1 ? magnitude : min1[ lane ];
+        }
+      }
+
+      for( uint place = 0; place < row_weight; place++ )
+      {
+        uint edge = first_edge + place;
+        int16_t* bit = &posterior[ column_indices[ edge ] * LDPC_LANES ];
+        int8_t* message = &messages[ edge * LDPC_LANES ];
+        const int16_t* input = &row_inputs[ place * LDPC_LANES ];
+        for( uint lane = 0; lane < LDPC_LANES; lane++ )
+        {
+          int magnitude = min1_place[ lane ] == static_cast< int >( place ) ?
+            min2[ lane ] : min1[ lane ];
+          magnitude = max( magnitude - 1, 0 );
+          int negative = sign[ lane ] ^ ( input[ lane ] < 0 );
+          int new_message = negative ? -magnitude : magnitude;
+          message[ lane ] = frozen[ lane ] ? message[ lane ] :
+            static_cast< int8_t >( new_message );
+          bit[ lane ] = static_cast< int16_t >( input[ lane ] +
+                                                message[ lane ] );
+        }
+      }
+    }
+  }
+
+  for( uint lane = 0; lane < count; lane++ )
+  {
+    LongWord &word = decoded[ lane ];
+    word.assign( ( code_length + 63 ) / 64, 0 );
+    uint errors = 0;
+    for( uint col = 0; col < code_length; col++ )
+    {
+      if( posterior[ col * LDPC_LANES + lane ] < 0 )
+      {
+        set_bit( word, col );
+      }
+      errors += ( posterior[ col * LDPC_LANES + lane ] < 0 ) !=
+        ( llrs[ lane * code_length + col ] < 0 );
+    }
+    iterations[ lane ] = lane_iterations[ lane ];
+
+    if( CodecStats::is_enabled() )
+    {
+      CodecStats::count( WORDS_DECODED );
+      if( lane_iterations[ lane ] < 0 )
+      {
+        CodecStats::count( DECODE_FAILURES );
+      }
+      else
+      {
+        CodecStats::count( ERRORS_CORRECTED, errors );
+      }
+    }
+  }
+}
+
+void LdpcDecoder::decode_batch( Span< const int8_t > llrs,
+                                Span< LongWord > decoded,
+                                Span< int > iterations ) const
+{
+  uint code_length = parity_check.get_code_length();
+  for( size_t first = 0; first < decoded.size(); first += LDPC_LANES )
+  {
+    uint count = min< size_t >( LDPC_LANES, decoded.size() - first );
+    decode_lanes( llrs.data() + first * code_length, count,
+                  decoded.data() + first, iterations.data() + first );
+  }
+}
+
+void LdpcDecoder::decode_hard_batch( Span< const LongWord > received,
+                                     Span< LongWord > decoded,
+                                     Span< int > iterations,
+                                     int8_t magnitude ) const
+{
+  uint code_length = parity_check.get_code_length();
+  static thread_local vector< int8_t > llrs;
+  llrs.resize( LDPC_LANES * code_length );
+  for( size_t first = 0; first < received.size(); first += LDPC_LANES )
+  {
+    uint count = min< size_t >( LDPC_LANES, received.size() - first );
+    for( uint lane = 0; lane < count; lane++ )
+    {
+      for( uint col = 0; col < code_length; col++ )
+      {
+        llrs[ lane * code_length + col ] =
+          get_bit( received[ first + lane ], col ) ? -magnitude : magnitude;
+      }
+    }
+    decode_lanes( llrs.data(), count, decoded.data() + first,
+                  iterations.data() + first );
+  }
+}
+
+#endif
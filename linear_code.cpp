@@ -1,6 +1,7 @@
 /* A program to model a linear code over a finite field 
  * F of dimension n and order q, where n is variable and q is
- * restricted to 2. 
+ * restricted to 2. Codes over GF(4), GF(16) and GF(256) are in
+ * qary_code.h.
  * @author Jared Allen
  * @date November 21, 2018
  */ 
@@ -12,7 +13,20 @@
 #include <vector>
 #include <climits>
 #include <algorithm>
+#include <cstring>
+#include <memory>
+#include "codec_stats.h"
+#include "trace.h"
+#include "bit_kernels.h"
 #include "linear_code.h"
+#include "codebook_search.h"
+#include "decode_cache.h"
+#include "codec_server.h"
+#include "adaptive_code.h"
+#include "scrubber.h"
+#include "product_code.h"
+#include "pipeline.h"
+#include "code_search.h"
 #include "noisy_channel.h"
 #include "mapping.h"
 
@@ -24,7 +38,7 @@ using namespace std;
  * @param number the number we are looking for the index of
  * @return the index 
  */
-uint index_of( vector< uint > vector, uint number );
+uint index_of( const vector< uint > &vector, uint number );
 
 /* A function to implement the Gauss-Jordan algorithm, which
  * puts a code matrix in rref
@@ -39,7 +53,7 @@ vector< uint > find_rref( vector< uint > code_matrix,
  * @param code_matrix the code matrix
  * @param code_length the length of the code words
  */
-void print_bitwise( vector< uint > code_matrix,
+void print_bitwise( const vector< uint > &code_matrix,
                        uint code_length );
 
 /* A function to determine the transpose of a code matrix
@@ -47,7 +61,7 @@ void print_bitwise( vector< uint > code_matrix,
  * @param code_length the length of the code words
  * @return the transpose of the matrix
  */
-vector< uint > find_transpose( vector< uint > code_matrix,
+vector< uint > find_transpose( const vector< uint > &code_matrix,
                                uint code_length );
 
 /* A function to find a simple exponent
@@ -65,19 +79,22 @@ uint find_power( uint base, uint exponent );
  * @return the new matrix 
  */
 vector< uint > permute_columns( vector< uint > &code_matrix,
-                                uint code_length, vector< uint > permutation );
+                                uint code_length,
+                                const vector< uint > &permutation );
 
 /* A function to determine the parity check matrix
  * for a code.
  * @param g_permuted G' as in Ling & Xing 4.3
  * @param code_length the length of the code
  * @param permutation the permutation to be reversed
+ * @param verbose whether or not to print the steps
  * @return the parity check matrix
  */
-vector< uint > find_pc_matrix( vector< uint > g_permuted,
-                               vector< uint > rref_matrix,
+vector< uint > find_pc_matrix( const vector< uint > &g_permuted,
+                               const vector< uint > &rref_matrix,
                                uint code_length,
-                               vector< uint > permutation );
+                               const vector< uint > &permutation,
+                               bool verbose = true );
 
 /* A function to determine the necessary permutation
  * to create G', as described in algorithm 4.3.
@@ -85,7 +102,7 @@ vector< uint > find_pc_matrix( vector< uint > g_permuted,
  * @param code_length the length of the code
  * @return the necessary permutation
  */
-vector< uint > find_permutation( vector< uint > code_matrix,
+vector< uint > find_permutation( const vector< uint > &code_matrix,
                                  uint code_length );
 
 /* A function to determine if a code matrix is the 
@@ -94,7 +111,7 @@ vector< uint > find_permutation( vector< uint > code_matrix,
  * @param code_length the length of the code
  * @return whether or not it is the identity
  */
-bool is_identity( vector< uint > code_matrix,
+bool is_identity( const vector< uint > &code_matrix,
                   uint code_length );
 
 /* A function to determine G, the k x n matrix
@@ -103,12 +120,54 @@ bool is_identity( vector< uint > code_matrix,
  * @param code_length the length of the code
  * @return the matrix G
  */
-vector< uint > find_g_matrix( vector< uint > code_matrix,
+vector< uint > find_g_matrix( const vector< uint > &code_matrix,
                               uint code_length );
 
+/* A function to construct the linear code spanned by a subset
+ * of F without printing the steps, as the server does.
+ * @param subset_of_F the subset of F
+ * @param code_length the length of the code
+ * @return the linear code
+ */
+LinearCode construct_code( const vector< uint > &subset_of_F,
+                           uint code_length );
+
+/* A function to read a code length and a subset of F from a file
+ * @param file_name the name of the file
+ * @param subset_of_F the subset of F read
+ * @param code_length the length of the code read
+ * @return whether or not a code was read
+ */
+bool read_code_file( const string &file_name, vector< uint > &subset_of_F,
+                     uint &code_length );
+
+/* A function to run a link whose channel drifts through a range of
+ * bit error rates, letting the adaptive codec pick the code for each
+ * block, and print the code used and the goodput
+ * @param codec the adaptive codec, with its catalog built
+ */
+void run_adaptive_link( AdaptiveCodec &codec );
+
+/* A function to send blocks of a product code through bursts of
+ * growing length, laid along the rows as they are sent, and print the
+ * blocks the row code alone and the product decode right, and the
+ * speed of the product decode
+ * @param product the product code
+ * @param row_code its row code
+ * @param num_threads the threads the blocks are decoded on
+ */
+void run_product_link( const ProductCode &product,
+                       const LinearCode &row_code, uint num_threads );
+
+/* A function to print the codec stats on stderr when they were asked
+ * for
+ * @param stats_format "json", "text", or "" for none
+ */
+void print_stats( const string &stats_format );
+
 
 
-uint index_of( vector< uint > vector, uint number )
+uint index_of( const vector< uint > &vector, uint number )
 {
   ptrdiff_t pos =
     find( vector.begin(), vector.end(), number ) - vector.begin();
@@ -124,7 +183,7 @@ uint index_of( vector< uint > vector, uint number )
 
 
 
-bool is_identity( vector< uint > code_matrix,
+bool is_identity( const vector< uint > &code_matrix,
                   uint code_length )
 {
   bool the_identity = true;
@@ -148,7 +207,7 @@ bool is_identity( vector< uint > code_matrix,
 }
 
 
-vector< uint > find_g_matrix( vector< uint > code_matrix,
+vector< uint > find_g_matrix( const vector< uint > &code_matrix,
                               uint code_length )
 {
   //determine G, the k x n matrix of nonzero rows. 
@@ -170,7 +229,7 @@ vector< uint > find_g_matrix( vector< uint > code_matrix,
   return g_matrix;
 }
 
-vector< uint > find_permutation( vector< uint > g_matrix,
+vector< uint > find_permutation( const vector< uint > &g_matrix,
                                  uint code_length )
 {
   //find transpose of matrix
@@ -209,11 +268,14 @@ vector< uint > find_permutation( vector< uint > g_matrix,
 }
 
 
-vector< uint > find_pc_matrix( vector< uint > g_permuted,
-                               vector< uint > rref_matrix,
+vector< uint > find_pc_matrix( const vector< uint > &g_permuted,
+                               const vector< uint > &rref_matrix,
                                uint code_length,
-                               vector< uint > permutation )
+                               const vector< uint > &permutation,
+                               bool verbose )
 {
+  TraceScope trace( "parity check construction" );
+
   //find transposes of appropriate matrices
   vector< uint > gp_transpose =
     find_transpose( g_permuted, code_length  );
@@ -229,8 +291,11 @@ vector< uint > find_pc_matrix( vector< uint > g_permuted,
   }
   
 
-  cout << "the matrix X^T " << endl;
-  print_bitwise( x_matrix, g_permuted.size());
+  if( verbose )
+  {
+    cout << "the matrix X^T " << endl;
+    print_bitwise( x_matrix, g_permuted.size());
+  }
 
   //create H', which is (-X^T | I_( n - k ) )
   uint num_redundant = code_length - g_permuted.size();
@@ -242,8 +307,11 @@ vector< uint > find_pc_matrix( vector< uint > g_permuted,
 
   vector< uint > hp_matrix = x_matrix;
 
+  if( verbose )
+  {
     cout << "the H' form of the matrix" << endl;
-  print_bitwise( hp_matrix, code_length );
+    print_bitwise( hp_matrix, code_length );
+  }
 
   //transform the hp matrix into the h matrix
   //determine reverse permutation from rref_transpose and
@@ -262,34 +330,36 @@ vector< uint > find_pc_matrix( vector< uint > g_permuted,
   }
 
   /* output permutations */
-
-  cout << "permutation: " << endl;
-  for( uint col : permutation )
+  if( verbose )
   {
-    cout << col << " ";
-  }
-  cout << endl;
+    cout << "permutation: " << endl;
+    for( uint col : permutation )
+    {
+      cout << col << " ";
+    }
+    cout << endl;
 
-  for( uint i = 0; i < permutation.size(); i++ )
-  {
-    cout << i << " ";
-  }
-  cout << endl;
-  cout << endl;
+    for( uint i = 0; i < permutation.size(); i++ )
+    {
+      cout << i << " ";
+    }
+    cout << endl;
+    cout << endl;
 
-  cout << "reverse permutation: " << endl;
-  for( uint col : reverse_permutation )
-  {
-    cout << col << " ";
-  }
-  cout << endl;
+    cout << "reverse permutation: " << endl;
+    for( uint col : reverse_permutation )
+    {
+      cout << col << " ";
+    }
+    cout << endl;
 
-  for( uint i = 0; i < permutation.size(); i++ )
-  {
-    cout << i << " ";
+    for( uint i = 0; i < permutation.size(); i++ )
+    {
+      cout << i << " ";
+    }
+    cout << endl;
+    cout << endl;
   }
-  cout << endl;
-  cout << endl;
 
   /* end output permutations */
     
@@ -304,7 +374,7 @@ vector< uint > find_pc_matrix( vector< uint > g_permuted,
 
 vector< uint > permute_columns( vector< uint > &code_matrix,
                                 uint code_length,
-                                vector< uint > permutation )
+                                const vector< uint > &permutation )
 {
   //find transpose of code matrix
   vector< uint > cm_transpose = find_transpose(
@@ -348,12 +418,24 @@ uint find_power( uint base, uint exponent )
   }
 }
 
-vector< uint > find_transpose( vector< uint > code_matrix,
+vector< uint > find_transpose( const vector< uint > &code_matrix,
                                uint code_length )
 {
   vector< uint > code_matrix_transpose;
   uint new_code_length = 0;
 
+  //a row of the transpose packs a bit per row of the matrix, so up
+  //to 32 rows go through the transpose kernel, last row lowest
+  if( code_matrix.size() <= 32 )
+  {
+    vector< uint > reversed( code_matrix.rbegin(), code_matrix.rend() );
+    vector< uint > columns( code_length );
+    bit_kernels().transpose( reversed.data(), reversed.size(), code_length,
+                             columns.data() );
+    code_matrix_transpose.assign( columns.rbegin(), columns.rend() );
+    return code_matrix_transpose;
+  }
+
   //initialize the transpose matrix
   for( uint col = code_length; col != 0; col-- )
   {
@@ -386,7 +468,7 @@ vector< uint > find_transpose( vector< uint > code_matrix,
 }
       
 
-void print_bitwise( vector< uint > code_matrix, uint code_length )
+void print_bitwise( const vector< uint > &code_matrix, uint code_length )
 {
   //find and print the bitwise representation of code_matrix
   for( uint i = 0; i < code_matrix.size(); i++ )
@@ -411,6 +493,7 @@ void print_bitwise( vector< uint > code_matrix, uint code_length )
 
 vector< uint > find_rref( vector< uint > code_matrix, uint code_size)
 {
+  TraceScope trace( "rref" );
   uint row = 0;
   uint col_offset = 1;
   bool in_rref = false;
@@ -449,40 +532,11 @@ vector< uint > find_rref( vector< uint > code_matrix, uint code_size)
     if( next_row < code_matrix.size() and col != UINT_MAX )
     {
       //switch row with the next row that has a nonzero pivot
-    
-      uint first_row_switch = code_matrix.at( row );
-      uint second_row_switch = code_matrix.at( next_row );
-      vector< uint > new_matrix;
-      for( uint i = 0; i < code_matrix.size(); i++ )
-      {
-        if( i != row and i != next_row )
-        {
-          new_matrix.push_back( code_matrix.at( i ) );
-        }
-        else if( i == row )
-        {
-          new_matrix.push_back( second_row_switch );
-        }
-        else
-        {
-          new_matrix.push_back( first_row_switch );
-        }
-      }
-      code_matrix = new_matrix;
+      swap( code_matrix.at( row ), code_matrix.at( next_row ) );
       
       //eliminate all other entries in the j-th column
-      for( uint i = 0; i < code_matrix.size(); i++ )
-      {        
-        if( i != row )
-        {
-          uint this_col = ( code_matrix.at( i ) >> col ) & 1;
-          if( this_col == 1 )
-          {
-            code_matrix.at( i ) = code_matrix.at( row ) ^
-              code_matrix.at( i );
-          }
-        }
-      }
+      bit_kernels().eliminate( code_matrix.data(), code_matrix.size(),
+                               row, 1u << col );
       row++;
       col_offset++;
     }
@@ -511,9 +565,526 @@ vector< uint > find_rref( vector< uint > code_matrix, uint code_size)
   return code_matrix;
 }
 
+LinearCode construct_code( const vector< uint > &subset_of_F,
+                           uint code_length )
+{
+  vector< uint > matrix_rref = find_rref( subset_of_F, code_length );
+  vector< uint > g_matrix = find_g_matrix( matrix_rref, code_length );
+
+  //G = I is its own information set and has no parity checks
+  if( is_identity( g_matrix, code_length ) )
+  {
+    return LinearCode( g_matrix, vector< uint >(), code_length );
+  }
+
+  vector< uint > permutation = find_permutation( g_matrix, code_length );
+  vector< uint > g_permuted = g_matrix;
+  permute_columns( g_permuted, code_length, permutation );
+  vector< uint > parity_check_matrix = find_pc_matrix(
+    g_permuted, matrix_rref, code_length, permutation, false );
+
+  LinearCode this_code = LinearCode( g_matrix, parity_check_matrix,
+                                     code_length );
+  this_code.set_information_set( permutation );
+  return this_code;
+}
+
 
-int main()
+bool read_code_file( const string &file_name, vector< uint > &subset_of_F,
+                     uint &code_length )
 {
+  ifstream code_file( file_name );
+  uint subset_element;
+  code_length = 0;
+  code_file >> code_length;
+  while( code_file >> subset_element )
+  {
+    subset_of_F.push_back( subset_element );
+  }
+  if( code_length == 0 or subset_of_F.empty() )
+  {
+    cerr << "could not read a code from " << file_name << endl;
+    return false;
+  }
+  return true;
+}
+
+void run_adaptive_link( AdaptiveCodec &codec )
+{
+  //the channel gets worse and then better again, a few blocks at a
+  //time at each bit error rate
+  const double CHANNEL_RATES[] = { 0.001, 0.01, 0.03, 0.08, 0.03, 0.01,
+                                   0.001 };
+  const uint BLOCKS_PER_RATE = 8;
+  const uint BLOCK_WORDS = 256;
+
+  srand( time( NULL ) );
+  vector< uint > messages( BLOCK_WORDS );
+  vector< uint > encoded( BLOCK_WORDS );
+  vector< uint > decoded( BLOCK_WORDS );
+  uint64_t channel_bits = 0;
+  uint64_t good_bits = 0;
+  uint64_t words_wrong = 0;
+  uint64_t words_sent = 0;
+
+  cout << "channel  estimate  code" << endl;
+  for( double channel_rate : CHANNEL_RATES )
+  {
+    for( uint block = 0; block < BLOCKS_PER_RATE; block++ )
+    {
+      const LinearCode &code = codec.get_code( codec.get_current() );
+      uint dimension = code.get_dimension();
+      for( uint i = 0; i < BLOCK_WORDS; i++ )
+      {
+        messages[ i ] = rand() % find_power( 2, dimension );
+      }
+      codec.encode_block( messages, encoded );
+      binary_symmetric_noise( encoded, code.get_code_length(),
+                              channel_rate );
+      codec.decode_block( encoded, decoded );
+
+      for( uint i = 0; i < BLOCK_WORDS; i++ )
+      {
+        if( decoded[ i ] == messages[ i ] )
+        {
+          good_bits += dimension;
+        }
+        else
+        {
+          words_wrong++;
+        }
+      }
+      words_sent += BLOCK_WORDS;
+      channel_bits += BLOCK_WORDS * code.get_code_length();
+
+      if( block == 0 )
+      {
+        cout << channel_rate << "  " << codec.get_error_rate() << "  ["
+             << code.get_code_length() << ", " << dimension << "]" << endl;
+      }
+      codec.end_block();
+    }
+  }
+
+  cout << "words decoded wrong: " << words_wrong << " of " << words_sent
+       << endl;
+  cout << "goodput: " << static_cast< double >( good_bits ) / channel_bits
+       << " message bits per channel bit" << endl;
+}
+
+void run_product_link( const ProductCode &product,
+                       const LinearCode &row_code, uint num_threads )
+{
+  const uint NUM_BLOCKS = 4096;
+  uint block_words = product.get_block_words();
+  uint message_words = product.get_message_words();
+  uint row_length = row_code.get_code_length();
+  uint row_messages = find_power( 2, row_code.get_dimension() );
+
+  srand( time( NULL ) );
+  vector< uint > messages( NUM_BLOCKS * message_words );
+  vector< uint > sent( NUM_BLOCKS * block_words );
+  for( uint i = 0; i < messages.size(); i++ )
+  {
+    messages[ i ] = rand() % row_messages;
+  }
+  for( uint b = 0; b < NUM_BLOCKS; b++ )
+  {
+    product.encode_block(
+      Span< const uint >( &messages[ b * message_words ], message_words ),
+      Span< uint >( &sent[ b * block_words ], block_words ) );
+  }
+
+  cout << "[" << product.get_code_length() << ", "
+       << product.get_dimension() << ", "
+       << product.get_minimum_distance() << "] product code" << endl;
+  cout << "burst  rows alone  product  Mbit/s" << endl;
+  vector< uint > received( sent.size() );
+  vector< uint > row_decoded( sent.size() );
+  vector< uint > decoded_messages( message_words );
+  for( uint burst = 0; burst <= 2 * row_length; burst += row_length / 2 )
+  {
+    //one burst per block, starting anywhere in the block as sent
+    received = sent;
+    for( uint b = 0; b < NUM_BLOCKS; b++ )
+    {
+      uint start = rand() % ( block_words * row_length - burst + 1 );
+      for( uint bit = start; bit < start + burst; bit++ )
+      {
+        received[ b * block_words + bit / row_length ] ^=
+          1u << ( bit % row_length );
+      }
+    }
+
+    row_code.decode_batch( received, row_decoded );
+    uint rows_right = 0;
+    for( uint b = 0; b < NUM_BLOCKS; b++ )
+    {
+      rows_right += equal( &row_decoded[ b * block_words ],
+                           &row_decoded[ ( b + 1 ) * block_words ],
+                           &sent[ b * block_words ] );
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    product.decode_blocks( received, num_threads );
+    chrono::duration< double > elapsed =
+      chrono::steady_clock::now() - start;
+    uint product_right = 0;
+    for( uint b = 0; b < NUM_BLOCKS; b++ )
+    {
+      product.extract_block(
+        Span< const uint >( &received[ b * block_words ], block_words ),
+        decoded_messages );
+      product_right += equal( decoded_messages.begin(),
+                              decoded_messages.end(),
+                              &messages[ b * message_words ] );
+    }
+    cout << burst << "  " << rows_right << "  " << product_right << "  "
+         << NUM_BLOCKS * product.get_dimension() / elapsed.count() / 1e6
+         << endl;
+  }
+  cout << "blocks sent per burst: " << NUM_BLOCKS << endl;
+}
+
+void print_stats( const string &stats_format )
+{
+  if( stats_format == "json" )
+  {
+    CodecStats::print_json( cerr );
+  }
+  else if( stats_format != "" )
+  {
+    CodecStats::print_text( cerr );
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  //parse the options. --stats=text or --stats=json reports the
+  //codec counters and stage timings on stderr when the run ends.
+  //--trace=<file> writes a Chrome trace of the run to the file.
+  //--serve keeps the codes of each --code=<file> resident and serves
+  //requests on stdin and stdout, or --serve=<path> on a socket.
+  //--decode-cache=<entries> keeps that many decoded words, for
+  //traffic where the same received words recur.
+  //--decoder-choices=<file> keeps the decoder tuned for each served
+  //code, so the tuning runs once per code.
+  //--incomplete-decoding lets the served codes and the scrubber pick
+  //a decoder that gives up on words more than t from the code.
+  //--scrub=<file> checks and corrects a file of codewords of the
+  //first --code=<file> in place, on --threads=<n> threads, held to
+  //--scrub-rate=<bytes per second> and --scrub-cpu=<share>, keeping
+  //its place in --checkpoint=<file>.
+  //--pipeline runs the message through concurrent stages instead of
+  //one after another, decoding on --threads=<n> threads;
+  //--pipeline=<file> sends another message file.
+  //--product runs bursts through the product of the first two
+  //--code=<file> codes, rows then columns, on --threads=<n> threads.
+  //--search=<n>,<k> looks for a good [n, k] code on --threads=<n>
+  //threads, making --candidates=<count> by --search-method=random,
+  //greedy or lexicode from --seed=<seed>, keeping the best --keep=<m>
+  //and writing the best to --search-out=<file>. it keeps its place in
+  //--checkpoint=<file>.
+  //--adaptive=<target> runs a drifting link over the --code=<file>
+  //catalog, switching codes to meet the target word error rate.
+  string stats_format = "";
+  bool serve = false;
+  bool product = false;
+  string pipeline_file = "";
+  uint num_threads = 1;
+  double adaptive_target = 0;
+  string choice_file = "";
+  bool allow_incomplete = false;
+  uint64_t cache_capacity = 0;
+  string scrub_path = "";
+  uint search_length = 0;
+  uint search_dimension = 0;
+  string search_out = "";
+  SearchOptions search_options = { SEARCH_RANDOM, 100000, 1, 1,
+                                   static_cast< uint >( time( NULL ) ), "" };
+  ScrubOptions scrub_options = { 1, 0, 1.0, "" };
+  string socket_path = "";
+  vector< string > code_files;
+  for( int arg = 1; arg < argc; arg++ )
+  {
+    if( strncmp( argv[ arg ], "--stats=", 8 ) == 0 )
+    {
+      stats_format = argv[ arg ] + 8;
+      CodecStats::enable();
+    }
+    else if( strncmp( argv[ arg ], "--trace=", 8 ) == 0 )
+    {
+      Trace::enable( argv[ arg ] + 8 );
+    }
+    else if( strcmp( argv[ arg ], "--serve" ) == 0 )
+    {
+      serve = true;
+    }
+    else if( strncmp( argv[ arg ], "--serve=", 8 ) == 0 )
+    {
+      serve = true;
+      socket_path = argv[ arg ] + 8;
+    }
+    else if( strcmp( argv[ arg ], "--pipeline" ) == 0 )
+    {
+      pipeline_file = "alice_message.txt";
+    }
+    else if( strncmp( argv[ arg ], "--pipeline=", 11 ) == 0 )
+    {
+      pipeline_file = argv[ arg ] + 11;
+    }
+    else if( strncmp( argv[ arg ], "--search=", 9 ) == 0 )
+    {
+      if( sscanf( argv[ arg ] + 9, "%u,%u", &search_length,
+                  &search_dimension ) != 2 )
+      {
+        cerr << "--search takes <n>,<k>" << endl;
+        return 1;
+      }
+    }
+    else if( strncmp( argv[ arg ], "--search-method=", 16 ) == 0 )
+    {
+      string method = argv[ arg ] + 16;
+      if( method == "random" )
+      {
+        search_options.method = SEARCH_RANDOM;
+      }
+      else if( method == "greedy" )
+      {
+        search_options.method = SEARCH_GREEDY;
+      }
+      else if( method == "lexicode" )
+      {
+        search_options.method = SEARCH_LEXICODE;
+      }
+      else
+      {
+        cerr << "unknown search method " << method << endl;
+        return 1;
+      }
+    }
+    else if( strncmp( argv[ arg ], "--candidates=", 13 ) == 0 )
+    {
+      search_options.num_candidates = strtoull( argv[ arg ] + 13,
+                                                nullptr, 10 );
+    }
+    else if( strncmp( argv[ arg ], "--keep=", 7 ) == 0 )
+    {
+      search_options.num_kept = max( atoi( argv[ arg ] + 7 ), 1 );
+    }
+    else if( strncmp( argv[ arg ], "--seed=", 7 ) == 0 )
+    {
+      search_options.seed = strtoul( argv[ arg ] + 7, nullptr, 10 );
+    }
+    else if( strncmp( argv[ arg ], "--search-out=", 13 ) == 0 )
+    {
+      search_out = argv[ arg ] + 13;
+    }
+    else if( strcmp( argv[ arg ], "--product" ) == 0 )
+    {
+      product = true;
+    }
+    else if( strncmp( argv[ arg ], "--scrub=", 8 ) == 0 )
+    {
+      scrub_path = argv[ arg ] + 8;
+    }
+    else if( strncmp( argv[ arg ], "--threads=", 10 ) == 0 )
+    {
+      num_threads = max( atoi( argv[ arg ] + 10 ), 1 );
+    }
+    else if( strncmp( argv[ arg ], "--scrub-rate=", 13 ) == 0 )
+    {
+      scrub_options.bytes_per_second = strtoull( argv[ arg ] + 13,
+                                                 nullptr, 10 );
+    }
+    else if( strncmp( argv[ arg ], "--scrub-cpu=", 12 ) == 0 )
+    {
+      scrub_options.cpu_share = atof( argv[ arg ] + 12 );
+    }
+    else if( strncmp( argv[ arg ], "--checkpoint=", 13 ) == 0 )
+    {
+      scrub_options.checkpoint_path = argv[ arg ] + 13;
+      search_options.checkpoint_path = argv[ arg ] + 13;
+    }
+    else if( strncmp( argv[ arg ], "--decode-cache=", 15 ) == 0 )
+    {
+      cache_capacity = strtoull( argv[ arg ] + 15, nullptr, 10 );
+    }
+    else if( strncmp( argv[ arg ], "--decoder-choices=", 18 ) == 0 )
+    {
+      choice_file = argv[ arg ] + 18;
+    }
+    else if( strcmp( argv[ arg ], "--incomplete-decoding" ) == 0 )
+    {
+      allow_incomplete = true;
+    }
+    else if( strncmp( argv[ arg ], "--adaptive=", 11 ) == 0 )
+    {
+      adaptive_target = atof( argv[ arg ] + 11 );
+      if( adaptive_target <= 0 )
+      {
+        cerr << "--adaptive needs a target above 0" << endl;
+        return 1;
+      }
+    }
+    else if( strncmp( argv[ arg ], "--code=", 7 ) == 0 )
+    {
+      code_files.push_back( argv[ arg ] + 7 );
+    }
+  }
+
+  if( serve )
+  {
+    //build every code once, then serve until the input closes
+    CodecServer server;
+    for( const string &file_name : code_files )
+    {
+      vector< uint > subset_of_F;
+      uint code_length = 0;
+      if( !read_code_file( file_name, subset_of_F, code_length ) )
+      {
+        return 1;
+      }
+      server.add_code( construct_code( subset_of_F, code_length ),
+                       choice_file, cache_capacity, allow_incomplete );
+    }
+    if( stats_format != "" )
+    {
+      server.print_decoders( cerr );
+    }
+    if( server.get_num_codes() == 0 )
+    {
+      cerr << "--serve needs at least one --code=<file>" << endl;
+      return 1;
+    }
+
+    if( socket_path == "" )
+    {
+      server.serve_stream( STDIN_FILENO, STDOUT_FILENO );
+    }
+    else if( server.serve_socket( socket_path.c_str() ) < 0 )
+    {
+      return 1;
+    }
+
+    print_stats( stats_format );
+    return 0;
+  }
+
+  if( scrub_path != "" )
+  {
+    vector< uint > subset_of_F;
+    uint code_length = 0;
+    if( code_files.empty() )
+    {
+      cerr << "--scrub needs the --code=<file> of the data" << endl;
+      return 1;
+    }
+    if( !read_code_file( code_files[ 0 ], subset_of_F, code_length ) )
+    {
+      return 1;
+    }
+    LinearCode code = construct_code( subset_of_F, code_length );
+    CodeScrubber scrubber( code, allow_incomplete );
+    if( stats_format != "" )
+    {
+      scrubber.print_decoder( cerr );
+    }
+    scrub_options.num_threads = num_threads;
+    ScrubReport report = scrubber.scrub( scrub_path, scrub_options );
+    cout << "scrubbed " << report.words_scanned << " words from offset "
+         << report.resumed_from << ": " << report.words_corrected
+         << " corrected (" << report.bits_corrected << " bits), "
+         << report.uncorrectable.size() << " uncorrectable" << endl;
+    print_stats( stats_format );
+    return report.completed and report.uncorrectable.empty() ? 0 : 2;
+  }
+
+  if( search_length > 0 )
+  {
+    BestCodeSearch code_search( search_length, search_dimension );
+    search_options.num_threads = num_threads;
+    vector< FoundCode > found = code_search.search( search_options );
+    cout << "searched " << code_search.get_evaluated() << " candidates; "
+         << "the Griesmer bound is d <= " << code_search.griesmer_bound()
+         << endl;
+    for( const FoundCode &code : found )
+    {
+      cout << "d = " << code.minimum_distance << " with "
+           << code.num_minimum_words << " words of that weight" << endl;
+      code_search.write_code( cout, code );
+    }
+    if( found.empty() )
+    {
+      cerr << "no [" << search_length << ", " << search_dimension
+           << "] code was found" << endl;
+      return 2;
+    }
+    if( search_out != "" )
+    {
+      ofstream out_file( search_out );
+      code_search.write_code( out_file, found[ 0 ] );
+      if( !out_file )
+      {
+        cerr << "could not write " << search_out << endl;
+        return 1;
+      }
+    }
+    print_stats( stats_format );
+    return 0;
+  }
+
+  if( product )
+  {
+    vector< LinearCode > codes;
+    for( uint i = 0; i < code_files.size() and i < 2; i++ )
+    {
+      vector< uint > subset_of_F;
+      uint code_length = 0;
+      if( !read_code_file( code_files[ i ], subset_of_F, code_length ) )
+      {
+        return 1;
+      }
+      codes.push_back( construct_code( subset_of_F, code_length ) );
+    }
+    if( codes.size() < 2 )
+    {
+      cerr << "--product needs a row and a column --code=<file>" << endl;
+      return 1;
+    }
+
+    ProductCode product_code( codes[ 0 ], codes[ 1 ] );
+    run_product_link( product_code, codes[ 0 ], num_threads );
+    print_stats( stats_format );
+    return 0;
+  }
+
+  if( adaptive_target > 0 )
+  {
+    //build the whole catalog before the link starts
+    AdaptiveCodec codec( adaptive_target );
+    for( const string &file_name : code_files )
+    {
+      vector< uint > subset_of_F;
+      uint code_length = 0;
+      if( !read_code_file( file_name, subset_of_F, code_length ) )
+      {
+        return 1;
+      }
+      codec.add_code( construct_code( subset_of_F, code_length ) );
+    }
+    if( codec.get_num_codes() == 0 )
+    {
+      cerr << "--adaptive needs at least one --code=<file>" << endl;
+      return 1;
+    }
+
+    run_adaptive_link( codec );
+    codec.print_report( cout );
+    print_stats( stats_format );
+    return 0;
+  }
+
   //get S, a nonempty subset of F
   vector< uint > subset_of_F;
   uint subset_element;
@@ -565,6 +1136,7 @@ int main()
     LinearCode this_code = LinearCode( g_matrix,
                                        parity_check_matrix,
                                        code_length );
+    this_code.set_information_set( permutation );
     //print linear code information
     this_code.print_generator();
     this_code.print_parity_check();
@@ -572,17 +1144,57 @@ int main()
 
     //determine the map between words and encoded words
     vector< uint > encoded_words;
-    uint num_words =
-      find_power( 2, this_code.get_generator().size() );
+    uint num_words = find_power( 2, this_code.get_dimension() );
 
-    for( uint word = 0; word < num_words; word++ )
+    //encode, noise and decode in batches so each shows on the trace
+    //timeline
+    const uint BATCH_SIZE = 64;
     {
-      encoded_words.push_back( this_code.encode_word( word ) );
+      StageTimer timer( STAGE_ENCODE );
+      for( uint batch = 0; batch * BATCH_SIZE < num_words; batch++ )
+      {
+        TraceScope trace( "encode batch", batch );
+        uint batch_end = min( num_words, ( batch + 1 ) * BATCH_SIZE );
+        for( uint word = batch * BATCH_SIZE; word < batch_end; word++ )
+        {
+          encoded_words.push_back( this_code.encode_word( word ) );
+        }
+      }
     }
     
     AlphabetMap map = AlphabetMap( encoded_words );
     map.print_alphabet();
 
+    CodebookSearch search( this_code );
+    unique_ptr< DecodeCache > cache(
+      cache_capacity == 0 ? nullptr : new DecodeCache( cache_capacity ) );
+    uint num_errors = 3;
+
+    if( pipeline_file != "" )
+    {
+      MessagePipeline pipeline( this_code, map, search, cache.get(),
+                                num_threads, num_errors, time( NULL ) );
+      if( !pipeline.run( pipeline_file ) )
+      {
+        return 1;
+      }
+      cout << "number of errors per \"word\": " << num_errors << endl;
+      cout << endl;
+      cout << "the decoded received message: " << endl;
+      for( char letter : pipeline.get_decoded() )
+      {
+        cout << letter;
+      }
+      cout << endl;
+      cout << endl;
+      cout << "percent identity: " <<
+        ( static_cast< float >( pipeline.get_identical() ) /
+          pipeline.get_decoded().size() ) * 100 << endl;
+      pipeline.print_report( cout );
+      print_stats( stats_format );
+      return 0;
+    }
+
     
     
     //start tests
@@ -592,17 +1204,20 @@ int main()
     char letter;
     ifstream message_file;
     vector< char > message;
-    message_file.open( "alice_message.txt" );
-    if( message_file.is_open() )
     {
-      while( message_file.get( letter ) )
+      StageTimer timer( STAGE_READ );
+      message_file.open( "alice_message.txt" );
+      if( message_file.is_open() )
       {
-        if( letter != '\n' )
+        while( message_file.get( letter ) )
         {
-          message.push_back( letter );
+          if( letter != '\n' )
+          {
+            message.push_back( letter );
+          }
         }
+        message_file.close();
       }
-      message_file.close();
     }
 
     
@@ -617,16 +1232,35 @@ int main()
 
     
     //convert message to encoded words
-    vector< uint > encoded_message =
-      map.convert_to_numbers( message );
+    vector< uint > encoded_message;
+    {
+      StageTimer timer( STAGE_MAP );
+      encoded_message = map.convert_to_numbers( message );
+    }
 
     vector< char > og_message = message;
 
     
-    //introduce noise into message
-    uint num_errors = 3;
-    random_noise( encoded_message,
-                  this_code.get_code_length(), num_errors );
+    //introduce noise into message. each batch draws from a generator
+    //seeded by its offset, as the pipeline's chunks do
+    {
+      StageTimer timer( STAGE_CHANNEL );
+      uint seed = static_cast< uint >( time( NULL ) );
+      for( uint batch = 0; batch * BATCH_SIZE < encoded_message.size();
+           batch++ )
+      {
+        TraceScope trace( "noise batch", batch );
+        size_t batch_start = batch * BATCH_SIZE;
+        size_t batch_end = min< size_t >( encoded_message.size(),
+                                          batch_start + BATCH_SIZE );
+        vector< uint > batch_words( encoded_message.begin() + batch_start,
+                                    encoded_message.begin() + batch_end );
+        random_noise( batch_words, this_code.get_code_length(), num_errors,
+                      seed + static_cast< uint >( batch_start ) );
+        copy( batch_words.begin(), batch_words.end(),
+              encoded_message.begin() + batch_start );
+      }
+    }
 
     cout << "number of errors per \"word\": " << num_errors << endl;
     cout << endl;
@@ -645,13 +1279,44 @@ int main()
 
     
     //extract message from received message
-    vector< uint > decoded_message;
-    for( uint word : encoded_message )
+    vector< uint > decoded_message( encoded_message.size() );
     {
-      decoded_message.push_back( this_code.decode_word( word ) );
+      StageTimer timer( STAGE_DECODE );
+      Span< const uint > received( encoded_message );
+      Span< uint > decoded( decoded_message );
+      for( uint batch = 0; batch * BATCH_SIZE < encoded_message.size();
+           batch++ )
+      {
+        TraceScope trace( "decode batch", batch );
+        size_t batch_start = batch * BATCH_SIZE;
+        size_t batch_size = min< size_t >( BATCH_SIZE,
+                                           received.size() - batch_start );
+        if( !cache )
+        {
+          search.decode_message_batch(
+            received.subspan( batch_start, batch_size ),
+            decoded.subspan( batch_start, batch_size ) );
+          continue;
+        }
+
+        //repeated letters with the same noise skip the search
+        Span< uint > batch_decoded = decoded.subspan( batch_start,
+                                                      batch_size );
+        cache->decode_batch( search,
+                             received.subspan( batch_start, batch_size ),
+                             batch_decoded );
+        for( uint &word : batch_decoded )
+        {
+          word = this_code.extract_message( word );
+        }
+      }
     }
 
-    vector< char > char_d_message = map.convert_to_letters( decoded_message );
+    vector< char > char_d_message;
+    {
+      StageTimer timer( STAGE_MAP );
+      char_d_message = map.convert_messages_to_letters( decoded_message );
+    }
     
     cout << "the decoded received message: " << endl;
     for( char letter : char_d_message )
@@ -664,16 +1329,21 @@ int main()
     
     //determine accuracy
     float letters_identical = 0;
-    for( uint i = 0; i < og_message.size(); i++ )
     {
-      if( og_message.at( i ) == char_d_message.at( i ) )
+      StageTimer timer( STAGE_COMPARE );
+      for( uint i = 0; i < og_message.size(); i++ )
       {
-        letters_identical++;
+        if( og_message.at( i ) == char_d_message.at( i ) )
+        {
+          letters_identical++;
+        }
       }
     }
     cout << "percent identity: " <<
       ( letters_identical / og_message.size() ) * 100 << endl;
 
+    print_stats( stats_format );
+
     //-------------------------------------------------------
     //end tests
   }
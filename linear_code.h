@@ -5,6 +5,11 @@
 #include <iostream>
 #include <vector>
 #include <climits>
+#include <algorithm>
+#include <utility>
+#include "codec_stats.h"
+#include "word_span.h"
+#include "bit_kernels.h"
 
 using namespace std;
 
@@ -30,7 +35,18 @@ public:
    * Return the generator matrix
    * @return the generator matrix
    */
-  vector< uint > get_generator() const;
+  const vector< uint >& get_generator() const;
+
+  /**
+   * Return the parity check matrix
+   * @return the parity check matrix
+   */
+  const vector< uint >& get_parity_check() const;
+
+  /**
+   * Return the dimension of the code
+   */
+  uint get_dimension() const;
 
   /**
    * Return the code length
@@ -40,7 +56,17 @@ public:
   /**
    * Return the code words
    */
-  vector< uint > get_code_words() const;
+  const vector< uint >& get_code_words() const;
+
+  /**
+   * Return the minimum distance of the code
+   */
+  uint get_minimum_distance() const;
+
+  /**
+   * Return the number of errors the code is guaranteed to correct
+   */
+  uint get_correction_capability() const;
 
   /**
    * Print the code words
@@ -78,8 +104,184 @@ public:
    */
   uint encode_word( uint word ) const;
 
+  /**
+   * determine the syndrome of a word, the product of the parity
+   * check matrix and the word. bit i of the syndrome is the dot
+   * product of the word with row i of the parity check matrix.
+   * @param word the word
+   * @return the syndrome
+   */
+  uint syndrome( uint word ) const;
+
+  /**
+   * encode a batch of words. does no allocation and may be called
+   * from several threads at once.
+   * @param words the words to be encoded
+   * @param encoded the encoded words, at least as long as words
+   */
+  void encode_batch( Span< const uint > words,
+                     Span< uint > encoded ) const;
+
+  /**
+   * decode a batch of received words to their nearest neighbors.
+   * does no allocation and may be called from several threads at once.
+   * @param received the received words
+   * @param decoded the decoded words, at least as long as received
+   */
+  void decode_batch( Span< const uint > received,
+                     Span< uint > decoded ) const;
+
+  /**
+   * determine the syndromes of a batch of words. does no allocation
+   * and may be called from several threads at once.
+   * @param words the words
+   * @param syndromes the syndromes, at least as long as words
+   */
+  void syndrome_batch( Span< const uint > words,
+                       Span< uint > syndromes ) const;
+
+  /**
+   * update a codeword whose message has changed in a few bits. the
+   * code is linear, so the new codeword is the old one plus the
+   * encoding of the change, and only the rows of the generator matrix
+   * the change selects are added.
+   * @param code_word the old codeword
+   * @param message_delta the xor of the old and new messages, laid
+   * out as the words encode_word takes
+   * @return the new codeword
+   */
+  uint reencode_delta( uint code_word, uint message_delta ) const;
+
+  /**
+   * update many stored codewords in place. does no allocation and may
+   * be called from several threads at once on disjoint offsets.
+   * @param code_words the stored codewords
+   * @param offsets the index of each codeword to update
+   * @param message_deltas the change to the message at each offset,
+   * as many as there are offsets
+   * @return the number of updates not applied: those whose offset is
+   * past the codewords, or every update if the deltas and offsets
+   * differ in number
+   */
+  size_t reencode_delta_batch( Span< uint > code_words,
+                               Span< const uint > offsets,
+                               Span< const uint > message_deltas ) const;
+
+  /**
+   * use the information set of a permutation from find_permutation:
+   * its first k entries are the columns, counted from the left, where
+   * G' has the identity
+   * @param permutation the permutation
+   * @return whether or not those columns are an information set
+   */
+  bool set_information_set( const vector< uint > &permutation );
+
+  /**
+   * determine if the code has an information set, which it does
+   * whenever the rows of the generator matrix are independent
+   */
+  bool has_information_set() const;
+
+  /**
+   * determine the message a codeword encodes by reading it off the
+   * information set. when G is systematic there this is a single
+   * gather of the k bits.
+   * @param code_word the codeword
+   * @return the message, the word encode_word takes
+   */
+  uint extract_message( uint code_word ) const;
+
+  /**
+   * decode a received word straight to the message of its nearest
+   * neighbor. the corrected codeword is never built: the message is
+   * the message of the received word less that of the error word.
+   * @param received_word the word to be decoded
+   * @return the decoded message
+   */
+  uint decode_message( uint received_word ) const;
+
+  /**
+   * decode a batch of received words to their messages. does no
+   * allocation and may be called from several threads at once.
+   * @param received the received words
+   * @param messages the decoded messages, at least as long as received
+   */
+  void decode_message_batch( Span< const uint > received,
+                             Span< uint > messages ) const;
+
+  /**
+   * derive the code shortened at a place: the codewords with a 0
+   * there, with the place removed. an [n, k, d] code gives an
+   * [n - 1, k - 1, >= d] code, or [n - 1, k, d] when every codeword
+   * already has a 0 there.
+   * @param place the place, counted from the right
+   * @return the shortened code
+   */
+  LinearCode shorten( uint place ) const;
+
+  /**
+   * derive the code punctured at a place: every codeword with the
+   * place removed. an [n, k, d] code gives an [n - 1, k, >= d - 1]
+   * code, or [n - 1, k - 1, d] when the place alone is a codeword.
+   * @param place the place, counted from the right
+   * @return the punctured code
+   */
+  LinearCode puncture( uint place ) const;
+
+  /**
+   * derive the code extended by an overall parity bit, appended as
+   * the new rightmost place. an odd d becomes d + 1.
+   * @return the extended code, of length n + 1
+   */
+  LinearCode extend() const;
+
+  /**
+   * derive the code augmented by a word outside it: the code spanned
+   * by the codewords and the word, which becomes the first row of the
+   * generator matrix so every old message encodes as before. the all
+   * ones word gives the classic augmented code.
+   * @param word the word to add
+   * @return the augmented code, of dimension k + 1
+   */
+  LinearCode augment( uint word ) const;
+
 private:
 
+  /**
+   * Constructor for a code derived from another, whose code words,
+   * sorted, and minimum distance are already known
+   * @param generator the generator matrix
+   * @param parity_check the parity check matrix
+   * @param code_length the length of the code
+   * @param code_words the code words in increasing order
+   * @param minimum_distance the minimum distance
+   */
+  LinearCode( vector< uint > generator, vector< uint > parity_check,
+              uint code_length, vector< uint > code_words,
+              uint minimum_distance );
+
+  /**
+   * take the information set from the first independent columns
+   */
+  void choose_information_set();
+
+  /**
+   * clear a place from every row but one with a 1 there, then drop
+   * that row
+   * @param rows the rows of a matrix
+   * @param place the place
+   * @return whether or not any row had a 1 there
+   */
+  bool eliminate_place( vector< uint > &rows, uint place ) const;
+
+  /**
+   * remove a place from a word, closing the gap
+   * @param word the word
+   * @param place the place
+   * @return the word one place shorter
+   */
+  uint remove_place( uint word, uint place ) const;
+
   /**
    * determines the hamming distance between two words
    * @param first_word the first word
@@ -99,14 +301,15 @@ private:
    * @param matrix the matrix to be printed
    * @param code_length the length of the code
    */
-  void print_matrix( vector< uint > matrix, uint code_length ) const;
+  void print_matrix( const vector< uint > &matrix,
+                     uint code_length ) const;
 
   /**
    * determine the transpose of a matrix
    * @param matrix the matrix to be transposed
    * @param code_length the length of the code
    */
-  vector< uint > get_transpose( vector< uint > matrix,
+  vector< uint > get_transpose( const vector< uint > &matrix,
                                 uint code_length ) const;
 
   /**
@@ -116,46 +319,197 @@ private:
    * @return the result
    */
   uint find_power( uint base, uint exponent ) const;
+
+  /**
+   * find the least weight word in the coset of a received word
+   * @param received_word the received word
+   * @return the error word
+   */
+  uint find_error_word( uint received_word ) const;
+
+  /**
+   * prepare message extraction from a set of k places
+   * @param places the places, one per message bit
+   * @return whether or not the places are an information set
+   */
+  bool build_information_set( const vector< uint > &places );
   
   vector< uint > generator;
   vector< uint > parity_check;
   vector< uint > code_words;
   uint code_length;
+  uint minimum_distance;
+  uint information_mask;
+  bool information_systematic;
+  vector< uint > information_rows;
+  const BitKernels* kernels;
 };
 
+/**
+ * build the LinearCode of a generator and parity check matrix kept in
+ * 64 bit rows, a uint64_t or the blocks of a LongWord each, as the
+ * code families longer than a uint keep them. the code words are
+ * enumerated, so the length must be at most 32 and the dimension
+ * less than 32.
+ * @param generator the rows of the generator matrix
+ * @param parity_check the rows of the parity check matrix
+ * @param code_length the length of the code
+ * @return the linear code, or the code of length 0 if it does not fit
+ */
+template< class Row >
+LinearCode narrow_linear_code( const vector< Row > &generator,
+                               const vector< Row > &parity_check,
+                               uint code_length );
+
+/**
+ * return the low 64 coordinates of a row
+ * @param row the row
+ */
+inline uint64_t low_block( uint64_t row )
+{
+  return row;
+}
+
+/**
+ * return the low 64 coordinates of a row of blocks
+ * @param row the row
+ */
+inline uint64_t low_block( const vector< uint64_t > &row )
+{
+  return row.empty() ? 0 : row.front();
+}
+
 LinearCode::LinearCode( vector< uint > param_generator,
                         vector< uint > param_parity_check,
                         uint param_code_length )
-: generator( param_generator ), parity_check( param_parity_check ),
-  code_length( param_code_length )
+: generator( move( param_generator ) ),
+  parity_check( move( param_parity_check ) ),
+  code_length( param_code_length ), minimum_distance( 0 ),
+  information_mask( 0 ), information_systematic( false ),
+  kernels( &bit_kernels() )
 {
-  
-  for( uint i = 0; i < find_power( 2, code_length ); i++ )
+  TraceScope trace( "codebook build" );
+
+  //enumerate the code words as the combinations of the rows of the
+  //generator matrix, in gray code order so each word is one row away
+  //from the last. this is 2^k work rather than a 2^n scan of F.
+  uint num_messages = find_power( 2, generator.size() );
+  uint code_word = 0;
+  code_words.reserve( num_messages );
+  code_words.push_back( code_word );
+  for( uint i = 1; i < num_messages; i++ )
   {
-    if( is_code_word( i ) )
+    uint changed_bit = __builtin_ctz( i );
+    code_word ^= generator[ generator.size() - 1 - changed_bit ];
+    code_words.push_back( code_word );
+  }
+
+  //keep the code words in increasing order, as the scan of F did
+  sort( code_words.begin(), code_words.end() );
+  code_words.erase( unique( code_words.begin(), code_words.end() ),
+                    code_words.end() );
+
+  //the minimum distance is the least weight of a nonzero word
+  const uint ZERO_VECTOR = 0;
+  for( uint i = 0; i < code_words.size(); i++ )
+  {
+    uint this_hw = hamming_distance( ZERO_VECTOR, code_words.at( i ) );
+    if( this_hw > 0 and
+        ( minimum_distance == 0 or this_hw < minimum_distance ) )
     {
-      code_words.push_back( i );
+      minimum_distance = this_hw;
     }
   }
-  
+
+  choose_information_set();
 }
 
-vector< uint > LinearCode::get_code_words() const
+LinearCode::LinearCode( vector< uint > param_generator,
+                        vector< uint > param_parity_check,
+                        uint param_code_length,
+                        vector< uint > param_code_words,
+                        uint param_minimum_distance )
+: generator( move( param_generator ) ),
+  parity_check( move( param_parity_check ) ),
+  code_words( move( param_code_words ) ),
+  code_length( param_code_length ),
+  minimum_distance( param_minimum_distance ), information_mask( 0 ),
+  information_systematic( false ), kernels( &bit_kernels() )
+{
+  choose_information_set();
+}
+
+void LinearCode::choose_information_set()
+{
+  //take the first independent columns from the left, the columns
+  //find_permutation picks when G is in rref
+  vector< uint > places;
+  vector< uint > basis;
+  for( uint place = code_length - 1; place != UINT_MAX and
+         places.size() < generator.size(); place-- )
+  {
+    uint column = 0;
+    for( uint row = 0; row < generator.size(); row++ )
+    {
+      column |= ( ( generator[ row ] >> place ) & 1 ) << row;
+    }
+    for( uint reduced : basis )
+    {
+      if( ( column ^ reduced ) < column )
+      {
+        column ^= reduced;
+      }
+    }
+    if( column != 0 )
+    {
+      basis.push_back( column );
+      sort( basis.begin(), basis.end(), greater< uint >() );
+      places.push_back( place );
+    }
+  }
+  build_information_set( places );
+}
+
+const vector< uint >& LinearCode::get_code_words() const
 {
   return code_words;
 }
 
-vector< uint > LinearCode::get_generator() const
+const vector< uint >& LinearCode::get_generator() const
 {
   return generator;
 }
 
+const vector< uint >& LinearCode::get_parity_check() const
+{
+  return parity_check;
+}
+
+uint LinearCode::get_dimension() const
+{
+  return generator.size();
+}
+
 uint LinearCode::get_code_length() const
 {
   return code_length;
 }
 
-void LinearCode::print_matrix( vector< uint > matrix,
+uint LinearCode::get_minimum_distance() const
+{
+  return minimum_distance;
+}
+
+uint LinearCode::get_correction_capability() const
+{
+  if( minimum_distance == 0 )
+  {
+    return 0;
+  }
+  return ( minimum_distance - 1 ) / 2;
+}
+
+void LinearCode::print_matrix( const vector< uint > &matrix,
                                uint code_length ) const
 {
   //find and print the bitwise representation of matrix
@@ -220,46 +574,37 @@ void LinearCode::print_words() const
 
 bool LinearCode::is_code_word( uint word ) const
 {
-  //determine the product between the parity
-  //check matrix transpose and the word
-  vector< uint > vector_product;
-  for( uint col = 0; col < parity_check.size(); col++ )
-  {
-    //determine the dot product between each column of the
-    //parity check matrix transpose and the word
-    uint dot_product = 0;
-    uint this_term = 0;
-    for( uint row = 0; row < code_length; row++ )
-    {
-      uint word_coordinate = ( word >> row ) & 1;
-      uint basis_vector_coordinate = ( parity_check.at( col )
-                                       >> row ) & 1;
-      
-      this_term = word_coordinate & basis_vector_coordinate;
-      dot_product = dot_product ^ this_term;
-    }
-    vector_product.push_back( dot_product );
-  }
+  //a word is in the code when the product of the parity check
+  //matrix and the word is the zero vector
+  return syndrome( word ) == 0;
+}
 
-  //determine if the product is the zero vector
-  bool is_word = true;
-  for( uint this_word = 0; this_word < vector_product.size();
-       this_word++ )
-  {
-    if( vector_product.at( this_word ) != 0 )
-    {
-      is_word = false;
-    }
-  }
-  return is_word;
+uint LinearCode::syndrome( uint word ) const
+{
+  //each coordinate of the product is the dot product of the word
+  //with a row of the parity check matrix, which is the parity of
+  //the bits the two have in common
+  return kernels->syndrome( parity_check.data(), parity_check.size(), word );
 }
 
-vector< uint > LinearCode::get_transpose( vector< uint > matrix,
+vector< uint > LinearCode::get_transpose( const vector< uint > &matrix,
                                uint code_length ) const
 {
   vector< uint > matrix_transpose;
   uint new_code_length = 0;
 
+  //a row of the transpose packs a bit per row of the matrix, so up
+  //to 32 rows go through the transpose kernel, last row lowest
+  if( matrix.size() <= 32 )
+  {
+    vector< uint > reversed( matrix.rbegin(), matrix.rend() );
+    vector< uint > columns( code_length );
+    kernels->transpose( reversed.data(), reversed.size(), code_length,
+                        columns.data() );
+    matrix_transpose.assign( columns.rbegin(), columns.rend() );
+    return matrix_transpose;
+  }
+
   //initialize the transpose matrix
   for( uint col = code_length; col != 0; col-- )
   {
@@ -315,73 +660,501 @@ uint LinearCode::encode_word( uint word ) const
 
   //find the sum of the rows corresponding to the nonzero
   //coordinates of the word to be encoded
-  uint encoded_word = 0;
-  for( uint place_value = 0; place_value < generator.size();
-       place_value++ )
+  uint encoded_word =
+    kernels->encode( generator.data(), generator.size(), word );
+  CodecStats::count( WORDS_ENCODED );
+  return encoded_word;
+}
+
+uint LinearCode::decode_word( uint received_word ) const
+{
+  //return the received word minus the error word
+  return received_word ^ find_error_word( received_word );
+}
+
+uint LinearCode::find_error_word( uint received_word ) const
+{
+  //find the word of least hamming weight in the coset of the
+  //received word. the coset is walked in place rather than built,
+  //so decoding does no allocation. the kernel finds the least
+  //distance, then the first word at that distance is the leader
+  uint least = kernels->tile_min( code_words.data(), code_words.size(),
+                                  received_word );
+  uint i = 0;
+  while( i + 1 < code_words.size() and
+         kernels->weight( received_word ^ code_words[ i ] ) != least )
+  {
+    i++;
+  }
+  uint error_word = received_word ^ code_words[ i ];
+  const uint ZERO_VECTOR = 0;
+  uint least_hw = hamming_distance( ZERO_VECTOR, error_word );
+
+  //record the outcome. a coset leader heavier than the correction
+  //capability means the nearest neighbor may not be the word sent
+  if( CodecStats::is_enabled() )
   {
-    if( ( ( word >> place_value ) & 1 ) == 1 )
+    CodecStats::count( WORDS_DECODED );
+    if( least_hw > get_correction_capability() )
     {
-      encoded_word ^= generator.at( generator.size()
-                                    - 1 - place_value );
+      CodecStats::count( DECODE_FAILURES );
+    }
+    else
+    {
+      CodecStats::count( ERRORS_CORRECTED, least_hw );
     }
-    
   }
-  return encoded_word;
+
+  return error_word;
 }
 
-uint LinearCode::decode_word( uint received_word ) const
+void LinearCode::encode_batch( Span< const uint > words,
+                               Span< uint > encoded ) const
 {
-  //determine the coset for the received word
-  vector< uint > received_word_coset;
-  for( uint word = 0; word < code_words.size(); word++ )
+  for( size_t i = 0; i < words.size(); i++ )
   {
-    uint coset_word = received_word ^ code_words.at( word );
-    received_word_coset.push_back( coset_word );
+    encoded[ i ] = encode_word( words[ i ] );
   }
+}
 
-  //optional print cosets
-  /*
-  cout << "received word: " << received_word << endl;
-  cout << "corresponding coset: ";
-  for( uint i = 0; i < received_word_coset.size(); i++ )
+void LinearCode::decode_batch( Span< const uint > received,
+                               Span< uint > decoded ) const
+{
+  for( size_t i = 0; i < received.size(); i++ )
   {
-    cout << received_word_coset.at( i ) << " ";
+    decoded[ i ] = decode_word( received[ i ] );
   }
-  cout << endl;
-  cout << endl;
-  */
+}
 
-  //determine the least hamming weight in the coset
-  uint error_word = received_word_coset.at( 0 );
-  uint least_hw = UINT_MAX;
-  const uint ZERO_VECTOR = 0;
-  
-  for( uint i = 0; i < received_word_coset.size(); i++ )
+uint LinearCode::reencode_delta( uint code_word,
+                                 uint message_delta ) const
+{
+  //add the row of each changed message bit; a single bit change is
+  //a single xor
+  uint delta_bits = generator.size() < 32 ?
+    message_delta & ( ( 1u << generator.size() ) - 1 ) : message_delta;
+  for( ; delta_bits != 0; delta_bits &= delta_bits - 1 )
   {
-    uint this_hw = hamming_distance( ZERO_VECTOR,
-                                received_word_coset.at( i ) );
-    if( this_hw < least_hw )
+    uint place_value = __builtin_ctz( delta_bits );
+    code_word ^= generator[ generator.size() - 1 - place_value ];
+  }
+  CodecStats::count( WORDS_ENCODED );
+  return code_word;
+}
+
+size_t LinearCode::reencode_delta_batch( Span< uint > code_words,
+                                         Span< const uint > offsets,
+                                         Span< const uint > message_deltas )
+  const
+{
+  if( message_deltas.size() != offsets.size() )
+  {
+    cout << offsets.size() << " offsets but " << message_deltas.size()
+         << " message changes." << endl;
+    return offsets.size();
+  }
+  size_t skipped = 0;
+  for( size_t i = 0; i < offsets.size(); i++ )
+  {
+    if( offsets[ i ] >= code_words.size() )
     {
-      least_hw = this_hw;
-      error_word = received_word_coset.at( i );
+      cout << "no codeword at offset " << offsets[ i ] << "." << endl;
+      skipped++;
+      continue;
     }
+    code_words[ offsets[ i ] ] =
+      reencode_delta( code_words[ offsets[ i ] ], message_deltas[ i ] );
   }
-  //return the received word minus the error word
-  return received_word ^ error_word;
-  
+  return skipped;
+}
+
+void LinearCode::syndrome_batch( Span< const uint > words,
+                                 Span< uint > syndromes ) const
+{
+  for( size_t i = 0; i < words.size(); i++ )
+  {
+    syndromes[ i ] = syndrome( words[ i ] );
+  }
+}
+
+bool LinearCode::build_information_set( const vector< uint > &places )
+{
+  uint dimension = generator.size();
+  information_mask = 0;
+  for( uint place : places )
+  {
+    information_mask |= 1u << place;
+  }
+  if( places.size() != dimension or
+      static_cast< uint >( __builtin_popcount( information_mask ) ) !=
+      dimension )
+  {
+    information_mask = 0;
+    return false;
+  }
+
+  //gathered bit j of the codeword of message bit p. invert the
+  //k x k matrix of these so each gathered bit maps to the message
+  //bits it stands for
+  vector< uint > gathered;
+  vector< uint > messages;
+  for( uint p = 0; p < dimension; p++ )
+  {
+    gathered.push_back( gather_bits_scalar(
+      generator[ dimension - 1 - p ], information_mask ) );
+    messages.push_back( 1u << p );
+  }
+  for( uint j = 0; j < dimension; j++ )
+  {
+    uint pivot = j;
+    while( pivot < dimension and ( ( gathered[ pivot ] >> j ) & 1 ) == 0 )
+    {
+      pivot++;
+    }
+    if( pivot == dimension )
+    {
+      information_mask = 0;
+      return false;
+    }
+    swap( gathered[ j ], gathered[ pivot ] );
+    swap( messages[ j ], messages[ pivot ] );
+    for( uint row = 0; row < dimension; row++ )
+    {
+      if( row != j and ( ( gathered[ row ] >> j ) & 1 ) == 1 )
+      {
+        gathered[ row ] ^= gathered[ j ];
+        messages[ row ] ^= messages[ j ];
+      }
+    }
+  }
+
+  //when gathered bit j is message bit j no transform is needed
+  information_rows = messages;
+  information_systematic = true;
+  for( uint j = 0; j < dimension; j++ )
+  {
+    if( information_rows[ j ] != 1u << j )
+    {
+      information_systematic = false;
+    }
+  }
+  return true;
+}
+
+bool LinearCode::set_information_set( const vector< uint > &permutation )
+{
+  vector< uint > places;
+  for( uint i = 0; i < generator.size() and i < permutation.size(); i++ )
+  {
+    places.push_back( code_length - 1 - permutation.at( i ) );
+  }
+  if( !build_information_set( places ) )
+  {
+    cout << "the permutation does not give an information set." << endl;
+    return false;
+  }
+  return true;
+}
+
+bool LinearCode::has_information_set() const
+{
+  return information_mask != 0;
+}
+
+uint LinearCode::extract_message( uint code_word ) const
+{
+  uint gathered = kernels->gather_bits( code_word, information_mask );
+  if( information_systematic )
+  {
+    return gathered;
+  }
+  uint message = 0;
+  for( uint j = 0; gathered != 0; j++, gathered >>= 1 )
+  {
+    if( gathered & 1 )
+    {
+      message ^= information_rows[ j ];
+    }
+  }
+  return message;
+}
+
+uint LinearCode::decode_message( uint received_word ) const
+{
+  return extract_message( received_word ) ^
+    extract_message( find_error_word( received_word ) );
+}
+
+void LinearCode::decode_message_batch( Span< const uint > received,
+                                       Span< uint > messages ) const
+{
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    messages[ i ] = decode_message( received[ i ] );
+  }
+}
+
+bool LinearCode::eliminate_place( vector< uint > &rows, uint place ) const
+{
+  uint pivot = 0;
+  while( pivot < rows.size() and ( ( rows[ pivot ] >> place ) & 1 ) == 0 )
+  {
+    pivot++;
+  }
+  if( pivot == rows.size() )
+  {
+    return false;
+  }
+  kernels->eliminate( rows.data(), rows.size(), pivot, 1u << place );
+  rows.erase( rows.begin() + pivot );
+  return true;
+}
+
+uint LinearCode::remove_place( uint word, uint place ) const
+{
+  uint low = word & ( ( 1u << place ) - 1 );
+  return static_cast< uint >( ( static_cast< uint64_t >( word ) >>
+                                ( place + 1 ) ) << place ) | low;
+}
+
+LinearCode LinearCode::shorten( uint place ) const
+{
+  TraceScope trace( "derived code" );
+  if( place >= code_length or code_length < 2 )
+  {
+    cout << "cannot shorten a code of length " << code_length
+         << " at place " << place << "." << endl;
+    return *this;
+  }
+
+  //one elimination step on G leaves a basis of the words with a 0 at
+  //the place, and the dual is the dual punctured there. when no row
+  //of G has a 1 there, the place alone is in the dual, so the
+  //elimination step is on H instead and G keeps every row
+  vector< uint > new_generator = generator;
+  vector< uint > new_parity_check = parity_check;
+  if( !eliminate_place( new_generator, place ) )
+  {
+    eliminate_place( new_parity_check, place );
+  }
+  for( uint &row : new_generator )
+  {
+    row = remove_place( row, place );
+  }
+  for( uint &row : new_parity_check )
+  {
+    row = remove_place( row, place );
+  }
+
+  //the words with a 0 at the place keep their order without it
+  vector< uint > new_code_words;
+  new_code_words.reserve( code_words.size() );
+  uint new_distance = 0;
+  for( uint word : code_words )
+  {
+    if( ( ( word >> place ) & 1 ) == 0 )
+    {
+      uint shortened = remove_place( word, place );
+      uint weight = kernels->weight( shortened );
+      if( weight > 0 and ( new_distance == 0 or weight < new_distance ) )
+      {
+        new_distance = weight;
+      }
+      new_code_words.push_back( shortened );
+    }
+  }
+  return LinearCode( move( new_generator ), move( new_parity_check ),
+                     code_length - 1, move( new_code_words ), new_distance );
+}
+
+LinearCode LinearCode::puncture( uint place ) const
+{
+  TraceScope trace( "derived code" );
+  if( place >= code_length or code_length < 2 )
+  {
+    cout << "cannot puncture a code of length " << code_length
+         << " at place " << place << "." << endl;
+    return *this;
+  }
+
+  //the dual of the punctured code is the dual shortened there, so
+  //this is shorten with G and H changing roles
+  vector< uint > new_generator = generator;
+  vector< uint > new_parity_check = parity_check;
+  if( !eliminate_place( new_parity_check, place ) )
+  {
+    eliminate_place( new_generator, place );
+  }
+  for( uint &row : new_generator )
+  {
+    row = remove_place( row, place );
+  }
+  for( uint &row : new_parity_check )
+  {
+    row = remove_place( row, place );
+  }
+
+  //the words with a 0 and with a 1 at the place each keep their order
+  //without it, so the two runs are merged rather than sorted. they
+  //meet in pairs when the place alone was a codeword
+  vector< uint > zeros;
+  vector< uint > ones;
+  zeros.reserve( code_words.size() );
+  ones.reserve( code_words.size() );
+  for( uint word : code_words )
+  {
+    ( ( ( word >> place ) & 1 ) == 0 ? zeros : ones ).push_back(
+      remove_place( word, place ) );
+  }
+  vector< uint > new_code_words( zeros.size() + ones.size() );
+  merge( zeros.begin(), zeros.end(), ones.begin(), ones.end(),
+         new_code_words.begin() );
+  new_code_words.erase( unique( new_code_words.begin(),
+                                new_code_words.end() ),
+                        new_code_words.end() );
+  uint new_distance = 0;
+  for( uint word : new_code_words )
+  {
+    uint weight = kernels->weight( word );
+    if( weight > 0 and ( new_distance == 0 or weight < new_distance ) )
+    {
+      new_distance = weight;
+    }
+  }
+  return LinearCode( move( new_generator ), move( new_parity_check ),
+                     code_length - 1, move( new_code_words ), new_distance );
+}
+
+LinearCode LinearCode::extend() const
+{
+  TraceScope trace( "derived code" );
+  if( code_length >= 32 )
+  {
+    cout << "cannot extend a code of length " << code_length << "." << endl;
+    return *this;
+  }
+
+  //a parity bit on the right keeps the code words in order. the old
+  //checks ignore the new place, and one more check covers every place
+  vector< uint > new_generator;
+  for( uint row : generator )
+  {
+    new_generator.push_back( ( row << 1 ) | ( kernels->weight( row ) & 1 ) );
+  }
+  vector< uint > new_parity_check;
+  for( uint row : parity_check )
+  {
+    new_parity_check.push_back( row << 1 );
+  }
+  new_parity_check.push_back( code_length + 1 == 32 ?
+    UINT_MAX : ( 1u << ( code_length + 1 ) ) - 1 );
+
+  vector< uint > new_code_words;
+  new_code_words.reserve( code_words.size() );
+  for( uint word : code_words )
+  {
+    new_code_words.push_back( ( word << 1 ) |
+                              ( kernels->weight( word ) & 1 ) );
+  }
+  uint new_distance = minimum_distance + ( minimum_distance & 1 );
+  return LinearCode( move( new_generator ), move( new_parity_check ),
+                     code_length + 1, move( new_code_words ), new_distance );
+}
+
+LinearCode LinearCode::augment( uint word ) const
+{
+  TraceScope trace( "derived code" );
+  if( code_length < 32 )
+  {
+    word &= ( 1u << code_length ) - 1;
+  }
+  if( syndrome( word ) == 0 )
+  {
+    cout << "cannot augment a code by one of its code words." << endl;
+    return *this;
+  }
+
+  vector< uint > new_generator;
+  new_generator.reserve( generator.size() + 1 );
+  new_generator.push_back( word );
+  new_generator.insert( new_generator.end(), generator.begin(),
+                        generator.end() );
+
+  //the new dual is the checks the word satisfies: add one check the
+  //word fails to every other it fails, then drop it
+  vector< uint > new_parity_check = parity_check;
+  uint pivot = 0;
+  while( ( kernels->weight( new_parity_check[ pivot ] & word ) & 1 ) == 0 )
+  {
+    pivot++;
+  }
+  for( uint row = 0; row < new_parity_check.size(); row++ )
+  {
+    if( row != pivot and
+        ( kernels->weight( new_parity_check[ row ] & word ) & 1 ) == 1 )
+    {
+      new_parity_check[ row ] ^= new_parity_check[ pivot ];
+    }
+  }
+  new_parity_check.erase( new_parity_check.begin() + pivot );
+
+  //the code is the old words and their coset through the word. only
+  //the coset is sorted, then the two are merged
+  vector< uint > coset;
+  coset.reserve( code_words.size() );
+  uint new_distance = minimum_distance;
+  for( uint old_word : code_words )
+  {
+    uint shifted = old_word ^ word;
+    uint weight = kernels->weight( shifted );
+    if( new_distance == 0 or weight < new_distance )
+    {
+      new_distance = weight;
+    }
+    coset.push_back( shifted );
+  }
+  sort( coset.begin(), coset.end() );
+  vector< uint > new_code_words( code_words.size() * 2 );
+  merge( code_words.begin(), code_words.end(), coset.begin(), coset.end(),
+         new_code_words.begin() );
+  return LinearCode( move( new_generator ), move( new_parity_check ),
+                     code_length, move( new_code_words ), new_distance );
+}
+
+template< class Row >
+LinearCode narrow_linear_code( const vector< Row > &generator,
+                               const vector< Row > &parity_check,
+                               uint code_length )
+{
+  if( code_length > 32 or generator.size() >= 32 )
+  {
+    cout << "a code of length " << code_length << " and dimension "
+         << generator.size() << " does not fit a LinearCode." << endl;
+    return LinearCode( vector< uint >(), vector< uint >(), 0 );
+  }
+  vector< uint > generator_rows;
+  for( const Row &row : generator )
+  {
+    generator_rows.push_back( static_cast< uint >( low_block( row ) ) );
+  }
+  vector< uint > parity_check_rows;
+  for( const Row &row : parity_check )
+  {
+    parity_check_rows.push_back( static_cast< uint >( low_block( row ) ) );
+  }
+  return LinearCode( generator_rows, parity_check_rows, code_length );
 }
 
 uint LinearCode::hamming_distance( uint first_word,
                                    uint second_word ) const
 {
+  //count the places that differ within the code length
   uint places_differ = first_word ^ second_word;
-  uint hamming_distance = 0;
-  for( uint place_value = 0; place_value < code_length;
-       place_value++ )
+  if( code_length < 32 )
   {
-    hamming_distance += ( ( places_differ >> place_value ) & 1 );
+    places_differ &= ( 1u << code_length ) - 1;
   }
-  return hamming_distance;
+  return kernels->weight( places_differ );
 }
 
 #endif
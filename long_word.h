@@ -0,0 +1,185 @@
+#ifndef LONG_WORD_H
+#define LONG_WORD_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+/*
+ * A word longer than a uint, stored 64 coordinates to a block.
+ * Coordinate i is bit i % 64 of block i / 64, the same place value
+ * order a uint word uses.
+ */
+typedef vector< uint64_t > LongWord;
+
+/*
+ * create the zero word of a given length
+ * @param length the number of coordinates
+ * @return the zero word
+ */
+LongWord new_long_word( uint length );
+
+/*
+ * return a coordinate of a long word
+ * @param word the word
+ * @param position the coordinate
+ * @return the bit at the coordinate
+ */
+uint get_bit( const LongWord &word, uint position );
+
+/*
+ * set a coordinate of a long word to 1
+ * @param word the word
+ * @param position the coordinate
+ */
+void set_bit( LongWord &word, uint position );
+
+/*
+ * flip a coordinate of a long word
+ * @param word the word
+ * @param position the coordinate
+ */
+void flip_bit( LongWord &word, uint position );
+
+/*
+ * add one long word into another, coordinatewise mod 2
+ * @param word the word added to
+ * @param other the word added
+ */
+void add_long_word( LongWord &word, const LongWord &other );
+
+/*
+ * determine the hamming weight of a long word
+ * @param word the word
+ * @return the number of nonzero coordinates
+ */
+uint long_word_weight( const LongWord &word );
+
+/*
+ * determine a basis of the dual of the code spanned by a set of long
+ * words. the spanning set is put in rref; each coordinate without a
+ * pivot then gives one dual word.
+ * @param generator the spanning set
+ * @param length the number of coordinates
+ * @return a basis of the dual code
+ */
+vector< LongWord > find_dual_basis( vector< LongWord > generator,
+                                    uint length );
+
+/*
+ * print the bitwise representation of a long word, highest
+ * coordinate first, as the uint printers do
+ * @param word the word
+ * @param length the number of coordinates
+ */
+void print_long_word( const LongWord &word, uint length );
+
+
+LongWord new_long_word( uint length )
+{
+  return LongWord( ( length + 63 ) / 64, 0 );
+}
+
+uint get_bit( const LongWord &word, uint position )
+{
+  return ( word[ position / 64 ] >> ( position % 64 ) ) & 1;
+}
+
+void set_bit( LongWord &word, uint position )
+{
+  word[ position / 64 ] |= uint64_t( 1 ) << ( position % 64 );
+}
+
+void flip_bit( LongWord &word, uint position )
+{
+  word[ position / 64 ] ^= uint64_t( 1 ) << ( position % 64 );
+}
+
+void add_long_word( LongWord &word, const LongWord &other )
+{
+  for( uint block = 0; block < word.size(); block++ )
+  {
+    word[ block ] ^= other[ block ];
+  }
+}
+
+uint long_word_weight( const LongWord &word )
+{
+  uint weight = 0;
+  for( uint block = 0; block < word.size(); block++ )
+  {
+    weight += __builtin_popcountll( word[ block ] );
+  }
+  return weight;
+}
+
+vector< LongWord > find_dual_basis( vector< LongWord > generator,
+                                    uint length )
+{
+  //gauss-jordan elimination, taking pivots from the highest
+  //coordinate down as find_rref does
+  vector< uint > pivots;
+  vector< bool > is_pivot( length, false );
+  uint row = 0;
+  for( uint col = length - 1; col != UINT32_MAX and row < generator.size();
+       col-- )
+  {
+    uint pivot_row = row;
+    while( pivot_row < generator.size() and
+           get_bit( generator.at( pivot_row ), col ) == 0 )
+    {
+      pivot_row++;
+    }
+    if( pivot_row == generator.size() )
+    {
+      continue;
+    }
+    swap( generator.at( row ), generator.at( pivot_row ) );
+    for( uint other = 0; other < generator.size(); other++ )
+    {
+      if( other != row and get_bit( generator.at( other ), col ) )
+      {
+        add_long_word( generator.at( other ), generator.at( row ) );
+      }
+    }
+    pivots.push_back( col );
+    is_pivot.at( col ) = true;
+    row++;
+  }
+
+  //the dual word of a free coordinate c is e_c plus e_p for every
+  //pivot p whose row is nonzero at c
+  vector< LongWord > dual_basis;
+  for( uint col = length - 1; col != UINT32_MAX; col-- )
+  {
+    if( is_pivot.at( col ) )
+    {
+      continue;
+    }
+    LongWord dual_word = new_long_word( length );
+    set_bit( dual_word, col );
+    for( uint r = 0; r < pivots.size(); r++ )
+    {
+      if( get_bit( generator.at( r ), col ) )
+      {
+        set_bit( dual_word, pivots.at( r ) );
+      }
+    }
+    dual_basis.push_back( dual_word );
+  }
+  return dual_basis;
+}
+
+void print_long_word( const LongWord &word, uint length )
+{
+  for( uint position = length - 1; position != UINT32_MAX; position-- )
+  {
+    cout << get_bit( word, position );
+  }
+  cout << endl;
+}
+
+#endif
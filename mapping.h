@@ -29,7 +29,7 @@ public:
    * message
    * @param encoding the codewords from the linear code
    */
-  AlphabetMap( vector< uint > encoding );
+  AlphabetMap( const vector< uint > &encoding );
 
   /**
    * a function to convert a message in numbers to a message in
@@ -37,7 +37,7 @@ public:
    * @param message the message to be converted
    * @return the message in letters
    */
-  vector< char > convert_to_letters( vector< uint > message );
+  vector< char > convert_to_letters( const vector< uint > &message );
 
   /**
    * a function to convert a message in letters to a message in
@@ -45,7 +45,16 @@ public:
    * @param message the message to be converted
    * @return the message in numbers
    */
-  vector< uint > convert_to_numbers( vector< char > message );
+  vector< uint > convert_to_numbers( const vector< char > &message );
+
+  /**
+   * a function to convert decoded messages to letters. letter i
+   * encodes message i, so no lookup is needed.
+   * @param messages the messages to be converted
+   * @return the message in letters
+   */
+  vector< char > convert_messages_to_letters(
+    const vector< uint > &messages );
 
   /**
    * a function to print the letters in the alphabet mapping
@@ -59,7 +68,7 @@ private:
 
 };
 
-AlphabetMap::AlphabetMap( vector< uint > encoding )
+AlphabetMap::AlphabetMap( const vector< uint > &encoding )
 {
   //initiate the mappings
   for( int i = 0; i < encoding.size(); i++ )
@@ -84,7 +93,7 @@ void AlphabetMap::print_alphabet()
 }
 
 vector< char > AlphabetMap::convert_to_letters(
-  vector< uint > message )
+  const vector< uint > &message )
 {
   //use mapping for conversion
   vector< char > converted_message;
@@ -109,7 +118,7 @@ vector< char > AlphabetMap::convert_to_letters(
 }
 
 vector< uint > AlphabetMap::convert_to_numbers(
-  vector< char > message )
+  const vector< char > &message )
 {
   //use reverse mapping for conversion
   vector< uint > converted_message;
@@ -122,4 +131,17 @@ vector< uint > AlphabetMap::convert_to_numbers(
   return converted_message;
 }
 
+vector< char > AlphabetMap::convert_messages_to_letters(
+  const vector< uint > &messages )
+{
+  vector< char > converted_message;
+  for( uint i = 0; i < messages.size(); i++ )
+  {
+    converted_message.push_back(
+      static_cast< char >( messages.at( i ) + ALPHABET_BASE ) );
+  }
+
+  return converted_message;
+}
+
 #endif
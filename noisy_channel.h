@@ -6,6 +6,7 @@
 #include <iostream>
 #include <vector>
 #include <cfloat>
+#include <random>
 #include <stdlib.h>
 #include <time.h>
 
@@ -22,8 +23,34 @@ void random_noise( vector< uint > &message,
                    uint code_length,
                    uint errors_per_word );
 
+/*
+ * introduces noise "randomly" into the message from a generator of its
+ * own, so parts of a message noised on different threads each draw
+ * the same noise whatever order they run in.
+ * @param message the message to be sent
+ * @param code_length the length of the code
+ * @param errors_per_word the number of errors
+ * randomly introduced into each word.
+ * @param seed the seed of the generator
+ */
+void random_noise( vector< uint > &message,
+                   uint code_length,
+                   uint errors_per_word,
+                   uint seed );
+
 uint find_power( uint base, uint exponent );
 
+/*
+ * flips each bit of each word independently, as a binary symmetric
+ * channel does. the generator is seeded by the caller.
+ * @param message the message to be sent
+ * @param code_length the length of the code
+ * @param error_rate the chance each bit is flipped
+ */
+void binary_symmetric_noise( vector< uint > &message,
+                             uint code_length,
+                             double error_rate );
+
 /*
  * introduces burst noise into the message, within each word.
  * @param message the message to be sent
@@ -63,6 +90,37 @@ void random_noise( vector< uint > &message,
   
 }
 
+void random_noise( vector< uint > &message,
+                   uint code_length,
+                   uint errors_per_word,
+                   uint seed )
+{
+  minstd_rand generator( seed );
+  for( uint j = 0; j < errors_per_word; j++ )
+  {
+    for( uint i = 0; i < message.size(); i++ )
+    {
+      message.at( i ) ^= 1u << ( generator() % code_length );
+    }
+  }
+}
+
+void binary_symmetric_noise( vector< uint > &message,
+                             uint code_length,
+                             double error_rate )
+{
+  for( uint i = 0; i < message.size(); i++ )
+  {
+    for( uint place = 0; place < code_length; place++ )
+    {
+      if( rand() < error_rate * ( static_cast< double >( RAND_MAX ) + 1 ) )
+      {
+        message.at( i ) ^= 1u << place;
+      }
+    }
+  }
+}
+
 void burst_noise( vector< uint > &message, uint code_length )
 {
   srand( time( NULL ) );
@@ -0,0 +1,780 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <cstdint>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "trace.h"
+#include "linear_code.h"
+#include "codebook_search.h"
+#include "decode_cache.h"
+#include "noisy_channel.h"
+#include "mapping.h"
+
+using namespace std;
+
+/*
+ * the letters in a chunk
+ */
+const uint PIPELINE_CHUNK = 256;
+
+/*
+ * the chunks each queue between two stages holds
+ */
+const uint PIPELINE_QUEUE = 8;
+
+/*
+ * spin a little while a queue is full or empty, then give the core up.
+ * the spin hint is the pause instruction where there is one
+ * @param spins the spins so far, counted up
+ */
+inline void queue_backoff( uint &spins )
+{
+  if( spins < 64 )
+  {
+    spins++;
+#if defined( __x86_64__ ) || defined( __i386__ )
+    __builtin_ia32_pause();
+#elif defined( __aarch64__ )
+    __asm__ __volatile__( "yield" );
+#endif
+  }
+  else
+  {
+    this_thread::yield();
+  }
+}
+
+/**
+ * A bounded lock-free queue for one producer and one consumer. The
+ * slots are a ring of a power of 2, and each side keeps a copy of the
+ * other side's index, reading the other's cache line only when the
+ * ring looks full or empty. A push to a full queue waits, which is the
+ * backpressure that holds a fast stage to the pace of a slow one.
+ * @author agent
+ * @version 18 October 2026
+ */
+template< typename T >
+class SpscQueue
+{
+public:
+  /**
+   * Constructor sizing the queue
+   * @param capacity the most items held, rounded up to a power of 2
+   */
+  SpscQueue( size_t capacity );
+
+  /**
+   * add an item if there is room
+   * @param item the item
+   * @return whether or not it was added
+   */
+  bool try_push( const T &item );
+
+  /**
+   * take the oldest item if there is one
+   * @param item the item taken
+   * @return whether or not one was taken
+   */
+  bool try_pop( T &item );
+
+  /**
+   * add an item, waiting for room
+   * @param item the item
+   */
+  void push( const T &item );
+
+  /**
+   * take the oldest item, waiting for one
+   * @return the item
+   */
+  T pop();
+
+private:
+  vector< T > slots;
+  size_t mask;
+  alignas( 64 ) atomic< size_t > tail;
+  size_t cached_head;
+  alignas( 64 ) atomic< size_t > head;
+  size_t cached_tail;
+};
+
+template< typename T >
+SpscQueue< T >::SpscQueue( size_t capacity )
+: tail( 0 ), cached_head( 0 ), head( 0 ), cached_tail( 0 )
+{
+  size_t size = 1;
+  while( size < capacity )
+  {
+    size <<= 1;
+  }
+  slots.resize( size );
+  mask = size - 1;
+}
+
+template< typename T >
+bool SpscQueue< T >::try_push( const T &item )
+{
+  size_t position = tail.load( memory_order_relaxed );
+  if( position - cached_head == slots.size() )
+  {
+    cached_head = head.load( memory_order_acquire );
+    if( position - cached_head == slots.size() )
+    {
+      return false;
+    }
+  }
+  slots[ position & mask ] = item;
+  tail.store( position + 1, memory_order_release );
+  return true;
+}
+
+template< typename T >
+bool SpscQueue< T >::try_pop( T &item )
+{
+  size_t position = head.load( memory_order_relaxed );
+  if( position == cached_tail )
+  {
+    cached_tail = tail.load( memory_order_acquire );
+    if( position == cached_tail )
+    {
+      return false;
+    }
+  }
+  item = slots[ position & mask ];
+  head.store( position + 1, memory_order_release );
+  return true;
+}
+
+template< typename T >
+void SpscQueue< T >::push( const T &item )
+{
+  uint spins = 0;
+  while( !try_push( item ) )
+  {
+    queue_backoff( spins );
+  }
+}
+
+template< typename T >
+T SpscQueue< T >::pop()
+{
+  T item;
+  uint spins = 0;
+  while( !try_pop( item ) )
+  {
+    queue_backoff( spins );
+  }
+  return item;
+}
+
+/**
+ * A bounded lock-free queue for any number of producers and consumers.
+ * Each slot carries a sequence number saying whose turn it is, so a
+ * producer or consumer claims a position with one compare and swap and
+ * then owns its slot until it publishes the next sequence number.
+ * @author agent
+ * @version 18 October 2026
+ */
+template< typename T >
+class MpmcQueue
+{
+public:
+  /**
+   * Constructor sizing the queue
+   * @param capacity the most items held, rounded up to a power of 2
+   */
+  MpmcQueue( size_t capacity );
+
+  /**
+   * add an item if there is room
+   * @param item the item
+   * @return whether or not it was added
+   */
+  bool try_push( const T &item );
+
+  /**
+   * take the oldest item if there is one
+   * @param item the item taken
+   * @return whether or not one was taken
+   */
+  bool try_pop( T &item );
+
+  /**
+   * add an item, waiting for room
+   * @param item the item
+   */
+  void push( const T &item );
+
+  /**
+   * take the oldest item, waiting for one
+   * @return the item
+   */
+  T pop();
+
+private:
+
+  /*
+   * a slot and the position it next serves
+   */
+  struct Cell
+  {
+    atomic< size_t > sequence;
+    T item;
+  };
+
+  unique_ptr< Cell[] > cells;
+  size_t mask;
+  alignas( 64 ) atomic< size_t > tail;
+  alignas( 64 ) atomic< size_t > head;
+};
+
+template< typename T >
+MpmcQueue< T >::MpmcQueue( size_t capacity )
+: tail( 0 ), head( 0 )
+{
+  size_t size = 2;
+  while( size < capacity )
+  {
+    size <<= 1;
+  }
+  cells.reset( new Cell[ size ] );
+  for( size_t i = 0; i < size; i++ )
+  {
+    cells[ i ].sequence.store( i, memory_order_relaxed );
+  }
+  mask = size - 1;
+}
+
+template< typename T >
+bool MpmcQueue< T >::try_push( const T &item )
+{
+  //a slot is free for position p when its sequence is p, and full
+  //for it when its sequence is p + 1
+  size_t position = tail.load( memory_order_relaxed );
+  Cell* cell;
+  while( true )
+  {
+    cell = &cells[ position & mask ];
+    size_t sequence = cell->sequence.load( memory_order_acquire );
+    intptr_t lead = static_cast< intptr_t >( sequence ) -
+      static_cast< intptr_t >( position );
+    if( lead == 0 )
+    {
+      if( tail.compare_exchange_weak( position, position + 1,
+                                      memory_order_relaxed ) )
+      {
+        break;
+      }
+    }
+    else if( lead < 0 )
+    {
+      return false;
+    }
+    else
+    {
+      position = tail.load( memory_order_relaxed );
+    }
+  }
+  cell->item = item;
+  cell->sequence.store( position + 1, memory_order_release );
+  return true;
+}
+
+template< typename T >
+bool MpmcQueue< T >::try_pop( T &item )
+{
+  size_t position = head.load( memory_order_relaxed );
+  Cell* cell;
+  while( true )
+  {
+    cell = &cells[ position & mask ];
+    size_t sequence = cell->sequence.load( memory_order_acquire );
+    intptr_t lead = static_cast< intptr_t >( sequence ) -
+      static_cast< intptr_t >( position + 1 );
+    if( lead == 0 )
+    {
+      if( head.compare_exchange_weak( position, position + 1,
+                                      memory_order_relaxed ) )
+      {
+        break;
+      }
+    }
+    else if( lead < 0 )
+    {
+      return false;
+    }
+    else
+    {
+      position = head.load( memory_order_relaxed );
+    }
+  }
+  item = cell->item;
+  cell->sequence.store( position + mask + 1, memory_order_release );
+  return true;
+}
+
+template< typename T >
+void MpmcQueue< T >::push( const T &item )
+{
+  uint spins = 0;
+  while( !try_push( item ) )
+  {
+    queue_backoff( spins );
+  }
+}
+
+template< typename T >
+T MpmcQueue< T >::pop()
+{
+  T item;
+  uint spins = 0;
+  while( !try_pop( item ) )
+  {
+    queue_backoff( spins );
+  }
+  return item;
+}
+
+/*
+ * a run of letters on its way through the pipeline
+ */
+struct PipelineChunk
+{
+  uint64_t offset;
+  vector< char > letters;
+  vector< uint > received;
+  vector< uint > decoded;
+};
+
+/*
+ * the time a stage spent working and waiting on its queues
+ */
+struct StageReport
+{
+  uint64_t chunks;
+  chrono::duration< double > busy;
+  chrono::duration< double > waiting;
+};
+
+/**
+ * The demo flow run as a pipeline: read, map to codewords, channel,
+ * decode and compare each run on threads of their own, passing chunks
+ * of PIPELINE_CHUNK letters through bounded queues, so the file is
+ * read while earlier chunks are decoded and a run takes about as long
+ * as its slowest stage. Decoding runs on as many threads as asked,
+ * taking chunks from one queue and handing them on through another,
+ * and the compare stage writes each chunk back at its own offset, so
+ * chunks may finish in any order. The chunks come from a fixed pool
+ * the compare stage returns them to, so once the pool is out the
+ * reader waits: memory stays bounded however long the message. Each
+ * chunk is noised from a seed of its own, so a run is the same for a
+ * seed whatever the number of decoders.
+ * @author agent
+ * @version 18 October 2026
+ */
+class MessagePipeline
+{
+public:
+  /**
+   * Constructor specifying the code and the stages
+   * @param code the code
+   * @param map the map between letters and codewords
+   * @param search the decoder
+   * @param cache a cache of decoded words, or null for none
+   * @param num_decoders the threads decoding
+   * @param errors_per_word the errors the channel puts in each word
+   * @param seed the seed of the channel
+   */
+  MessagePipeline( const LinearCode &code, AlphabetMap &map,
+                   const CodebookSearch &search, const DecodeCache* cache,
+                   uint num_decoders, uint errors_per_word, uint seed );
+
+  /**
+   * send a message file through the pipeline
+   * @param file_name the name of the file
+   * @return whether or not the file could be read
+   */
+  bool run( const string &file_name );
+
+  /**
+   * Return the decoded message
+   */
+  const vector< char >& get_decoded() const;
+
+  /**
+   * Return the number of letters decoded right
+   */
+  uint64_t get_identical() const;
+
+  /**
+   * print the time each stage spent working and waiting
+   * @param out the stream to print to
+   */
+  void print_report( ostream &out ) const;
+
+private:
+
+  /**
+   * read the file into chunks
+   * @param file the file
+   */
+  void read_stage( ifstream &file );
+
+  /**
+   * map letters to codewords
+   */
+  void map_stage();
+
+  /**
+   * put noise into the codewords
+   */
+  void channel_stage();
+
+  /**
+   * decode codewords to messages
+   * @param worker the index of the decoder
+   */
+  void decode_stage( uint worker );
+
+  /**
+   * put the decoded letters in place and count the right ones
+   */
+  void compare_stage();
+
+  const LinearCode &code;
+  AlphabetMap &map;
+  const CodebookSearch &search;
+  const DecodeCache* cache;
+  uint num_decoders;
+  uint errors_per_word;
+  uint seed;
+
+  vector< unique_ptr< PipelineChunk > > pool;
+  SpscQueue< PipelineChunk* > free_chunks;
+  SpscQueue< PipelineChunk* > to_map;
+  SpscQueue< PipelineChunk* > to_channel;
+  MpmcQueue< PipelineChunk* > to_decode;
+  MpmcQueue< PipelineChunk* > to_compare;
+
+  vector< char > decoded;
+  uint64_t identical;
+  chrono::duration< double > elapsed;
+  StageReport read_report;
+  StageReport map_report;
+  StageReport channel_report;
+  vector< StageReport > decode_reports;
+  StageReport compare_report;
+};
+
+MessagePipeline::MessagePipeline( const LinearCode &param_code,
+                                  AlphabetMap &param_map,
+                                  const CodebookSearch &param_search,
+                                  const DecodeCache* param_cache,
+                                  uint param_num_decoders,
+                                  uint param_errors_per_word,
+                                  uint param_seed )
+: code( param_code ), map( param_map ), search( param_search ),
+  cache( param_cache ), num_decoders( max( param_num_decoders, 1u ) ),
+  errors_per_word( param_errors_per_word ), seed( param_seed ),
+  free_chunks( PIPELINE_QUEUE * 4 + num_decoders * 2 ),
+  to_map( PIPELINE_QUEUE ), to_channel( PIPELINE_QUEUE ),
+  to_decode( PIPELINE_QUEUE + num_decoders ),
+  to_compare( PIPELINE_QUEUE + num_decoders ), identical( 0 ),
+  elapsed( 0 ), read_report(), map_report(), channel_report(),
+  compare_report()
+{
+  //enough chunks to fill every queue and keep each stage busy
+  for( uint i = 0; i < PIPELINE_QUEUE * 4 + num_decoders * 2; i++ )
+  {
+    pool.push_back( unique_ptr< PipelineChunk >( new PipelineChunk() ) );
+    pool.back()->letters.reserve( PIPELINE_CHUNK );
+    pool.back()->decoded.reserve( PIPELINE_CHUNK );
+    free_chunks.push( pool.back().get() );
+  }
+}
+
+void MessagePipeline::read_stage( ifstream &file )
+{
+  uint64_t offset = 0;
+  char buffer[ PIPELINE_CHUNK ];
+  while( true )
+  {
+    chrono::steady_clock::time_point wait_start =
+      chrono::steady_clock::now();
+    PipelineChunk* chunk = free_chunks.pop();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    read_report.waiting += start - wait_start;
+
+    {
+      StageTimer timer( STAGE_READ );
+      TraceScope trace( "read chunk", offset );
+      chunk->offset = offset;
+      chunk->letters.clear();
+      while( chunk->letters.size() < PIPELINE_CHUNK )
+      {
+        file.read( buffer, PIPELINE_CHUNK - chunk->letters.size() );
+        if( file.gcount() == 0 )
+        {
+          break;
+        }
+        for( streamsize i = 0; i < file.gcount(); i++ )
+        {
+          if( buffer[ i ] != '\n' )
+          {
+            chunk->letters.push_back( buffer[ i ] );
+          }
+        }
+      }
+    }
+    read_report.busy += chrono::steady_clock::now() - start;
+
+    //an empty chunk is the end of the file; it is not needed again
+    if( chunk->letters.empty() )
+    {
+      to_map.push( nullptr );
+      return;
+    }
+    offset += chunk->letters.size();
+    read_report.chunks++;
+    wait_start = chrono::steady_clock::now();
+    to_map.push( chunk );
+    read_report.waiting += chrono::steady_clock::now() - wait_start;
+  }
+}
+
+void MessagePipeline::map_stage()
+{
+  while( true )
+  {
+    chrono::steady_clock::time_point wait_start =
+      chrono::steady_clock::now();
+    PipelineChunk* chunk = to_map.pop();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    map_report.waiting += start - wait_start;
+    if( chunk == nullptr )
+    {
+      to_channel.push( nullptr );
+      return;
+    }
+
+    {
+      StageTimer timer( STAGE_MAP );
+      TraceScope trace( "map chunk", chunk->offset );
+      chunk->received = map.convert_to_numbers( chunk->letters );
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    map_report.busy += end - start;
+    map_report.chunks++;
+    to_channel.push( chunk );
+    map_report.waiting += chrono::steady_clock::now() - end;
+  }
+}
+
+void MessagePipeline::channel_stage()
+{
+  while( true )
+  {
+    chrono::steady_clock::time_point wait_start =
+      chrono::steady_clock::now();
+    PipelineChunk* chunk = to_channel.pop();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    channel_report.waiting += start - wait_start;
+    if( chunk == nullptr )
+    {
+      //one end marker for each decoder
+      for( uint i = 0; i < num_decoders; i++ )
+      {
+        to_decode.push( nullptr );
+      }
+      return;
+    }
+
+    {
+      StageTimer timer( STAGE_CHANNEL );
+      TraceScope trace( "channel chunk", chunk->offset );
+      random_noise( chunk->received, code.get_code_length(),
+                    errors_per_word,
+                    seed + static_cast< uint >( chunk->offset ) );
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    channel_report.busy += end - start;
+    channel_report.chunks++;
+    to_decode.push( chunk );
+    channel_report.waiting += chrono::steady_clock::now() - end;
+  }
+}
+
+void MessagePipeline::decode_stage( uint worker )
+{
+  StageReport &report = decode_reports[ worker ];
+  while( true )
+  {
+    chrono::steady_clock::time_point wait_start =
+      chrono::steady_clock::now();
+    PipelineChunk* chunk = to_decode.pop();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    report.waiting += start - wait_start;
+    if( chunk == nullptr )
+    {
+      to_compare.push( nullptr );
+      return;
+    }
+
+    {
+      StageTimer timer( STAGE_DECODE );
+      TraceScope trace( "decode chunk", chunk->offset );
+      chunk->decoded.resize( chunk->received.size() );
+      if( cache == nullptr )
+      {
+        search.decode_message_batch( chunk->received, chunk->decoded );
+      }
+      else
+      {
+        cache->decode_batch( search, chunk->received, chunk->decoded );
+        for( uint &word : chunk->decoded )
+        {
+          word = code.extract_message( word );
+        }
+      }
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    report.busy += end - start;
+    report.chunks++;
+    to_compare.push( chunk );
+    report.waiting += chrono::steady_clock::now() - end;
+  }
+}
+
+void MessagePipeline::compare_stage()
+{
+  uint ended = 0;
+  while( ended < num_decoders )
+  {
+    chrono::steady_clock::time_point wait_start =
+      chrono::steady_clock::now();
+    PipelineChunk* chunk = to_compare.pop();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    compare_report.waiting += start - wait_start;
+    if( chunk == nullptr )
+    {
+      ended++;
+      continue;
+    }
+
+    {
+      StageTimer timer( STAGE_COMPARE );
+      TraceScope trace( "compare chunk", chunk->offset );
+      vector< char > letters =
+        map.convert_messages_to_letters( chunk->decoded );
+      if( decoded.size() < chunk->offset + letters.size() )
+      {
+        decoded.resize( chunk->offset + letters.size() );
+      }
+      for( size_t i = 0; i < letters.size(); i++ )
+      {
+        decoded[ chunk->offset + i ] = letters[ i ];
+        identical += letters[ i ] == chunk->letters[ i ];
+      }
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    compare_report.busy += end - start;
+    compare_report.chunks++;
+    free_chunks.push( chunk );
+    compare_report.waiting += chrono::steady_clock::now() - end;
+  }
+}
+
+bool MessagePipeline::run( const string &file_name )
+{
+  ifstream file( file_name, ios::binary );
+  if( !file.is_open() )
+  {
+    cerr << "could not open " << file_name << endl;
+    return false;
+  }
+
+  decoded.clear();
+  identical = 0;
+  read_report = map_report = channel_report = compare_report =
+    StageReport();
+  decode_reports.assign( num_decoders, StageReport() );
+
+  //the compare stage runs here, the rest on threads of their own
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  vector< thread > stages;
+  stages.push_back( thread( &MessagePipeline::read_stage, this,
+                            ref( file ) ) );
+  stages.push_back( thread( &MessagePipeline::map_stage, this ) );
+  stages.push_back( thread( &MessagePipeline::channel_stage, this ) );
+  for( uint i = 0; i < num_decoders; i++ )
+  {
+    stages.push_back( thread( &MessagePipeline::decode_stage, this, i ) );
+  }
+  compare_stage();
+  for( thread &stage : stages )
+  {
+    stage.join();
+  }
+  elapsed = chrono::steady_clock::now() - start;
+
+  //every chunk has come back but the empty one that ended the file;
+  //refill the pool whole for the next run
+  PipelineChunk* chunk;
+  while( free_chunks.try_pop( chunk ) )
+  {
+  }
+  for( unique_ptr< PipelineChunk > &chunk : pool )
+  {
+    free_chunks.push( chunk.get() );
+  }
+  return true;
+}
+
+const vector< char >& MessagePipeline::get_decoded() const
+{
+  return decoded;
+}
+
+uint64_t MessagePipeline::get_identical() const
+{
+  return identical;
+}
+
+void MessagePipeline::print_report( ostream &out ) const
+{
+  //the decoders are reported together, their time summed
+  StageReport decode_report = StageReport();
+  for( const StageReport &report : decode_reports )
+  {
+    decode_report.chunks += report.chunks;
+    decode_report.busy += report.busy;
+    decode_report.waiting += report.waiting;
+  }
+
+  out << "pipeline: " << decoded.size() << " letters in "
+      << compare_report.chunks << " chunks, " << elapsed.count() * 1000
+      << " ms, " << decoded.size() / elapsed.count() << " letters/s"
+      << endl;
+  out << "stage  threads  chunks  busy ms  waiting ms" << endl;
+  const char* names[] = { "read", "map", "channel", "decode", "compare" };
+  const StageReport* reports[] = { &read_report, &map_report,
+                                   &channel_report, &decode_report,
+                                   &compare_report };
+  for( uint i = 0; i < 5; i++ )
+  {
+    out << names[ i ] << "  " << ( i == 3 ? num_decoders : 1 ) << "  "
+        << reports[ i ]->chunks << "  " << reports[ i ]->busy.count() * 1000
+        << "  " << reports[ i ]->waiting.count() * 1000 << endl;
+  }
+}
+
+#endif
@@ -0,0 +1,341 @@
+#ifndef PRODUCT_CODE_H
+#define PRODUCT_CODE_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "bit_kernels.h"
+#include "linear_code.h"
+#include "decoder_tuner.h"
+
+using namespace std;
+
+/*
+ * the row and column passes a block gets before it is given up on
+ */
+const uint PRODUCT_MAX_PASSES = 4;
+
+/**
+ * The product of a row code [n1, k1, d1] and a column code
+ * [n2, k2, d2], an [n1 n2, k1 k2, d1 d2] code whose codewords are the
+ * n2 x n1 arrays with every row a codeword of the row code and every
+ * column a codeword of the column code. A block is kept as n2 words of
+ * n1 bits, one per row, and the columns are reached by a bit transpose
+ * (the transpose bit kernel), so both passes decode whole words. A
+ * burst along a row leaves at most one error in each column, so the
+ * column pass clears bursts the row code alone cannot. Decoding runs
+ * row and column passes in turn, each taking the syndromes of every
+ * line and decoding only the dirty ones as one batch. A line is only
+ * changed when its decoding is within the correction capability, so a
+ * line with too many errors is left for the other direction rather
+ * than moved further from the truth. Decoding stops when a row pass
+ * and a column pass both find every syndrome 0, or after the pass
+ * limit. Both codes must be at most 32 long.
+ * @author agent
+ * @version 18 October 2026
+ */
+class ProductCode
+{
+public:
+  /**
+   * Constructor choosing a decoder for each code
+   * @param row_code the code of the rows, which must outlive this
+   * @param column_code the code of the columns, which must outlive this
+   * @param max_passes the most row and column passes per block
+   */
+  ProductCode( const LinearCode &row_code, const LinearCode &column_code,
+               uint max_passes = PRODUCT_MAX_PASSES );
+
+  /**
+   * Return the number of words in a block, n2
+   */
+  uint get_block_words() const;
+
+  /**
+   * Return the number of message words in a block, k2
+   */
+  uint get_message_words() const;
+
+  /**
+   * Return the code length, n1 n2
+   */
+  uint get_code_length() const;
+
+  /**
+   * Return the dimension, k1 k2
+   */
+  uint get_dimension() const;
+
+  /**
+   * Return the minimum distance, d1 d2
+   */
+  uint get_minimum_distance() const;
+
+  /**
+   * encode a block. does no allocation.
+   * @param messages k2 messages of k1 bits, the rows of the message
+   * @param block the n2 rows of the block
+   */
+  void encode_block( Span< const uint > messages, Span< uint > block ) const;
+
+  /**
+   * decode a block in place. does no allocation.
+   * @param block the n2 rows of the block
+   * @return whether or not every row and column is a codeword
+   */
+  bool decode_block( Span< uint > block ) const;
+
+  /**
+   * decode a run of blocks in place, spread over threads
+   * @param blocks the blocks, n2 rows each
+   * @param num_threads the threads to use
+   * @return the number of blocks left with every line a codeword
+   */
+  uint64_t decode_blocks( Span< uint > blocks, uint num_threads = 1 ) const;
+
+  /**
+   * read the message off a block. does no allocation.
+   * @param block the n2 rows of a codeword
+   * @param messages the k2 messages of k1 bits
+   */
+  void extract_block( Span< const uint > block,
+                      Span< uint > messages ) const;
+
+  /**
+   * determine whether every row and column of a block is a codeword
+   * @param block the n2 rows of the block
+   * @return whether or not it is a codeword of the product
+   */
+  bool is_code_block( Span< const uint > block ) const;
+
+private:
+
+  /**
+   * decode the dirty lines of one direction in place
+   * @param lines the lines
+   * @param num_lines the number of lines
+   * @param code the code of the lines
+   * @param decoder its decoder
+   * @return whether or not every line was already a codeword
+   */
+  bool decode_lines( uint* lines, uint num_lines, const LinearCode &code,
+                     const TunedDecoder &decoder ) const;
+
+  const LinearCode &row_code;
+  const LinearCode &column_code;
+  TunedDecoder row_decoder;
+  TunedDecoder column_decoder;
+  uint row_length;
+  uint column_length;
+  uint max_passes;
+};
+
+ProductCode::ProductCode( const LinearCode &param_row_code,
+                          const LinearCode &param_column_code,
+                          uint param_max_passes )
+: row_code( param_row_code ), column_code( param_column_code ),
+  row_decoder( param_row_code ), column_decoder( param_column_code ),
+  row_length( param_row_code.get_code_length() ),
+  column_length( param_column_code.get_code_length() ),
+  max_passes( max( param_max_passes, 1u ) )
+{
+}
+
+uint ProductCode::get_block_words() const
+{
+  return column_length;
+}
+
+uint ProductCode::get_message_words() const
+{
+  return column_code.get_dimension();
+}
+
+uint ProductCode::get_code_length() const
+{
+  return row_length * column_length;
+}
+
+uint ProductCode::get_dimension() const
+{
+  return row_code.get_dimension() * column_code.get_dimension();
+}
+
+uint ProductCode::get_minimum_distance() const
+{
+  return row_code.get_minimum_distance() *
+    column_code.get_minimum_distance();
+}
+
+void ProductCode::encode_block( Span< const uint > messages,
+                                Span< uint > block ) const
+{
+  //encode the message rows, then each column of those, then turn the
+  //columns back into rows
+  uint message_words = column_code.get_dimension();
+  uint rows[ 32 ];
+  uint columns[ 32 ];
+  row_code.encode_batch( messages, Span< uint >( rows, message_words ) );
+  bit_kernels().transpose( rows, message_words, row_length, columns );
+  for( uint c = 0; c < row_length; c++ )
+  {
+    columns[ c ] = column_code.encode_word( columns[ c ] );
+  }
+  bit_kernels().transpose( columns, row_length, column_length,
+                           block.data() );
+}
+
+bool ProductCode::decode_lines( uint* lines, uint num_lines,
+                                const LinearCode &code,
+                                const TunedDecoder &decoder ) const
+{
+  //gather the dirty lines and decode them as one batch
+  uint syndromes[ 32 ];
+  uint dirty[ 32 ];
+  uint received[ 32 ];
+  uint decoded[ 32 ];
+  code.syndrome_batch( Span< const uint >( lines, num_lines ),
+                       Span< uint >( syndromes, num_lines ) );
+  uint num_dirty = 0;
+  for( uint i = 0; i < num_lines; i++ )
+  {
+    if( syndromes[ i ] != 0 )
+    {
+      dirty[ num_dirty ] = i;
+      received[ num_dirty ] = lines[ i ];
+      num_dirty++;
+    }
+  }
+  if( num_dirty == 0 )
+  {
+    return true;
+  }
+
+  decoder.decode_batch( Span< const uint >( received, num_dirty ),
+                        Span< uint >( decoded, num_dirty ) );
+  uint correctable = code.get_correction_capability();
+  for( uint i = 0; i < num_dirty; i++ )
+  {
+    if( static_cast< uint >( __builtin_popcount( received[ i ] ^
+                                                 decoded[ i ] ) ) <=
+        correctable )
+    {
+      lines[ dirty[ i ] ] = decoded[ i ];
+    }
+  }
+  return false;
+}
+
+bool ProductCode::decode_block( Span< uint > block ) const
+{
+  uint columns[ 32 ];
+  for( uint pass = 0; pass < max_passes; pass++ )
+  {
+    bool rows_clean = decode_lines( block.data(), column_length, row_code,
+                                    row_decoder );
+    bit_kernels().transpose( block.data(), column_length, row_length,
+                             columns );
+    bool columns_clean = decode_lines( columns, row_length, column_code,
+                                       column_decoder );
+    if( rows_clean and columns_clean )
+    {
+      return true;
+    }
+    bit_kernels().transpose( columns, row_length, column_length,
+                             block.data() );
+  }
+
+  //the last column pass may have cleaned every row as well
+  bool clean = is_code_block( Span< const uint >( block.data(),
+                                                  block.size() ) );
+  if( CodecStats::is_enabled() and !clean )
+  {
+    CodecStats::count( DECODE_FAILURES );
+  }
+  return clean;
+}
+
+uint64_t ProductCode::decode_blocks( Span< uint > blocks,
+                                     uint num_threads ) const
+{
+  TraceScope trace( "product decode", blocks.size() / column_length );
+  uint64_t num_blocks = blocks.size() / column_length;
+  num_threads = max( 1u, static_cast< uint >(
+    min( static_cast< uint64_t >( num_threads ), num_blocks ) ) );
+  atomic< uint64_t > clean( 0 );
+
+  //each thread takes an even share of the blocks
+  auto decode_share = [ & ]( uint thread_index )
+  {
+    uint64_t first = num_blocks * thread_index / num_threads;
+    uint64_t last = num_blocks * ( thread_index + 1 ) / num_threads;
+    uint64_t share_clean = 0;
+    for( uint64_t b = first; b < last; b++ )
+    {
+      share_clean += decode_block( Span< uint >(
+        blocks.data() + b * column_length, column_length ) );
+    }
+    clean += share_clean;
+  };
+
+  vector< thread > workers;
+  for( uint t = 1; t < num_threads; t++ )
+  {
+    workers.push_back( thread( decode_share, t ) );
+  }
+  decode_share( 0 );
+  for( thread &worker : workers )
+  {
+    worker.join();
+  }
+  return clean;
+}
+
+void ProductCode::extract_block( Span< const uint > block,
+                                 Span< uint > messages ) const
+{
+  //the column messages are the first k2 rows of the row encoding
+  uint message_words = column_code.get_dimension();
+  uint columns[ 32 ];
+  uint rows[ 32 ];
+  bit_kernels().transpose( block.data(), column_length, row_length,
+                           columns );
+  for( uint c = 0; c < row_length; c++ )
+  {
+    columns[ c ] = column_code.extract_message( columns[ c ] );
+  }
+  bit_kernels().transpose( columns, row_length, message_words, rows );
+  for( uint r = 0; r < message_words; r++ )
+  {
+    messages[ r ] = row_code.extract_message( rows[ r ] );
+  }
+}
+
+bool ProductCode::is_code_block( Span< const uint > block ) const
+{
+  uint columns[ 32 ];
+  for( uint r = 0; r < column_length; r++ )
+  {
+    if( row_code.syndrome( block[ r ] ) != 0 )
+    {
+      return false;
+    }
+  }
+  bit_kernels().transpose( block.data(), column_length, row_length,
+                           columns );
+  for( uint c = 0; c < row_length; c++ )
+  {
+    if( column_code.syndrome( columns[ c ] ) != 0 )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,950 @@
+#ifndef QARY_CODE_H
+#define QARY_CODE_H
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include "galois_field.h"
+#include "gf_region.h"
+#include "word_span.h"
+#include "codec_stats.h"
+
+using namespace std;
+
+/*
+ * a word of packed GF(2^m) symbols, 8 / m to a byte
+ */
+typedef vector< uint8_t > QaryWord;
+
+/*
+ * the most codewords enumerated to find the minimum distance
+ */
+const uint64_t QARY_ENUMERATION_LIMIT = 1 << 16;
+
+/*
+ * the most error patterns put in the syndrome table, and the heaviest
+ */
+const uint64_t QARY_TABLE_LIMIT = 1 << 22;
+const uint QARY_MAX_TABLE_ERRORS = 4;
+
+/**
+ * A linear code over GF(q), q = 2^m for m = 1, 2, 4 or 8, with its
+ * words stored as packed symbols. The generator matrix is put in rref
+ * over the field; its pivot columns are the information set, so
+ * encoding is systematic there and the parity check matrix is
+ * ( A^T | I ) on the columns where G is ( I | A ), as in Ling and Xing
+ * 4.3 (the sign vanishes in characteristic 2). Every row operation,
+ * encoding and syndrome is a region multiply-add, done by the SIMD
+ * kernels of GfRegion. Decoding looks up the syndrome of the received
+ * word in a table of the error patterns of weight at most t. A
+ * Reed-Solomon code from reed_solomon() is decoded algebraically
+ * instead, for any t: the 2t power sum syndromes are one more region
+ * multiply-add per place, then Berlekamp-Massey finds the error
+ * locator, a Chien search its roots and Forney's formula the error
+ * values.
+ * @author agent
+ * @version 18 October 2026
+ */
+class QaryLinearCode
+{
+public:
+  /**
+   * Constructor specifying the generator matrix
+   * @param field the field, which must outlive the code
+   * @param generator the rows of the generator matrix, packed
+   * @param code_length the length of the code
+   * @param minimum_distance the minimum distance if known, otherwise
+   * 0 to find it by enumerating the codewords when there are few
+   * enough
+   */
+  QaryLinearCode( const GaloisField &field, vector< QaryWord > generator,
+                  uint code_length, uint minimum_distance = 0 );
+
+  /**
+   * create the Reed-Solomon code of length q - 1: the evaluations of
+   * the polynomials of degree less than k at the nonzero elements.
+   * it is decoded with Berlekamp-Massey, so every pattern of at most
+   * ( n - k ) / 2 symbol errors is corrected.
+   * @param field the field
+   * @param dimension k
+   * @return the code, of minimum distance n - k + 1
+   */
+  static QaryLinearCode reed_solomon( const GaloisField &field,
+                                      uint dimension );
+
+  /**
+   * Return the region arithmetic of the field
+   */
+  const GfRegion& get_region() const;
+
+  /**
+   * Return the code length
+   */
+  uint get_code_length() const;
+
+  /**
+   * Return the dimension of the code
+   */
+  uint get_dimension() const;
+
+  /**
+   * Return the minimum distance of the code, or 0 if it is unknown
+   */
+  uint get_minimum_distance() const;
+
+  /**
+   * Return the number of errors the code is guaranteed to correct
+   */
+  uint get_correction_capability() const;
+
+  /**
+   * Return the generator matrix in rref
+   */
+  const vector< QaryWord >& get_generator() const;
+
+  /**
+   * Return the parity check matrix
+   */
+  const vector< QaryWord >& get_parity_check() const;
+
+  /**
+   * Return the bytes a packed codeword takes
+   */
+  uint get_word_bytes() const;
+
+  /**
+   * Return the bytes a packed message takes
+   */
+  uint get_message_bytes() const;
+
+  /**
+   * encode a message
+   * @param message the k packed message symbols
+   * @return the codeword
+   */
+  QaryWord encode_word( const QaryWord &message ) const;
+
+  /**
+   * encode a batch of messages, packed one after another
+   * @param messages the messages, get_message_bytes() each
+   * @param code_words the codewords, get_word_bytes() each
+   */
+  void encode_batch( Span< const uint8_t > messages,
+                     Span< uint8_t > code_words ) const;
+
+  /**
+   * determine the syndrome of a word
+   * @param word the packed word
+   * @param syndrome the n - k packed syndrome symbols
+   */
+  void syndrome( const uint8_t* word, uint8_t* syndrome ) const;
+
+  /**
+   * determine if a word is part of the code
+   * @param word the packed word
+   * @return if it is a codeword or not
+   */
+  bool is_code_word( const QaryWord &word ) const;
+
+  /**
+   * read the message off the information set of a codeword
+   * @param code_word the codeword
+   * @return the packed message
+   */
+  QaryWord extract_message( const QaryWord &code_word ) const;
+
+  /**
+   * correct a received word in place
+   * @param word the received word, replaced by the decoded codeword
+   * @return the number of symbol errors corrected, or -1 if the
+   * syndrome is not that of an error of weight at most t, in which
+   * case the word is left as it is
+   */
+  int decode_word( QaryWord &word ) const;
+
+  /**
+   * correct a batch of received words in place, packed one after
+   * another
+   * @param words the received words, get_word_bytes() each
+   * @param corrected the symbol errors corrected in each word, or -1
+   */
+  void decode_batch( Span< uint8_t > words, Span< int > corrected ) const;
+
+  /**
+   * print a matrix of packed rows, one symbol per column
+   * @param matrix the matrix
+   */
+  void print_matrix( const vector< QaryWord > &matrix ) const;
+
+private:
+
+  /**
+   * Constructor choosing how the code is decoded
+   * @param field the field, which must outlive the code
+   * @param generator the rows of the generator matrix, packed
+   * @param code_length the length of the code
+   * @param minimum_distance the minimum distance, or 0
+   * @param reed_solomon whether or not it is the Reed-Solomon code of
+   * reed_solomon(), decoded algebraically rather than by table
+   */
+  QaryLinearCode( const GaloisField &field, vector< QaryWord > generator,
+                  uint code_length, uint minimum_distance,
+                  bool reed_solomon );
+
+  /**
+   * put the generator in rref and record its pivot columns
+   */
+  void row_reduce();
+
+  /**
+   * build the parity check matrix from the rref generator
+   */
+  void build_parity_check();
+
+  /**
+   * find the minimum distance by enumerating the codewords
+   */
+  void find_minimum_distance();
+
+  /**
+   * build the packed syndromes of every symbol at every place, and
+   * the table of the error patterns of weight at most t
+   */
+  void build_syndrome_table();
+
+  /**
+   * insert every extension of a partial error pattern
+   * @param remaining the places still to add
+   * @param next the lowest place that may be added
+   * @param partial_key the packed syndrome of the partial pattern
+   * @param partial_pattern the partial pattern, 16 bits a place
+   * @param weight the weight of the finished patterns
+   */
+  void insert_patterns( uint remaining, uint next, uint64_t partial_key,
+                        uint64_t partial_pattern, uint weight );
+
+  /**
+   * find the packed syndrome of a word through the symbol syndromes
+   * @param word the packed word
+   * @return the packed syndrome
+   */
+  uint64_t syndrome_key( const uint8_t* word ) const;
+
+  /**
+   * decode one packed word in place
+   * @param word the packed word
+   * @return the symbol errors corrected, or -1
+   */
+  int decode_packed( uint8_t* word ) const;
+
+  /**
+   * build the packed powers alpha^( i j ), i = 1 .. n - k, of every
+   * place j, whose sum weighted by a word is its power sum syndromes
+   */
+  void build_power_columns();
+
+  /**
+   * decode one packed word of a Reed-Solomon code in place
+   * @param word the packed word
+   * @return the symbol errors corrected, or -1
+   */
+  int decode_reed_solomon( uint8_t* word ) const;
+
+  const GaloisField &field;
+  GfRegion region;
+  vector< QaryWord > generator;
+  vector< QaryWord > parity_check;
+  vector< QaryWord > parity_columns;
+  vector< uint > pivots;
+  uint code_length;
+  uint minimum_distance;
+  uint word_bytes;
+  uint message_bytes;
+  uint table_errors;
+  vector< uint64_t > symbol_keys;
+  unordered_map< uint64_t, uint64_t > syndrome_table;
+  bool reed_solomon_decoding;
+  vector< QaryWord > power_columns;
+};
+
+QaryLinearCode::QaryLinearCode( const GaloisField &param_field,
+                                vector< QaryWord > param_generator,
+                                uint param_code_length,
+                                uint param_minimum_distance )
+: QaryLinearCode( param_field, move( param_generator ), param_code_length,
+                  param_minimum_distance, false )
+{
+}
+
+QaryLinearCode::QaryLinearCode( const GaloisField &param_field,
+                                vector< QaryWord > param_generator,
+                                uint param_code_length,
+                                uint param_minimum_distance,
+                                bool param_reed_solomon )
+: field( param_field ), region( param_field ),
+  generator( move( param_generator ) ), code_length( param_code_length ),
+  minimum_distance( param_minimum_distance ), table_errors( 0 ),
+  reed_solomon_decoding( param_reed_solomon )
+{
+  TraceScope trace( "qary code build" );
+  if( !region.is_valid() )
+  {
+    //the region printed why; an empty code encodes and decodes nothing
+    generator.clear();
+    code_length = 0;
+    word_bytes = 0;
+    message_bytes = 0;
+    return;
+  }
+  word_bytes = region.get_packed_bytes( code_length );
+  for( QaryWord &row : generator )
+  {
+    row.resize( word_bytes, 0 );
+  }
+
+  row_reduce();
+  message_bytes = region.get_packed_bytes( generator.size() );
+  build_parity_check();
+  if( minimum_distance == 0 )
+  {
+    find_minimum_distance();
+  }
+  if( reed_solomon_decoding )
+  {
+    build_power_columns();
+  }
+  else
+  {
+    build_syndrome_table();
+  }
+}
+
+QaryLinearCode QaryLinearCode::reed_solomon( const GaloisField &field,
+                                             uint dimension )
+{
+  //row i evaluates x^i, so coordinate j is alpha^( i j )
+  GfRegion region( field );
+  uint code_length = field.get_order();
+  vector< QaryWord > generator;
+  for( uint i = 0; i < dimension; i++ )
+  {
+    QaryWord row( region.get_packed_bytes( code_length ), 0 );
+    for( uint j = 0; j < code_length; j++ )
+    {
+      region.set_symbol( row.data(), j, field.alpha_power( i * j ) );
+    }
+    generator.push_back( row );
+  }
+  return QaryLinearCode( field, generator, code_length,
+                         code_length - dimension + 1, true );
+}
+
+void QaryLinearCode::row_reduce()
+{
+  //gauss-jordan over the field, one region operation per row
+  uint row = 0;
+  for( uint col = 0; col < code_length and row < generator.size(); col++ )
+  {
+    uint pivot_row = row;
+    while( pivot_row < generator.size() and
+           region.get_symbol( generator.at( pivot_row ).data(), col ) == 0 )
+    {
+      pivot_row++;
+    }
+    if( pivot_row == generator.size() )
+    {
+      continue;
+    }
+    swap( generator.at( row ), generator.at( pivot_row ) );
+    uint8_t* pivot = generator.at( row ).data();
+    region.multiply( pivot,
+                     field.inverse( region.get_symbol( pivot, col ) ),
+                     word_bytes );
+    for( uint other = 0; other < generator.size(); other++ )
+    {
+      uint value = region.get_symbol( generator.at( other ).data(), col );
+      if( other != row and value != 0 )
+      {
+        region.multiply_add( generator.at( other ).data(), pivot, value,
+                             word_bytes );
+      }
+    }
+    pivots.push_back( col );
+    row++;
+  }
+
+  //the remaining rows are combinations of the first ones
+  if( row < generator.size() )
+  {
+    cout << "the generator rows are dependent; keeping " << row
+         << " of them." << endl;
+    generator.resize( row );
+  }
+}
+
+void QaryLinearCode::build_parity_check()
+{
+  //row j of H has a 1 at the j-th non pivot column and, at pivot
+  //column i, the symbol of row i of G at that column
+  vector< bool > is_pivot( code_length, false );
+  for( uint pivot : pivots )
+  {
+    is_pivot.at( pivot ) = true;
+  }
+  for( uint col = 0; col < code_length; col++ )
+  {
+    if( is_pivot.at( col ) )
+    {
+      continue;
+    }
+    QaryWord row( word_bytes, 0 );
+    region.set_symbol( row.data(), col, 1 );
+    for( uint i = 0; i < pivots.size(); i++ )
+    {
+      region.set_symbol( row.data(), pivots.at( i ),
+                         region.get_symbol( generator.at( i ).data(), col ) );
+    }
+    parity_check.push_back( row );
+  }
+
+  //the columns of H, packed, for the syndrome as a sum of columns
+  uint redundancy = parity_check.size();
+  for( uint col = 0; col < code_length; col++ )
+  {
+    QaryWord column( region.get_packed_bytes( redundancy ), 0 );
+    for( uint r = 0; r < redundancy; r++ )
+    {
+      region.set_symbol(
+        column.data(), r,
+        region.get_symbol( parity_check.at( r ).data(), col ) );
+    }
+    parity_columns.push_back( column );
+  }
+}
+
+void QaryLinearCode::find_minimum_distance()
+{
+  uint size = field.get_size();
+  uint64_t num_messages = 1;
+  for( uint i = 0; i < generator.size(); i++ )
+  {
+    num_messages *= size;
+    if( num_messages > QARY_ENUMERATION_LIMIT )
+    {
+      cout << "too many codewords to find the minimum distance." << endl;
+      return;
+    }
+  }
+
+  //count the weight of every nonzero codeword
+  QaryWord message( message_bytes, 0 );
+  for( uint64_t index = 1; index < num_messages; index++ )
+  {
+    uint64_t digits = index;
+    for( uint i = 0; i < generator.size(); i++ )
+    {
+      region.set_symbol( message.data(), i, digits % size );
+      digits /= size;
+    }
+    QaryWord code_word = encode_word( message );
+    uint weight = 0;
+    for( uint place = 0; place < code_length; place++ )
+    {
+      if( region.get_symbol( code_word.data(), place ) != 0 )
+      {
+        weight++;
+      }
+    }
+    if( minimum_distance == 0 or weight < minimum_distance )
+    {
+      minimum_distance = weight;
+    }
+  }
+}
+
+void QaryLinearCode::build_syndrome_table()
+{
+  uint redundancy = parity_check.size();
+  uint degree = field.get_degree();
+  if( redundancy * degree > 64 or code_length > 256 )
+  {
+    cout << "syndromes too long for the table; decoding disabled." << endl;
+    return;
+  }
+
+  //the packed syndrome of symbol v at place p is v times column p
+  uint size = field.get_size();
+  symbol_keys.assign( code_length * size, 0 );
+  for( uint place = 0; place < code_length; place++ )
+  {
+    for( uint value = 1; value < size; value++ )
+    {
+      uint64_t key = 0;
+      //a column is at most 8 bytes, as checked above
+      QaryWord product( 8, 0 );
+      region.multiply_add( product.data(), parity_columns.at( place ).data(),
+                           value, min< size_t >( 8,
+                             parity_columns.at( place ).size() ) );
+      memcpy( &key, product.data(), 8 );
+      symbol_keys[ place * size + value ] = key;
+    }
+  }
+
+  //tabulate whole weights only, within the size limit
+  uint64_t num_patterns = 0;
+  uint64_t choose = 1;
+  for( uint weight = 1; weight <= get_correction_capability() and
+         weight <= QARY_MAX_TABLE_ERRORS; weight++ )
+  {
+    choose = choose * ( code_length - weight + 1 ) / weight * ( size - 1 );
+    if( num_patterns + choose > QARY_TABLE_LIMIT )
+    {
+      cout << "syndrome table limited to " << table_errors
+           << " errors." << endl;
+      break;
+    }
+    num_patterns += choose;
+    table_errors = weight;
+  }
+  syndrome_table.reserve( num_patterns );
+  for( uint weight = 1; weight <= table_errors; weight++ )
+  {
+    insert_patterns( weight, 0, 0, 0, weight );
+  }
+}
+
+void QaryLinearCode::insert_patterns( uint remaining, uint next,
+                                      uint64_t partial_key,
+                                      uint64_t partial_pattern,
+                                      uint weight )
+{
+  uint size = field.get_size();
+  if( remaining == 0 )
+  {
+    //a syndrome reached by two patterns of the same least weight is
+    //ambiguous and kept as the empty pattern
+    unordered_map< uint64_t, uint64_t >::iterator it =
+      syndrome_table.find( partial_key );
+    if( it == syndrome_table.end() )
+    {
+      syndrome_table.insert( { partial_key, partial_pattern } );
+    }
+    else if( it->second != 0 )
+    {
+      uint existing = 0;
+      for( uint64_t rest = it->second; rest != 0; rest >>= 16 )
+      {
+        existing++;
+      }
+      if( existing == weight )
+      {
+        it->second = 0;
+      }
+    }
+    return;
+  }
+  for( uint place = next; place + remaining <= code_length; place++ )
+  {
+    for( uint value = 1; value < size; value++ )
+    {
+      insert_patterns( remaining - 1, place + 1,
+                       partial_key ^ symbol_keys[ place * size + value ],
+                       ( partial_pattern << 16 ) | ( place << 8 ) | value,
+                       weight );
+    }
+  }
+}
+
+const GfRegion& QaryLinearCode::get_region() const
+{
+  return region;
+}
+
+uint QaryLinearCode::get_code_length() const
+{
+  return code_length;
+}
+
+uint QaryLinearCode::get_dimension() const
+{
+  return generator.size();
+}
+
+uint QaryLinearCode::get_minimum_distance() const
+{
+  return minimum_distance;
+}
+
+uint QaryLinearCode::get_correction_capability() const
+{
+  if( minimum_distance == 0 )
+  {
+    return 0;
+  }
+  return ( minimum_distance - 1 ) / 2;
+}
+
+const vector< QaryWord >& QaryLinearCode::get_generator() const
+{
+  return generator;
+}
+
+const vector< QaryWord >& QaryLinearCode::get_parity_check() const
+{
+  return parity_check;
+}
+
+uint QaryLinearCode::get_word_bytes() const
+{
+  return word_bytes;
+}
+
+uint QaryLinearCode::get_message_bytes() const
+{
+  return message_bytes;
+}
+
+QaryWord QaryLinearCode::encode_word( const QaryWord &message ) const
+{
+  QaryWord code_word( word_bytes, 0 );
+  encode_batch( Span< const uint8_t >( message.data(), message_bytes ),
+                Span< uint8_t >( code_word ) );
+  return code_word;
+}
+
+void QaryLinearCode::encode_batch( Span< const uint8_t > messages,
+                                   Span< uint8_t > code_words ) const
+{
+  //the sum of the rows of G weighted by the message symbols
+  size_t num_words = messages.size() / message_bytes;
+  for( size_t w = 0; w < num_words; w++ )
+  {
+    const uint8_t* message = messages.data() + w * message_bytes;
+    uint8_t* code_word = code_words.data() + w * word_bytes;
+    memset( code_word, 0, word_bytes );
+    for( uint i = 0; i < generator.size(); i++ )
+    {
+      region.multiply_add( code_word, generator[ i ].data(),
+                           region.get_symbol( message, i ), word_bytes );
+    }
+  }
+  CodecStats::count( WORDS_ENCODED, num_words );
+}
+
+void QaryLinearCode::syndrome( const uint8_t* word,
+                               uint8_t* syndrome ) const
+{
+  //the sum of the columns of H weighted by the word's symbols
+  size_t syndrome_bytes = region.get_packed_bytes( parity_check.size() );
+  memset( syndrome, 0, syndrome_bytes );
+  for( uint place = 0; place < code_length; place++ )
+  {
+    region.multiply_add( syndrome, parity_columns[ place ].data(),
+                         region.get_symbol( word, place ), syndrome_bytes );
+  }
+}
+
+bool QaryLinearCode::is_code_word( const QaryWord &word ) const
+{
+  QaryWord result( region.get_packed_bytes( parity_check.size() ), 0 );
+  syndrome( word.data(), result.data() );
+  for( uint8_t byte : result )
+  {
+    if( byte != 0 )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+QaryWord QaryLinearCode::extract_message( const QaryWord &code_word ) const
+{
+  //G is the identity on the pivot columns
+  QaryWord message( message_bytes, 0 );
+  for( uint i = 0; i < pivots.size(); i++ )
+  {
+    region.set_symbol( message.data(), i,
+                       region.get_symbol( code_word.data(), pivots[ i ] ) );
+  }
+  return message;
+}
+
+uint64_t QaryLinearCode::syndrome_key( const uint8_t* word ) const
+{
+  uint size = field.get_size();
+  uint64_t key = 0;
+  for( uint place = 0; place < code_length; place++ )
+  {
+    key ^= symbol_keys[ place * size + region.get_symbol( word, place ) ];
+  }
+  return key;
+}
+
+void QaryLinearCode::build_power_columns()
+{
+  uint checks = code_length - generator.size();
+  for( uint place = 0; place < code_length; place++ )
+  {
+    QaryWord column( region.get_packed_bytes( checks ), 0 );
+    for( uint i = 1; i <= checks; i++ )
+    {
+      region.set_symbol( column.data(), i - 1,
+                         field.alpha_power( i * place ) );
+    }
+    power_columns.push_back( column );
+  }
+}
+
+int QaryLinearCode::decode_reed_solomon( uint8_t* word ) const
+{
+  //S_i = r( alpha^i ) for i = 1 .. n - k, every one 0 just for a
+  //codeword. the first 2t find the errors
+  uint correctable = get_correction_capability();
+  uint redundancy = code_length - generator.size();
+  uint checks = 2 * correctable;
+  size_t syndrome_bytes = region.get_packed_bytes( redundancy );
+  uint8_t packed[ 256 ];
+  memset( packed, 0, syndrome_bytes );
+  for( uint place = 0; place < code_length; place++ )
+  {
+    region.multiply_add( packed, power_columns[ place ].data(),
+                         region.get_symbol( word, place ), syndrome_bytes );
+  }
+  uint syndromes[ 256 ];
+  bool clean = true;
+  for( uint i = 1; i <= redundancy; i++ )
+  {
+    syndromes[ i ] = region.get_symbol( packed, i - 1 );
+    clean = clean and syndromes[ i ] == 0;
+  }
+  if( clean )
+  {
+    return 0;
+  }
+
+  //berlekamp-massey, as in BCHCode, for the locator of the X_l^-1
+  uint locator[ 256 ] = { 0 };
+  uint previous[ 256 ] = { 0 };
+  uint scratch[ 256 ];
+  locator[ 0 ] = 1;
+  previous[ 0 ] = 1;
+  uint degree = 0;
+  uint shift = 1;
+  uint previous_discrepancy = 1;
+  for( uint r = 0; r < checks; r++ )
+  {
+    uint discrepancy = syndromes[ r + 1 ];
+    for( uint i = 1; i <= degree; i++ )
+    {
+      discrepancy ^= field.multiply( locator[ i ], syndromes[ r + 1 - i ] );
+    }
+    if( discrepancy == 0 )
+    {
+      shift++;
+      continue;
+    }
+    uint scale = field.divide( discrepancy, previous_discrepancy );
+    bool lengthen = 2 * degree <= r;
+    if( lengthen )
+    {
+      memcpy( scratch, locator, ( checks + 1 ) * sizeof( uint ) );
+    }
+    for( uint i = 0; i + shift <= checks; i++ )
+    {
+      locator[ i + shift ] ^= field.multiply( scale, previous[ i ] );
+    }
+    if( lengthen )
+    {
+      degree = r + 1 - degree;
+      memcpy( previous, scratch, ( checks + 1 ) * sizeof( uint ) );
+      previous_discrepancy = discrepancy;
+      shift = 1;
+    }
+    else
+    {
+      shift++;
+    }
+  }
+  if( degree > correctable )
+  {
+    return -1;
+  }
+
+  //chien search: term i holds locator_i alpha^( -i j ) at place j
+  uint order = field.get_order();
+  uint terms[ 256 ];
+  uint steps[ 256 ];
+  for( uint i = 0; i <= degree; i++ )
+  {
+    terms[ i ] = locator[ i ];
+    steps[ i ] = field.alpha_power( order - i % order );
+  }
+  uint positions[ 256 ];
+  uint num_positions = 0;
+  for( uint place = 0; place < code_length; place++ )
+  {
+    uint value = 0;
+    for( uint i = 0; i <= degree; i++ )
+    {
+      value ^= terms[ i ];
+      terms[ i ] = field.multiply( terms[ i ], steps[ i ] );
+    }
+    if( value == 0 )
+    {
+      positions[ num_positions++ ] = place;
+    }
+  }
+  if( num_positions != degree )
+  {
+    return -1;
+  }
+
+  //forney: with the first root alpha^1, e_l = omega( X_l^-1 ) /
+  //locator'( X_l^-1 ), where omega = S locator mod x^2t
+  uint evaluator[ 256 ];
+  for( uint i = 0; i < checks; i++ )
+  {
+    evaluator[ i ] = 0;
+    for( uint j = 0; j <= min( i, degree ); j++ )
+    {
+      evaluator[ i ] ^= field.multiply( locator[ j ], syndromes[ i - j + 1 ] );
+    }
+  }
+  uint values[ 256 ];
+  for( uint l = 0; l < num_positions; l++ )
+  {
+    uint inverse = field.alpha_power( order - positions[ l ] );
+    uint numerator = 0;
+    uint power = 1;
+    for( uint i = 0; i < checks; i++ )
+    {
+      numerator ^= field.multiply( evaluator[ i ], power );
+      power = field.multiply( power, inverse );
+    }
+    //in characteristic 2 the derivative keeps the odd terms
+    uint denominator = 0;
+    uint square = field.multiply( inverse, inverse );
+    power = 1;
+    for( uint i = 1; i <= degree; i += 2 )
+    {
+      denominator ^= field.multiply( locator[ i ], power );
+      power = field.multiply( power, square );
+    }
+    if( denominator == 0 )
+    {
+      return -1;
+    }
+    values[ l ] = field.divide( numerator, denominator );
+  }
+
+  //when n - k is odd the last syndrome was not used, so the errors
+  //found must give it too
+  for( uint i = checks + 1; i <= redundancy; i++ )
+  {
+    uint expected = 0;
+    for( uint l = 0; l < num_positions; l++ )
+    {
+      expected ^= field.multiply( values[ l ],
+                                  field.alpha_power( i * positions[ l ] ) );
+    }
+    if( expected != syndromes[ i ] )
+    {
+      return -1;
+    }
+  }
+
+  //the word is only changed once every error value is found
+  for( uint l = 0; l < num_positions; l++ )
+  {
+    uint place = positions[ l ];
+    region.set_symbol( word, place,
+                       region.get_symbol( word, place ) ^ values[ l ] );
+  }
+  return degree;
+}
+
+int QaryLinearCode::decode_packed( uint8_t* word ) const
+{
+  int corrected = -1;
+  if( reed_solomon_decoding )
+  {
+    corrected = decode_reed_solomon( word );
+  }
+  else if( !symbol_keys.empty() )
+  {
+    uint64_t key = syndrome_key( word );
+    if( key == 0 )
+    {
+      corrected = 0;
+    }
+    else
+    {
+      unordered_map< uint64_t, uint64_t >::const_iterator it =
+        syndrome_table.find( key );
+      if( it != syndrome_table.end() and it->second != 0 )
+      {
+        //subtract, that is add, each error symbol
+        corrected = 0;
+        for( uint64_t rest = it->second; rest != 0; rest >>= 16 )
+        {
+          uint place = ( rest >> 8 ) & 0xFF;
+          uint value = rest & 0xFF;
+          region.set_symbol( word, place,
+                             region.get_symbol( word, place ) ^ value );
+          corrected++;
+        }
+      }
+    }
+  }
+
+  if( CodecStats::is_enabled() )
+  {
+    CodecStats::count( WORDS_DECODED );
+    if( corrected < 0 )
+    {
+      CodecStats::count( DECODE_FAILURES );
+    }
+    else
+    {
+      CodecStats::count( ERRORS_CORRECTED, corrected );
+      if( corrected > 0 and !reed_solomon_decoding )
+      {
+        CodecStats::count( SYNDROME_TABLE_HITS );
+      }
+    }
+  }
+  return corrected;
+}
+
+int QaryLinearCode::decode_word( QaryWord &word ) const
+{
+  return decode_packed( word.data() );
+}
+
+void QaryLinearCode::decode_batch( Span< uint8_t > words,
+                                   Span< int > corrected ) const
+{
+  size_t num_words = words.size() / word_bytes;
+  for( size_t w = 0; w < num_words; w++ )
+  {
+    corrected[ w ] = decode_packed( words.data() + w * word_bytes );
+  }
+}
+
+void QaryLinearCode::print_matrix( const vector< QaryWord > &matrix ) const
+{
+  for( const QaryWord &row : matrix )
+  {
+    for( uint place = 0; place < code_length; place++ )
+    {
+      cout << region.get_symbol( row.data(), place ) << " ";
+    }
+    cout << endl;
+  }
+  cout << endl;
+}
+
+#endif
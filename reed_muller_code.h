@@ -0,0 +1,304 @@
+#ifndef REED_MULLER_CODE_H
+#define REED_MULLER_CODE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "long_word.h"
+#include "word_span.h"
+#include "codec_stats.h"
+#include "linear_code.h"
+
+using namespace std;
+
+/*
+ * the number of received words the batch decoder transforms together
+ */
+const uint HADAMARD_LANES = 8;
+
+/**
+ * The first order Reed-Muller code RM(1,m) of length n = 2^m and
+ * dimension m + 1. Coordinate x of the codeword of message
+ * ( u, a ), u the low m bits and a bit m, is u.x + a: the affine
+ * function u.x + a evaluated at x. Decoding is maximum likelihood
+ * through the fast Walsh-Hadamard transform of the received word, in
+ * n log n additions rather than a search of the 2^( m + 1 ) codewords.
+ * @author agent
+ * @version 18 October 2026
+ */
+class ReedMullerCode
+{
+public:
+  /**
+   * Constructor specifying the number of variables
+   * @param degree m, so the code length is 2^m (1 <= m <= 20)
+   */
+  ReedMullerCode( uint degree );
+
+  /**
+   * Return the code length
+   */
+  uint get_code_length() const;
+
+  /**
+   * Return the dimension of the code
+   */
+  uint get_dimension() const;
+
+  /**
+   * Return the minimum distance of the code, 2^( m - 1 )
+   */
+  uint get_minimum_distance() const;
+
+  /**
+   * Return the generator matrix. Row r is the codeword of message
+   * bit k - 1 - r, the layout LinearCode uses, so row 0 is the all
+   * ones word and row m - p the coordinate function x_p.
+   */
+  const vector< LongWord >& get_generator() const;
+
+  /**
+   * Return the parity check matrix
+   */
+  const vector< LongWord >& get_parity_check() const;
+
+  /**
+   * encode a message
+   * @param message the m + 1 bit message
+   * @return the codeword
+   */
+  LongWord encode_word( uint message ) const;
+
+  /**
+   * determine the message of the codeword nearest a received word
+   * @param received the received word
+   * @return the decoded message
+   */
+  uint decode_word( const LongWord &received ) const;
+
+  /**
+   * decode a batch of received words to their messages. the words
+   * are transformed HADAMARD_LANES at a time, one per lane, so every
+   * butterfly is a run of independent additions that an optimized
+   * build turns into vector instructions. may be called from several
+   * threads at once; each thread keeps its own scratch space.
+   * @param received the received words
+   * @param messages the decoded messages, as long as received
+   */
+  void decode_batch( Span< const LongWord > received,
+                     Span< uint > messages ) const;
+
+  /**
+   * create the LinearCode with the same generator and parity check
+   * matrices. only m <= 5 fits in a uint.
+   * @return the linear code, or the code of length 0 if m > 5
+   */
+  LinearCode to_linear_code() const;
+
+private:
+
+  /**
+   * transform and decode up to HADAMARD_LANES words
+   * @param received the first received word
+   * @param count the number of words, at most HADAMARD_LANES
+   * @param messages the decoded messages
+   * @param values scratch space of n * HADAMARD_LANES values
+   */
+  void decode_lanes( const LongWord* received, uint count,
+                     uint* messages, int32_t* values ) const;
+
+  uint degree;
+  uint code_length;
+  vector< LongWord > generator;
+  vector< LongWord > parity_check;
+};
+
+ReedMullerCode::ReedMullerCode( uint param_degree )
+: degree( param_degree ), code_length( 1u << param_degree )
+{
+  TraceScope trace( "reed muller construction" );
+
+  //row 0 is the constant function, row m - p the function x_p
+  LongWord all_ones = new_long_word( code_length );
+  for( uint x = 0; x < code_length; x++ )
+  {
+    set_bit( all_ones, x );
+  }
+  generator.push_back( all_ones );
+  for( uint p = degree - 1; p != UINT32_MAX; p-- )
+  {
+    LongWord row = new_long_word( code_length );
+    for( uint x = 0; x < code_length; x++ )
+    {
+      if( ( x >> p ) & 1 )
+      {
+        set_bit( row, x );
+      }
+    }
+    generator.push_back( row );
+  }
+
+  parity_check = find_dual_basis( generator, code_length );
+}
+
+uint ReedMullerCode::get_code_length() const
+{
+  return code_length;
+}
+
+uint ReedMullerCode::get_dimension() const
+{
+  return degree + 1;
+}
+
+uint ReedMullerCode::get_minimum_distance() const
+{
+  return code_length / 2;
+}
+
+const vector< LongWord >& ReedMullerCode::get_generator() const
+{
+  return generator;
+}
+
+const vector< LongWord >& ReedMullerCode::get_parity_check() const
+{
+  return parity_check;
+}
+
+LongWord ReedMullerCode::encode_word( uint message ) const
+{
+  //coordinate x is the parity of u & x, plus a
+  uint linear_part = message & ( code_length - 1 );
+  uint constant_part = ( message >> degree ) & 1;
+  LongWord code_word = new_long_word( code_length );
+  for( uint x = 0; x < code_length; x++ )
+  {
+    if( ( __builtin_parity( linear_part & x ) ^ constant_part ) == 1 )
+    {
+      set_bit( code_word, x );
+    }
+  }
+  CodecStats::count( WORDS_ENCODED );
+  return code_word;
+}
+
+void ReedMullerCode::decode_lanes( const LongWord* received, uint count,
+                                   uint* messages,
+                                   int32_t* values ) const
+{
+  //load each word as +1 / -1 values, word i in lane i
+  for( uint x = 0; x < code_length; x++ )
+  {
+    int32_t* row = values + x * HADAMARD_LANES;
+    for( uint lane = 0; lane < HADAMARD_LANES; lane++ )
+    {
+      row[ lane ] = lane < count ?
+        1 - 2 * static_cast< int32_t >( get_bit( received[ lane ], x ) ) :
+        0;
+    }
+  }
+
+  //fast Walsh-Hadamard transform. each butterfly adds and subtracts
+  //two rows of HADAMARD_LANES values
+  for( uint half = 1; half < code_length; half <<= 1 )
+  {
+    for( uint block = 0; block < code_length; block += 2 * half )
+    {
+      for( uint x = block; x < block + half; x++ )
+      {
+        int32_t* first = values + x * HADAMARD_LANES;
+        int32_t* second = values + ( x + half ) * HADAMARD_LANES;
+        for( uint lane = 0; lane < HADAMARD_LANES; lane++ )
+        {
+          int32_t sum = first[ lane ] + second[ lane ];
+          int32_t difference = first[ lane ] - second[ lane ];
+          first[ lane ] = sum;
+          second[ lane ] = difference;
+        }
+      }
+    }
+  }
+
+  //the transform at u is n - 2 d( r, u.x ). the largest magnitude
+  //gives the nearest affine function, its sign the constant term
+  int32_t best_magnitude[ HADAMARD_LANES ];
+  int32_t best_value[ HADAMARD_LANES ];
+  uint best_u[ HADAMARD_LANES ];
+  for( uint lane = 0; lane < HADAMARD_LANES; lane++ )
+  {
+    best_magnitude[ lane ] = -1;
+    best_value[ lane ] = 0;
+    best_u[ lane ] = 0;
+  }
+  for( uint u = 0; u < code_length; u++ )
+  {
+    const int32_t* row = values + u * HADAMARD_LANES;
+    for( uint lane = 0; lane < HADAMARD_LANES; lane++ )
+    {
+      int32_t magnitude = row[ lane ] < 0 ? -row[ lane ] : row[ lane ];
+      if( magnitude > best_magnitude[ lane ] )
+      {
+        best_magnitude[ lane ] = magnitude;
+        best_value[ lane ] = row[ lane ];
+        best_u[ lane ] = u;
+      }
+    }
+  }
+
+  for( uint lane = 0; lane < count; lane++ )
+  {
+    uint constant_part = best_value[ lane ] < 0 ? 1 : 0;
+    messages[ lane ] = best_u[ lane ] | ( constant_part << degree );
+    if( CodecStats::is_enabled() )
+    {
+      //the distance to the chosen codeword is the number of errors
+      uint errors = ( code_length - best_magnitude[ lane ] ) / 2;
+      CodecStats::count( WORDS_DECODED );
+      if( errors > ( get_minimum_distance() - 1 ) / 2 )
+      {
+        CodecStats::count( DECODE_FAILURES );
+      }
+      else
+      {
+        CodecStats::count( ERRORS_CORRECTED, errors );
+      }
+    }
+  }
+}
+
+uint ReedMullerCode::decode_word( const LongWord &received ) const
+{
+  uint message = 0;
+  decode_batch( Span< const LongWord >( &received, 1 ),
+                Span< uint >( &message, 1 ) );
+  return message;
+}
+
+void ReedMullerCode::decode_batch( Span< const LongWord > received,
+                                   Span< uint > messages ) const
+{
+  //the scratch space grows once per thread, so steady state
+  //decoding does no allocation
+  static thread_local vector< int32_t > values;
+  if( values.size() < code_length * HADAMARD_LANES )
+  {
+    values.resize( code_length * HADAMARD_LANES );
+  }
+
+  for( size_t first = 0; first < received.size();
+       first += HADAMARD_LANES )
+  {
+    uint count = min< size_t >( HADAMARD_LANES, received.size() - first );
+    decode_lanes( received.data() + first, count,
+                  messages.data() + first, values.data() );
+  }
+}
+
+LinearCode ReedMullerCode::to_linear_code() const
+{
+  return narrow_linear_code( generator, parity_check, code_length );
+}
+
+#endif
@@ -0,0 +1,430 @@
+#ifndef SCRUBBER_H
+#define SCRUBBER_H
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "linear_code.h"
+#include "decoder_tuner.h"
+
+using namespace std;
+
+/*
+ * the codewords a thread claims at a time
+ */
+const uint64_t SCRUB_CHUNK_WORDS = 1 << 14;
+
+/*
+ * the least time between two checkpoints
+ */
+const double SCRUB_CHECKPOINT_SECONDS = 1.0;
+
+/*
+ * how hard a scrub may run and where it keeps its place
+ */
+struct ScrubOptions
+{
+  uint num_threads;
+  uint64_t bytes_per_second;
+  double cpu_share;
+  string checkpoint_path;
+};
+
+/*
+ * what a scrub found
+ */
+struct ScrubReport
+{
+  uint64_t words_scanned;
+  uint64_t words_corrected;
+  uint64_t bits_corrected;
+  vector< uint64_t > uncorrectable;
+  uint64_t resumed_from;
+  bool completed;
+};
+
+/**
+ * A scrubber for a file of codewords of one code, each a 32 bit word
+ * in host byte order. The file is mapped shared, so a correction is a
+ * store to the page and reaches the disk with the page. Threads claim
+ * chunks of SCRUB_CHUNK_WORDS in order, run the batched syndrome over
+ * each, and decode only the words whose syndrome is not 0. A word
+ * moved more than t by the decoder is not trusted: it is left as it
+ * is and its offset logged. Each thread throttles itself to its share
+ * of the byte rate and sleeps in proportion to its work to hold the
+ * CPU share. The checkpoint is the offset below which every chunk is
+ * done, rewritten at most every SCRUB_CHECKPOINT_SECONDS as chunks
+ * finish, so a scrub that is stopped resumes from there; a scrub that
+ * finishes removes it. The corrections below an offset are synced to
+ * the file before the checkpoint names it, and the checkpoint is
+ * synced before it replaces the old one, so a crash never skips an
+ * unwritten correction.
+ * @author agent
+ * @version 18 October 2026
+ */
+class CodeScrubber
+{
+public:
+  /**
+   * Constructor choosing the decoder for the code
+   * @param code the code, which must outlive the scrubber
+   * @param allow_incomplete whether or not the decoder may report a
+   * word with more than t errors instead of decoding it
+   */
+  CodeScrubber( const LinearCode &code, bool allow_incomplete = false );
+
+  /**
+   * scrub a file, resuming from its checkpoint if there is one
+   * @param path the path of the file
+   * @param options the threads, throttles and checkpoint
+   * @return what was found
+   */
+  ScrubReport scrub( const string &path, const ScrubOptions &options );
+
+  /**
+   * print the decoder picked for the code and why
+   * @param out the stream to print to
+   */
+  void print_decoder( ostream &out ) const;
+
+private:
+
+  /**
+   * scrub chunks until there are none left
+   * @param words the mapped codewords
+   * @param options the throttles
+   */
+  void scrub_chunks( uint* words, const ScrubOptions &options );
+
+  /**
+   * write the corrections to a range of words through to the file
+   * @param words the mapped codewords
+   * @param first the first word of the range
+   * @param last the word past the range
+   */
+  void sync_words( uint* words, uint64_t first, uint64_t last ) const;
+
+  /**
+   * scrub one chunk
+   * @param words the codewords of the chunk
+   * @param first the offset of the first of them
+   * @param count the number of them
+   */
+  void scrub_chunk( uint* words, uint64_t first, uint64_t count );
+
+  /**
+   * mark a chunk done and move the checkpoint past every chunk done
+   * @param words the mapped codewords
+   * @param chunk the chunk
+   * @param options where the checkpoint is kept
+   */
+  void finish_chunk( uint* words, uint64_t chunk,
+                     const ScrubOptions &options );
+
+  /**
+   * read the offset a scrub stopped at
+   * @param path the checkpoint file
+   * @return the offset, or 0 if there is none
+   */
+  uint64_t read_checkpoint( const string &path ) const;
+
+  /**
+   * write the offset below which every word is scrubbed
+   * @param path the checkpoint file
+   * @param offset the offset
+   */
+  void write_checkpoint( const string &path, uint64_t offset ) const;
+
+  const LinearCode &code;
+  TunedDecoder decoder;
+  uint correctable;
+  uint64_t num_words;
+  uint64_t start_offset;
+  uint64_t num_chunks;
+  atomic< uint64_t > next_chunk;
+  atomic< uint64_t > words_scanned;
+  atomic< uint64_t > words_corrected;
+  atomic< uint64_t > bits_corrected;
+  mutex progress_lock;
+  vector< bool > chunk_done;
+  uint64_t chunks_below;
+  uint64_t checkpointed;
+  chrono::steady_clock::time_point last_checkpoint;
+  vector< uint64_t > uncorrectable;
+};
+
+CodeScrubber::CodeScrubber( const LinearCode &param_code,
+                            bool allow_incomplete )
+: code( param_code ),
+  decoder( param_code, DECODER_MEMORY_BUDGET, "", allow_incomplete ),
+  correctable( param_code.get_correction_capability() ), num_words( 0 ),
+  start_offset( 0 ), num_chunks( 0 ), next_chunk( 0 ), words_scanned( 0 ),
+  words_corrected( 0 ), bits_corrected( 0 ), chunks_below( 0 ),
+  checkpointed( 0 )
+{
+}
+
+uint64_t CodeScrubber::read_checkpoint( const string &path ) const
+{
+  ifstream file( path );
+  uint64_t offset = 0;
+  if( file )
+  {
+    file >> offset;
+  }
+  return file ? offset : 0;
+}
+
+void CodeScrubber::write_checkpoint( const string &path,
+                                     uint64_t offset ) const
+{
+  //write beside it, sync and rename, so a crash leaves the old or
+  //the new
+  string temporary = path + ".tmp";
+  string text = to_string( offset ) + "\n";
+  int fd = open( temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+  if( fd < 0 or
+      write( fd, text.data(), text.size() ) !=
+        static_cast< ssize_t >( text.size() ) or
+      fsync( fd ) != 0 )
+  {
+    cerr << "could not write the checkpoint " << temporary << ": "
+         << strerror( errno ) << endl;
+    if( fd >= 0 )
+    {
+      close( fd );
+    }
+    return;
+  }
+  close( fd );
+  if( rename( temporary.c_str(), path.c_str() ) != 0 )
+  {
+    cerr << "could not write the checkpoint " << path << ": "
+         << strerror( errno ) << endl;
+  }
+}
+
+void CodeScrubber::scrub_chunk( uint* words, uint64_t first,
+                                uint64_t count )
+{
+  //the syndromes of the whole chunk first, then the decoder for the
+  //few that are not 0
+  static thread_local vector< uint > syndromes;
+  syndromes.resize( count );
+  code.syndrome_batch( Span< const uint >( words, count ),
+                       Span< uint >( syndromes.data(), count ) );
+
+  uint64_t corrected = 0;
+  uint64_t bits = 0;
+  for( uint64_t i = 0; i < count; i++ )
+  {
+    if( syndromes[ i ] == 0 )
+    {
+      continue;
+    }
+    //the syndrome is not 0, so only a decoder that gave up returns
+    //the word as it is
+    uint decoded = decoder.decode_word( words[ i ] );
+    uint distance = __builtin_popcount( decoded ^ words[ i ] );
+    if( distance > correctable or distance == 0 )
+    {
+      lock_guard< mutex > guard( progress_lock );
+      uncorrectable.push_back( first + i );
+      cerr << "uncorrectable word at offset " << first + i << endl;
+      continue;
+    }
+    words[ i ] = decoded;
+    corrected++;
+    bits += distance;
+  }
+  words_scanned += count;
+  words_corrected += corrected;
+  bits_corrected += bits;
+}
+
+void CodeScrubber::sync_words( uint* words, uint64_t first,
+                               uint64_t last ) const
+{
+  //msync takes a page aligned start, and the mapping starts on a page
+  uintptr_t page_size = sysconf( _SC_PAGESIZE );
+  uintptr_t start = reinterpret_cast< uintptr_t >( words + first ) &
+    ~( page_size - 1 );
+  uintptr_t end = reinterpret_cast< uintptr_t >( words + last );
+  if( msync( reinterpret_cast< void* >( start ), end - start,
+             MS_SYNC ) != 0 )
+  {
+    cerr << "could not sync the scrubbed words: " << strerror( errno )
+         << endl;
+  }
+}
+
+void CodeScrubber::finish_chunk( uint* words, uint64_t chunk,
+                                 const ScrubOptions &options )
+{
+  lock_guard< mutex > guard( progress_lock );
+  chunk_done[ chunk ] = true;
+  uint64_t old_below = chunks_below;
+  while( chunks_below < num_chunks and chunk_done[ chunks_below ] )
+  {
+    chunks_below++;
+  }
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  if( chunks_below != old_below and options.checkpoint_path != "" and
+      chrono::duration< double >( now - last_checkpoint ).count() >=
+      SCRUB_CHECKPOINT_SECONDS )
+  {
+    //the corrections reach the file before the checkpoint passes them
+    uint64_t below = min( num_words,
+                          start_offset + chunks_below * SCRUB_CHUNK_WORDS );
+    sync_words( words, checkpointed, below );
+    write_checkpoint( options.checkpoint_path, below );
+    checkpointed = below;
+    last_checkpoint = now;
+  }
+}
+
+void CodeScrubber::scrub_chunks( uint* words, const ScrubOptions &options )
+{
+  uint num_threads = max( options.num_threads, 1u );
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  uint64_t bytes_done = 0;
+  for( uint64_t chunk = next_chunk++; chunk < num_chunks;
+       chunk = next_chunk++ )
+  {
+    TraceScope trace( "scrub chunk", chunk );
+    uint64_t first = start_offset + chunk * SCRUB_CHUNK_WORDS;
+    uint64_t count = min( SCRUB_CHUNK_WORDS, num_words - first );
+    chrono::steady_clock::time_point busy_start = chrono::steady_clock::now();
+    scrub_chunk( words + first, first, count );
+    finish_chunk( words, chunk, options );
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+    //sleep long enough for the work to be the cpu share of the time,
+    //and for this thread's bytes to stay within its share of the rate
+    chrono::duration< double > pause( 0 );
+    if( options.cpu_share > 0 and options.cpu_share < 1 )
+    {
+      pause = ( now - busy_start ) * ( 1 - options.cpu_share ) /
+        options.cpu_share;
+    }
+    bytes_done += count * sizeof( uint );
+    if( options.bytes_per_second > 0 )
+    {
+      chrono::duration< double > due( static_cast< double >( bytes_done ) *
+        num_threads / options.bytes_per_second );
+      pause = max( pause, due - chrono::duration< double >( now - start ) );
+    }
+    if( pause.count() > 0 )
+    {
+      this_thread::sleep_for( pause );
+    }
+  }
+}
+
+void CodeScrubber::print_decoder( ostream &out ) const
+{
+  decoder.print_report( out );
+}
+
+ScrubReport CodeScrubber::scrub( const string &path,
+                                 const ScrubOptions &options )
+{
+  ScrubReport report = ScrubReport();
+  int fd = open( path.c_str(), O_RDWR );
+  struct stat file_stat;
+  if( fd < 0 or fstat( fd, &file_stat ) < 0 )
+  {
+    cerr << "could not open " << path << ": " << strerror( errno ) << endl;
+    if( fd >= 0 )
+    {
+      close( fd );
+    }
+    return report;
+  }
+  if( file_stat.st_size % sizeof( uint ) != 0 )
+  {
+    cerr << path << " is not a whole number of codewords" << endl;
+  }
+  num_words = file_stat.st_size / sizeof( uint );
+  start_offset = 0;
+  if( options.checkpoint_path != "" )
+  {
+    start_offset = min( read_checkpoint( options.checkpoint_path ),
+                        num_words );
+  }
+  report.resumed_from = start_offset;
+  if( num_words == start_offset )
+  {
+    close( fd );
+    report.completed = true;
+    return report;
+  }
+
+  void* mapping = mmap( nullptr, num_words * sizeof( uint ),
+                        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  close( fd );
+  if( mapping == MAP_FAILED )
+  {
+    cerr << "could not map " << path << ": " << strerror( errno ) << endl;
+    return report;
+  }
+  uint* words = static_cast< uint* >( mapping );
+  madvise( words, num_words * sizeof( uint ), MADV_SEQUENTIAL );
+
+  num_chunks = ( num_words - start_offset + SCRUB_CHUNK_WORDS - 1 ) /
+    SCRUB_CHUNK_WORDS;
+  next_chunk = 0;
+  words_scanned = 0;
+  words_corrected = 0;
+  bits_corrected = 0;
+  chunk_done.assign( num_chunks, false );
+  chunks_below = 0;
+  checkpointed = start_offset;
+  last_checkpoint = chrono::steady_clock::now();
+  uncorrectable.clear();
+
+  vector< thread > workers;
+  for( uint t = 1; t < max( options.num_threads, 1u ); t++ )
+  {
+    workers.push_back( thread( &CodeScrubber::scrub_chunks, this, words,
+                               cref( options ) ) );
+  }
+  scrub_chunks( words, options );
+  for( thread &worker : workers )
+  {
+    worker.join();
+  }
+
+  msync( words, num_words * sizeof( uint ), MS_SYNC );
+  munmap( words, num_words * sizeof( uint ) );
+
+  report.words_scanned = words_scanned;
+  report.words_corrected = words_corrected;
+  report.bits_corrected = bits_corrected;
+  report.uncorrectable = uncorrectable;
+  sort( report.uncorrectable.begin(), report.uncorrectable.end() );
+  report.completed = true;
+
+  //the next pass starts from the beginning
+  if( options.checkpoint_path != "" )
+  {
+    unlink( options.checkpoint_path.c_str() );
+  }
+  return report;
+}
+
+#endif
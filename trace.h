@@ -0,0 +1,261 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+/**
+ * An optional timeline of the run, written as a Chrome trace-event
+ * json file that chrome://tracing and Perfetto can open. Every thread
+ * records into its own fixed size ring buffer; the owner is the only
+ * writer, so recording is two relaxed stores and a release store.
+ * When the ring fills the oldest events are overwritten. The rings
+ * are kept on a lock-free list and written out when the program
+ * exits.
+ * @author agent
+ * @version 18 October 2026
+ */
+class Trace
+{
+public:
+
+  /**
+   * turn tracing on. the trace is written to the given file when the
+   * program exits.
+   * @param path the file the trace is written to
+   */
+  static void enable( const string &path );
+
+  /**
+   * determine if tracing is on
+   * @return whether or not events are recorded
+   */
+  static bool is_enabled();
+
+  /**
+   * return the current time on the trace clock
+   * @return nanoseconds since tracing was turned on
+   */
+  static uint64_t now();
+
+  /**
+   * record a complete event on the calling thread
+   * @param name the name of the event. it must outlive the program,
+   * in practice a string literal
+   * @param start the start of the event on the trace clock
+   * @param end the end of the event on the trace clock
+   * @param arg an index shown with the event, such as a batch
+   * number, or -1 for none
+   */
+  static void record( const char* name, uint64_t start, uint64_t end,
+                      int64_t arg = -1 );
+
+  /**
+   * write every thread's events to the trace file
+   */
+  static void write();
+
+private:
+
+  static const uint RING_SIZE = 1 << 16;
+
+  struct Event
+  {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    int64_t arg;
+  };
+
+  struct ThreadRing
+  {
+    Event events[ RING_SIZE ];
+    atomic< uint64_t > written;
+    uint thread_id;
+    ThreadRing* next;
+  };
+
+  /**
+   * return the calling thread's ring, registering it on first use
+   * @return the ring
+   */
+  static ThreadRing& local_ring();
+
+  /**
+   * write the trace from an atexit handler
+   */
+  static void write_at_exit();
+
+  static atomic< bool > enabled;
+  static atomic< ThreadRing* > rings;
+  static atomic< uint > next_thread_id;
+  static chrono::steady_clock::time_point epoch;
+  static string trace_path;
+};
+
+/**
+ * Records a trace event covering its lifetime
+ * @author agent
+ * @version 18 October 2026
+ */
+class TraceScope
+{
+public:
+  /**
+   * Constructor starting the event
+   * @param name the name of the event, a string literal
+   * @param arg an index shown with the event, or -1 for none
+   */
+  TraceScope( const char* name, int64_t arg = -1 );
+
+  /**
+   * Destructor recording the event
+   */
+  ~TraceScope();
+
+private:
+  const char* name;
+  int64_t arg;
+  bool running;
+  uint64_t start;
+};
+
+atomic< bool > Trace::enabled( false );
+atomic< Trace::ThreadRing* > Trace::rings( nullptr );
+atomic< uint > Trace::next_thread_id( 1 );
+chrono::steady_clock::time_point Trace::epoch;
+string Trace::trace_path;
+
+void Trace::enable( const string &path )
+{
+  trace_path = path;
+  epoch = chrono::steady_clock::now();
+  enabled.store( true, memory_order_release );
+  atexit( write_at_exit );
+}
+
+bool Trace::is_enabled()
+{
+  return enabled.load( memory_order_relaxed );
+}
+
+uint64_t Trace::now()
+{
+  return chrono::duration_cast< chrono::nanoseconds >(
+    chrono::steady_clock::now() - epoch ).count();
+}
+
+Trace::ThreadRing& Trace::local_ring()
+{
+  //each thread allocates its ring once and never frees it, so the
+  //events outlive the thread
+  static thread_local ThreadRing* ring = nullptr;
+  if( ring == nullptr )
+  {
+    ring = new ThreadRing();
+    ring -> written.store( 0, memory_order_relaxed );
+    ring -> thread_id = next_thread_id.fetch_add( 1 );
+
+    //push the ring onto the list of all rings
+    ThreadRing* old_head = rings.load( memory_order_relaxed );
+    do
+    {
+      ring -> next = old_head;
+    }
+    while( !rings.compare_exchange_weak( old_head, ring,
+                                         memory_order_release,
+                                         memory_order_relaxed ) );
+  }
+  return *ring;
+}
+
+void Trace::record( const char* name, uint64_t start, uint64_t end,
+                    int64_t arg )
+{
+  if( !is_enabled() )
+  {
+    return;
+  }
+  ThreadRing &ring = local_ring();
+  uint64_t written = ring.written.load( memory_order_relaxed );
+  Event &event = ring.events[ written % RING_SIZE ];
+  event.name = name;
+  event.start = start;
+  event.end = end;
+  event.arg = arg;
+  ring.written.store( written + 1, memory_order_release );
+}
+
+void Trace::write()
+{
+  ofstream trace_file( trace_path.c_str() );
+  if( !trace_file.is_open() )
+  {
+    cerr << "unable to write trace to " << trace_path << endl;
+    return;
+  }
+
+  trace_file << "{\"traceEvents\": [" << endl;
+  trace_file << fixed << setprecision( 3 );
+  bool first_event = true;
+  for( ThreadRing* ring = rings.load( memory_order_acquire );
+       ring != nullptr; ring = ring -> next )
+  {
+    uint64_t written = ring -> written.load( memory_order_acquire );
+    uint64_t first = written > RING_SIZE ? written - RING_SIZE : 0;
+    for( uint64_t i = first; i < written; i++ )
+    {
+      const Event &event = ring -> events[ i % RING_SIZE ];
+      if( !first_event )
+      {
+        trace_file << "," << endl;
+      }
+      first_event = false;
+      trace_file << "{\"name\": \"" << event.name
+                 << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+                 << ring -> thread_id
+                 << ", \"ts\": " << event.start / 1000.0
+                 << ", \"dur\": "
+                 << ( event.end - event.start ) / 1000.0;
+      if( event.arg >= 0 )
+      {
+        trace_file << ", \"args\": {\"index\": " << event.arg << "}";
+      }
+      trace_file << "}";
+    }
+  }
+  trace_file << endl << "]}" << endl;
+}
+
+void Trace::write_at_exit()
+{
+  write();
+}
+
+TraceScope::TraceScope( const char* param_name, int64_t param_arg )
+: name( param_name ), arg( param_arg ),
+  running( Trace::is_enabled() ), start( 0 )
+{
+  if( running )
+  {
+    start = Trace::now();
+  }
+}
+
+TraceScope::~TraceScope()
+{
+  if( running )
+  {
+    Trace::record( name, start, Trace::now(), arg );
+  }
+}
+
+#endif
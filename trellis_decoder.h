@@ -0,0 +1,251 @@
+#ifndef TRELLIS_DECODER_H
+#define TRELLIS_DECODER_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <cfloat>
+#include "word_span.h"
+#include "codec_stats.h"
+#include "linear_code.h"
+
+using namespace std;
+
+/*
+ * the most parity checks a trellis is built for. the decisions of a
+ * word take n 2^( n - k ) bytes, 32 MB at this limit and n = 32
+ */
+const uint TRELLIS_MAX_REDUNDANCY = 20;
+
+/**
+ * A maximum likelihood decoder that runs the Viterbi algorithm over
+ * the syndrome trellis of a code (Wolf, 1978). The states at depth i
+ * are the partial syndromes of the first i coordinates: sending bit v
+ * at coordinate i moves state s to s ^ v h_i, h_i the column of the
+ * parity check matrix at coordinate i, and the codewords are the
+ * paths that start and end in state 0. One survivor is kept per state,
+ * so a word costs n 2^( n - k ) add-compare-selects, against the
+ * n 2^k of the coset search in LinearCode::decode_word. A code longer
+ * than 32 or with more than TRELLIS_MAX_REDUNDANCY parity checks is
+ * refused: the decoder is marked invalid and returns words as they
+ * were received.
+ * @author agent
+ * @version 18 October 2026
+ */
+class TrellisDecoder
+{
+public:
+  /**
+   * Constructor building the trellis of a code from its parity check
+   * matrix
+   * @param code the code
+   */
+  TrellisDecoder( const LinearCode &code );
+
+  /**
+   * Return whether or not the code's trellis was built
+   */
+  bool is_valid() const;
+
+  /**
+   * Return the number of states at each depth, 2^( n - k )
+   */
+  uint get_num_states() const;
+
+  /**
+   * decode a hard decision word
+   * @param received the received word
+   * @return the codeword nearest it, or the received word if the
+   * decoder is not valid
+   */
+  uint decode_word( uint received ) const;
+
+  /**
+   * decode soft channel output
+   * @param llrs the llr of each coordinate, positive meaning 0,
+   * indexed by place value
+   * @return the most likely codeword, or the hard decision if the
+   * decoder is not valid
+   */
+  uint decode_soft( const float* llrs ) const;
+
+  /**
+   * decode a batch of hard decision words. may be called from several
+   * threads at once; each thread keeps its own scratch space.
+   * @param received the received words
+   * @param decoded the decoded words, as long as received
+   */
+  void decode_batch( Span< const uint > received,
+                     Span< uint > decoded ) const;
+
+private:
+
+  /**
+   * run the Viterbi algorithm and trace back the survivor of state 0
+   * @param costs the cost of sending a 1 at each coordinate, relative
+   * to sending a 0
+   * @return the codeword on the surviving path
+   */
+  uint viterbi( const float* costs ) const;
+
+  uint code_length;
+  uint correction_capability;
+  uint num_states;
+  bool valid;
+  vector< uint > columns;
+};
+
+TrellisDecoder::TrellisDecoder( const LinearCode &code )
+: code_length( code.get_code_length() ),
+  correction_capability( code.get_correction_capability() ),
+  num_states( 0 ), valid( true )
+{
+  TraceScope trace( "trellis construction" );
+
+  //column i of H is bit i of every row, row r giving bit r
+  const vector< uint > &parity_check = code.get_parity_check();
+  if( code_length > 32 or
+      parity_check.size() > TRELLIS_MAX_REDUNDANCY )
+  {
+    cout << "a trellis of length " << code_length << " with "
+         << parity_check.size() << " parity checks is too large." << endl;
+    valid = false;
+    return;
+  }
+  num_states = 1u << parity_check.size();
+  for( uint place = 0; place < code_length; place++ )
+  {
+    uint column = 0;
+    for( uint row = 0; row < parity_check.size(); row++ )
+    {
+      column |= ( ( parity_check.at( row ) >> place ) & 1 ) << row;
+    }
+    columns.push_back( column );
+  }
+}
+
+bool TrellisDecoder::is_valid() const
+{
+  return valid;
+}
+
+uint TrellisDecoder::get_num_states() const
+{
+  return num_states;
+}
+
+uint TrellisDecoder::viterbi( const float* costs ) const
+{
+  //per thread scratch: the path metrics of two depths and the
+  //decision of every state at every depth
+  static thread_local vector< float > metrics;
+  static thread_local vector< float > next_metrics;
+  static thread_local vector< uint8_t > decisions;
+  metrics.assign( num_states, FLT_MAX );
+  next_metrics.resize( num_states );
+  decisions.resize( code_length * num_states );
+  metrics[ 0 ] = 0;
+
+  for( uint place = 0; place < code_length; place++ )
+  {
+    uint column = columns[ place ];
+    float cost = costs[ place ];
+    uint8_t* decision = &decisions[ place * num_states ];
+    const float* old_metric = metrics.data();
+    float* new_metric = next_metrics.data();
+
+    //add-compare-select. the survivor into s either sent 0 from s or
+    //sent 1 from s ^ h. written branch free so an optimized build
+    //with gathers vectorizes it.
+    for( uint state = 0; state < num_states; state++ )
+    {
+      float stay = old_metric[ state ];
+      float move = old_metric[ state ^ column ] + cost;
+      bool take_move = move < stay;
+      new_metric[ state ] = take_move ? move : stay;
+      decision[ state ] = take_move;
+    }
+    metrics.swap( next_metrics );
+  }
+
+  //trace back from state 0, undoing each step
+  uint code_word = 0;
+  uint state = 0;
+  for( uint place = code_length - 1; place != UINT_MAX; place-- )
+  {
+    if( decisions[ place * num_states + state ] )
+    {
+      code_word |= 1u << place;
+      state ^= columns[ place ];
+    }
+  }
+  return code_word;
+}
+
+uint TrellisDecoder::decode_soft( const float* llrs ) const
+{
+  if( !valid )
+  {
+    uint hard_decision = 0;
+    for( uint place = 0; place < code_length and place < 32; place++ )
+    {
+      hard_decision |= static_cast< uint >( llrs[ place ] < 0 ) << place;
+    }
+    return hard_decision;
+  }
+
+  //the metric of a path is the sum of the llrs of its ones. the
+  //constructor refuses codes longer than 32, so the costs fit
+  float costs[ 32 ];
+  for( uint place = 0; place < code_length; place++ )
+  {
+    costs[ place ] = llrs[ place ];
+  }
+  uint decoded = viterbi( costs );
+  CodecStats::count( WORDS_DECODED );
+  return decoded;
+}
+
+uint TrellisDecoder::decode_word( uint received ) const
+{
+  if( !valid )
+  {
+    return received;
+  }
+
+  //a hard decision is an llr of +1 or -1, at most 32 of them as in
+  //decode_soft
+  float costs[ 32 ];
+  for( uint place = 0; place < code_length; place++ )
+  {
+    costs[ place ] = ( ( received >> place ) & 1 ) ? -1.0f : 1.0f;
+  }
+  uint decoded = viterbi( costs );
+
+  //a nearest codeword further than t may not be the one sent
+  if( CodecStats::is_enabled() )
+  {
+    uint errors = __builtin_popcount( decoded ^ received );
+    CodecStats::count( WORDS_DECODED );
+    if( errors > correction_capability )
+    {
+      CodecStats::count( DECODE_FAILURES );
+    }
+    else
+    {
+      CodecStats::count( ERRORS_CORRECTED, errors );
+    }
+  }
+  return decoded;
+}
+
+void TrellisDecoder::decode_batch( Span< const uint > received,
+                                   Span< uint > decoded ) const
+{
+  for( size_t i = 0; i < received.size(); i++ )
+  {
+    decoded[ i ] = decode_word( received[ i ] );
+  }
+}
+
+#endif
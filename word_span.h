@@ -0,0 +1,82 @@
+#ifndef WORD_SPAN_H
+#define WORD_SPAN_H
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A non-owning view of a contiguous run of words, used by the batch
+ * interfaces so callers can pass any buffer without copying it into
+ * a vector first.
+ * @author agent
+ * @version 18 October 2026
+ */
+template< typename T >
+class Span
+{
+public:
+  /**
+   * Constructor for an empty span
+   */
+  Span() : span_data( nullptr ), span_size( 0 ) {}
+
+  /**
+   * Constructor specifying the words viewed
+   * @param data the first word
+   * @param size the number of words
+   */
+  Span( T* data, size_t size ) : span_data( data ), span_size( size ) {}
+
+  /**
+   * Constructor viewing every word of a vector
+   * @param words the vector
+   */
+  template< typename U >
+  Span( vector< U > &words )
+  : span_data( words.data() ), span_size( words.size() ) {}
+
+  /**
+   * Constructor viewing every word of a const vector
+   * @param words the vector
+   */
+  template< typename U >
+  Span( const vector< U > &words )
+  : span_data( words.data() ), span_size( words.size() ) {}
+
+  /**
+   * Return the first word
+   */
+  T* data() const { return span_data; }
+
+  /**
+   * Return the number of words
+   */
+  size_t size() const { return span_size; }
+
+  /**
+   * Return the word at a position, unchecked
+   * @param index the position
+   */
+  T& operator[]( size_t index ) const { return span_data[ index ]; }
+
+  /**
+   * Return the view of a part of this span
+   * @param offset the first word of the part
+   * @param count the number of words in the part
+   */
+  Span< T > subspan( size_t offset, size_t count ) const
+  {
+    return Span< T >( span_data + offset, count );
+  }
+
+  T* begin() const { return span_data; }
+  T* end() const { return span_data + span_size; }
+
+private:
+  T* span_data;
+  size_t span_size;
+};
+
+#endif